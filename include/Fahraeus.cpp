@@ -14,9 +14,20 @@
   @brief  	Definition of Fahraeus effects routines.
  */
 #include <Fahraeus.hpp>
+#include <rheology_table.hpp>
+#include <algorithm>
 
 namespace getfem {
 
+// Active lookup tables (nullptr = analytic laws)
+static const rheology_table * active_table = nullptr;
+
+void
+set_rheology_table(const rheology_table * T)
+{
+	active_table = (T && T->built()) ? T : nullptr;
+}
+
 // Compute the viscosity of plasma (see Biomachines course)
 scalar_type
 viscosity_plasma(scalar_type temperature)
@@ -89,10 +100,82 @@ viscosity_vivo(scalar_type hematocrit, scalar_type R, scalar_type mu_plasma)
 		return viscosity;
 
 }
+// Precompute the diameter-only terms of the Pries viscosity laws
+void
+viscosity_terms::build(const vector_type & diameters, bool vivo)
+{
+	size_type n = diameters.size();
+	D = diameters;
+	in_vivo = vivo;
+	gmm::resize(visco_45, n); gmm::resize(C, n);
+	gmm::resize(inv_den, n); gmm::resize(wall, n);
+	for(size_type k=0; k<n; ++k){
+		scalar_type Dk = D[k];
+		if (vivo && Dk < 6) Dk=6; // as in viscosity_vivo
+		scalar_type D12 = pow(Dk/10, 12);
+		C[k] = (0.8+exp(-0.075*Dk))*(-1+1/(1+10*D12))+1/(1+10*D12);
+		if (vivo){
+			visco_45[k] = 6*exp(-0.085*Dk)+3.2-2.44*exp(-0.06*pow(Dk,0.645)) - 1;
+			wall[k] = (Dk/(Dk-1.1))*(Dk/(Dk-1.1));
+		}
+		else {
+			visco_45[k] = 220*exp(-1.3*Dk)+3.2-2.44*exp(-0.06*pow(Dk,0.645)) - 1;
+			wall[k] = 1.0;
+		}
+		inv_den[k] = 1.0/(exp(C[k]*log(1-0.45))-1);
+	}
+}
+
+// Compute the viscosity of a batch of segments
+void
+viscosity_batch(const viscosity_terms & T, const vector_type & H, 
+	scalar_type mu_plasma, vector_type & mu)
+{
+	size_type n = T.size();
+	GMM_ASSERT1(H.size() == n, "viscosity_batch: " << H.size() 
+		<< " hematocrit values for " << n << " segments");
+	gmm::resize(mu, n);
+	if(n==0) return;
+	const scalar_type * visco_45 = &T.visco_45[0];
+	const scalar_type * C = &T.C[0];
+	const scalar_type * inv_den = &T.inv_den[0];
+	const scalar_type * wall = &T.wall[0];
+	const scalar_type * h = &H[0];
+	scalar_type * m = &mu[0];
+	if(active_table){
+		const scalar_type * D = &T.D[0];
+		for(size_type k=0; k<n; ++k)
+			m[k] = (h[k]==0) ? mu_plasma : active_table->relative_viscosity(h[k], D[k])*mu_plasma;
+	}
+	else {
+		// Branch-free loop: only (1-H)^C = exp(C log(1-H)) depends on H
+		// (1-H is bounded away from 0 to avoid log(0) with FE exceptions enabled)
+		for(size_type k=0; k<n; ++k){
+			scalar_type one_h = std::max(1-h[k], 1.0E-300);
+			scalar_type rel = (1 + visco_45[k]*(exp(C[k]*log(one_h))-1)*inv_den[k]*wall[k])*wall[k];
+			m[k] = (h[k]==0) ? mu_plasma : rel*mu_plasma;
+		}
+	}
+	//Check for admissible value of Viscosity (Remember that viscosity is expressed in Pa*s)
+	if(!T.in_vivo) return;
+	size_type nb_high = 0;
+	for(size_type k=0; k<n; ++k) nb_high += (m[k] > 0.05);
+	if(nb_high > 0) //That is 50 cP
+		cout << "------------------------------------" << endl << "WARNING! Viscosity is higher than 50cP in " << nb_high << " segments. Please check your parameters" << endl <<  "------------------------------------"<< endl;
+}
+
 //Compute the fractional RBC flow in a bifurcation
 scalar_type
 fractional_Erythrocytes(scalar_type FQB, scalar_type D_f, scalar_type D, scalar_type D_2, scalar_type H_f)
 {
+if(active_table)
+return active_table->fractional_Erythrocytes(FQB, D_f, D, D_2, H_f);
+return fractional_Erythrocytes_exact(FQB, D_f, D, D_2, H_f);
+}
+
+scalar_type
+fractional_Erythrocytes_exact(scalar_type FQB, scalar_type D_f, scalar_type D, scalar_type D_2, scalar_type H_f)
+{
 /*cout << "FQB " <<FQB << endl;
 cout << "D " <<D << endl;
 cout << "D-f " <<D_f << endl;
@@ -20,6 +20,7 @@
 
 #include <getfem/getfem_assembling.h> 
 #include <math.h>
+#include <defines.hpp>
 
 namespace getfem {
 
@@ -32,9 +33,53 @@ viscosity_vitro(scalar_type hematocrit, scalar_type R, scalar_type mu_plasma);
 scalar_type 
 viscosity_vivo(scalar_type hematocrit, scalar_type R, scalar_type mu_plasma);
 
+//! Diameter-only terms of the Pries viscosity laws, one entry per segment
+/*!
+	The relative viscosity of both laws reads
+	@f$ \eta_{rel} = \left(1 + (\eta^*_{0.45}-1)\frac{(1-H)^C-1}{(1-0.45)^C-1}\,w\right)w @f$
+	with @f$w=(D/(D-1.1))^2@f$ in vivo (Pries et al 1994) and @f$w=1@f$ in vitro 
+	(Pries et al 1992). Only @f$(1-H)^C@f$ depends on the hematocrit.
+ */
+struct viscosity_terms {
+	//! Relative viscosity at H=0.45, @f$\eta^*_{0.45}(D)-1@f$
+	vector_type visco_45;
+	//! Shape exponent @f$C(D)@f$
+	vector_type C;
+	//! @f$1/((1-0.45)^C-1)@f$
+	vector_type inv_den;
+	//! Wall effect @f$w(D)@f$
+	vector_type wall;
+	//! Diameters used to build the terms
+	vector_type D;
+	//! True for the in vivo law
+	bool in_vivo;
+
+	viscosity_terms(void) : in_vivo(true) {}
+
+	//! Build the terms for the diameters D [um] (vivo: 1994 law, otherwise 1992 law)
+	void build(const vector_type & diameters, bool vivo);
+	//! Number of segments
+	inline size_type size(void) const { return D.size(); }
+};
+
+//! Batch viscosity: mu[k] = viscosity of segment k with hematocrit H[k] (mu_plasma if H[k]=0)
+void
+viscosity_batch(const viscosity_terms & T, const vector_type & H, 
+	scalar_type mu_plasma, vector_type & mu);
+
+//! Fractional RBC flow in a bifurcation (lookup table if active, otherwise analytic)
 scalar_type
 fractional_Erythrocytes(scalar_type, scalar_type, scalar_type, scalar_type, scalar_type);
 
+//! Fractional RBC flow in a bifurcation (analytic, Pries et al 2005)
+scalar_type
+fractional_Erythrocytes_exact(scalar_type, scalar_type, scalar_type, scalar_type, scalar_type);
+
+class rheology_table;
+//! Use the lookup tables T for viscosity_batch and fractional_Erythrocytes (nullptr = analytic laws)
+void
+set_rheology_table(const rheology_table * T);
+
 scalar_type
 PS_compute_A(scalar_type,scalar_type, scalar_type, scalar_type);
 
@@ -0,0 +1,222 @@
+/* -*- c++ -*- (enables emacs c++ mode) */
+/*======================================================================
+    "Mixed Finite Element Methods for Coupled 3D/1D Fluid Problems"
+
+              Copyright (C) 2026 M3D1D contributors
+======================================================================*/
+/*!
+  @file   adapt1d.cpp
+  @author M3D1D contributors
+  @date   October 2026.
+  @brief  Definition of the adaptive refinement/coarsening of the 1D network mesh.
+ */
+
+#include <adapt1d.hpp>
+#include <c_mesh1d.hpp> // curvature3d
+#include <getfem/getfem_fem.h>
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace getfem {
+
+// Length of the segment AB
+static scalar_type
+segment_length(const base_node & A, const base_node & B)
+{
+	return gmm::vect_dist2(A, B);
+}
+
+// Curvature of the polyline at vertex v (0 at the ends)
+static scalar_type
+vertex_curvature(const std::vector<base_node> & line, size_type v)
+{
+	if (v == 0 || v+1 >= line.size()) return 0.0;
+	base_node X(line[v-1]), Y(line[v]), Z(line[v+1]);
+	return curvature3d(X, Y, Z);
+}
+
+void
+branch_polylines(const mesh & m, size_type nb_branches,
+	std::vector< std::vector<base_node> > & lines)
+{
+	// import_pts_file adds the elements of a branch from start to end,
+	// and the first vertex of each element is the last one of the previous
+	lines.assign(nb_branches, std::vector<base_node>());
+	for (size_type b = 0; b < nb_branches; ++b) {
+		for (getfem::mr_visitor mrv(m.region(b)); !mrv.finished(); ++mrv) {
+			if (lines[b].empty())
+				lines[b].push_back(m.points_of_convex(mrv.cv())[0]);
+			lines[b].push_back(m.points_of_convex(mrv.cv())[1]);
+		}
+		GMM_ASSERT1(lines[b].size() > 1, "adapt1d: empty branch " << b);
+	}
+}
+
+void
+branch_vertex_values(const mesh_fem & mf, const vector_type & U,
+	size_type rg, vector_type & V)
+{
+	const mesh & m = mf.linked_mesh();
+	V.clear();
+	base_vector coeff, val(1);
+	base_matrix G;
+	for (getfem::mr_visitor mrv(m.region(rg)); !mrv.finished(); ++mrv) {
+		size_type cv = mrv.cv();
+		pfem pf = mf.fem_of_element(cv);
+		bgeot::pgeometric_trans pgt = m.trans_of_convex(cv);
+		bgeot::vectors_to_base_matrix(G, m.points_of_convex(cv));
+		slice_vector_on_basic_dof_of_element(mf, U, cv, coeff);
+		fem_interpolation_context ctx(pgt, pf, base_node(1), G, cv, short_type(-1));
+		for (size_type k = (V.empty() ? 0 : 1); k < 2; ++k) {
+			ctx.set_xref(base_node(scalar_type(k)));
+			pf->interpolation(ctx, coeff, val, 1);
+			V.push_back(val[0]);
+		}
+	}
+}
+
+void
+interpolation_indicator(const std::vector<base_node> & line,
+	const vector_type & V, scalar_type scale, vector_type & eta)
+{
+	size_type nv = line.size();
+	GMM_ASSERT1(V.size() == nv && eta.size() == nv-1,
+		"adapt1d: wrong size of the field or of the indicator");
+	if (scale <= 0 || nv < 3) return;
+
+	// Second difference at the interior vertices
+	vector_type d2(nv, 0.0);
+	for (size_type v = 1; v+1 < nv; ++v) {
+		scalar_type hl = segment_length(line[v-1], line[v]);
+		scalar_type hr = segment_length(line[v], line[v+1]);
+		d2[v] = std::abs(2.0*((V[v+1]-V[v])/hr - (V[v]-V[v-1])/hl)/(hl+hr));
+	}
+	d2[0] = d2[1]; d2[nv-1] = d2[nv-2];
+
+	for (size_type e = 0; e+1 < nv; ++e) {
+		scalar_type h = segment_length(line[e], line[e+1]);
+		scalar_type eta_e = h*h*std::max(d2[e], d2[e+1])/8.0/scale;
+		eta[e] = std::max(eta[e], eta_e);
+	}
+}
+
+size_type
+adapt_polyline(const std::vector<base_node> & line,
+	const vector_type & eta, const adapt1d_param & par,
+	std::vector<base_node> & newline)
+{
+	size_type nv = line.size();
+	GMM_ASSERT1(eta.size() == nv-1, "adapt1d: wrong size of the indicator");
+	size_type changes = 0;
+
+	// Indicator per squared length, so that it can be rescaled on merged/split elements
+	vector_type rate(nv-1);
+	for (size_type e = 0; e+1 < nv; ++e) {
+		scalar_type h = segment_length(line[e], line[e+1]);
+		rate[e] = (h > 0) ? eta[e]/(h*h) : 0.0;
+	}
+
+	// 1. Coarsening: remove the interior vertices that are not needed.
+	//    At least two elements are kept on each branch (import_pts_file
+	//    needs the start, the end and one interior point).
+	std::vector<base_node> cline(1, line[0]);
+	vector_type crate;
+	scalar_type rate_left = rate[0];
+	for (size_type v = 1; v+1 < nv; ++v) {
+		size_type remaining = (nv-1) - v; // vertices after v (end included)
+		const base_node & P = cline.back();
+		scalar_type H = segment_length(P, line[v+1]);
+		scalar_type rate_m = std::max(rate_left, rate[v]);
+		base_node X(P), Y(line[v]), Z(line[v+1]);
+		scalar_type angle = curvature3d(X, Y, Z)*H;
+		bool keep_two = (cline.size() + remaining < 3);
+		if (!keep_two && rate_m*H*H < 0.5*par.TOL && angle < par.ANGLE
+			&& (par.HMAX == 0 || H < par.HMAX)) {
+			rate_left = rate_m;
+			++changes;
+		}
+		else {
+			cline.push_back(line[v]);
+			crate.push_back(rate_left);
+			rate_left = rate[v];
+		}
+	}
+	cline.push_back(line[nv-1]);
+	crate.push_back(rate_left);
+
+	// 2. Refinement: split the elements at their midpoint.
+	//    The midpoint is interpolated with the neighbouring vertices
+	//    (cubic inside the branch, quadratic next to its ends), so that
+	//    curved branches are followed.
+	size_type nc = cline.size();
+	newline.assign(1, cline[0]);
+	for (size_type e = 0; e+1 < nc; ++e) {
+		const base_node & A = cline[e];
+		const base_node & B = cline[e+1];
+		scalar_type h = segment_length(A, B);
+		scalar_type angle = 0.5*(vertex_curvature(cline, e) + vertex_curvature(cline, e+1))*h;
+		bool split = crate[e]*h*h > par.TOL || angle > par.ANGLE
+			|| (par.HMAX > 0 && h > par.HMAX);
+		if (split && 0.5*h >= par.HMIN) {
+			base_node M(A.size());
+			if (e > 0 && e+2 < nc)
+				M = (-1.0/16.0)*cline[e-1] + (9.0/16.0)*A + (9.0/16.0)*B + (-1.0/16.0)*cline[e+2];
+			else if (e > 0)
+				M = (-1.0/8.0)*cline[e-1] + (3.0/4.0)*A + (3.0/8.0)*B;
+			else if (e+2 < nc)
+				M = (3.0/8.0)*A + (3.0/4.0)*B + (-1.0/8.0)*cline[e+2];
+			else
+				M = 0.5*(A + B);
+			newline.push_back(M);
+			++changes;
+		}
+		newline.push_back(B);
+	}
+	return changes;
+}
+
+void
+rewrite_pts_file(std::istream & in, std::ostream & out,
+	const std::vector< std::vector<base_node> > & lines)
+{
+	in.seekg(0); in.clear();
+	out.precision(16);
+	out << std::scientific;
+	std::string row;
+	size_type arc = 0;
+	bool inside = false;
+	std::string id;
+	while (std::getline(in, row)) {
+		std::istringstream iss(row);
+		std::string tok;
+		iss >> tok;
+		if (tok == "BEGIN_ARC") {
+			GMM_ASSERT1(arc < lines.size(), "adapt1d: more arcs in the file of points than branches");
+			inside = true; id = "";
+			out << row << endl;
+		}
+		else if (tok == "END_ARC") {
+			// start, end, then the interior points from start to end
+			const std::vector<base_node> & L = lines[arc];
+			GMM_ASSERT1(L.size() > 2, "adapt1d: arc " << arc << " needs an interior point");
+			if (id == "") id = std::to_string(arc+1);
+			out << id << " " << L[0][0] << " " << L[0][1] << " " << L[0][2] << " start" << endl;
+			out << id << " " << L.back()[0] << " " << L.back()[1] << " " << L.back()[2] << " end" << endl;
+			for (size_type v = 1; v+1 < L.size(); ++v)
+				out << id << " " << L[v][0] << " " << L[v][1] << " " << L[v][2] << " point" << endl;
+			out << row << endl;
+			inside = false; ++arc;
+		}
+		else if (inside && tok != "" && tok != "BC") {
+			// point of the original arc: replaced at END_ARC
+			if (id == "") id = tok;
+		}
+		else
+			out << row << endl;
+	}
+	GMM_ASSERT1(arc == lines.size(), "adapt1d: the file of points has " << arc
+		<< " arcs, expected " << lines.size());
+}
+
+} /* end of namespace */
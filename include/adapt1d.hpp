@@ -0,0 +1,119 @@
+/* -*- c++ -*- (enables emacs c++ mode) */
+/*======================================================================
+    "Mixed Finite Element Methods for Coupled 3D/1D Fluid Problems"
+
+              Copyright (C) 2026 M3D1D contributors
+======================================================================*/
+/*!
+  @file   adapt1d.hpp
+  @author M3D1D contributors
+  @date   October 2026.
+  @brief  Declaration of the adaptive refinement/coarsening of the 1D network mesh.
+  @details
+	Each branch of the network is seen as a polyline (the vertices of
+	its elements, from the start to the end of the branch). The error
+	indicator of an element is the estimated interpolation error of the
+	sampled fields, @f$ \eta_e = h_e^2 |u''|/8 @f$, divided by the range
+	of the field; @f$ u'' @f$ is the second difference at the vertices.
+
+	An element is split at its midpoint if @f$ \eta_e > \mathrm{TOL} @f$,
+	if it turns more than ANGLE (curvature3d times length) or if it is
+	longer than HMAX. An interior vertex is removed if the merged element
+	would have @f$ \eta < \mathrm{TOL}/2 @f$, would turn less than ANGLE
+	and would be shorter than HMAX. No element shorter than HMIN is
+	created and the ends of the branches are never moved, so that the
+	junctions are preserved.
+
+	The new vertices are written back in a file of points with the same
+	arcs and boundary conditions, which is imported as the original one.
+
+	\ingroup geom
+ */
+#ifndef M3D1D_ADAPT1D_HPP_
+#define M3D1D_ADAPT1D_HPP_
+
+#include <getfem/getfem_mesh.h>
+#include <getfem/getfem_mesh_fem.h>
+#include <getfem/bgeot_ftool.h>
+#include <defines.hpp>
+
+namespace getfem {
+
+//! Parameters of the adaptation of the 1D mesh
+struct adapt1d_param {
+
+	//! Number of adaptation cycles (0 = no adaptation)
+	size_type CYCLES;
+	//! Tolerance on the relative interpolation error of each element
+	scalar_type TOL;
+	//! Minimum and maximum element length (0 = no limit)
+	scalar_type HMIN, HMAX;
+	//! Maximum angle [rad] between the ends of an element
+	scalar_type ANGLE;
+
+	adapt1d_param(void) : CYCLES(0), TOL(1.0E-3), HMIN(0), HMAX(0), ANGLE(0.1) {}
+
+	//! Import the parameters from the input file
+	void import(ftool::md_param & PARAM)
+	{
+		CYCLES = size_type(PARAM.int_value("ADAPT_CYCLES"));
+		if (PARAM.real_value("ADAPT_TOL") > 0)   TOL = PARAM.real_value("ADAPT_TOL");
+		HMIN = PARAM.real_value("ADAPT_HMIN");
+		HMAX = PARAM.real_value("ADAPT_HMAX");
+		if (PARAM.real_value("ADAPT_ANGLE") > 0) ANGLE = PARAM.real_value("ADAPT_ANGLE");
+		GMM_ASSERT1(HMAX == 0 || HMAX > 2.0*HMIN,
+			"ADAPT_HMAX must be larger than twice ADAPT_HMIN");
+	}
+
+	//! Overloading of the output operator
+	friend std::ostream & operator << (
+		std::ostream & out, const adapt1d_param & par
+		)
+	{
+		out << "---- 1D MESH ADAPTATION --------------------------" << endl;
+		out << " CYCLES    : " << par.CYCLES << endl;
+		out << " TOLERANCE : " << par.TOL    << endl;
+		out << " HMIN      : " << par.HMIN   << endl;
+		out << " HMAX      : " << par.HMAX   << endl;
+		out << " ANGLE     : " << par.ANGLE  << endl;
+		out << "--------------------------------------------------" << endl;
+		return out;
+	}
+};
+
+//! Ordered vertices of each branch (region i = branch i) of a 1D mesh
+void branch_polylines(const mesh & m, size_type nb_branches,
+	std::vector< std::vector<base_node> > & lines);
+
+//! Values of a field at the vertices of branch rg (same order of branch_polylines)
+/*!
+	@param mf  The finite element method of the field (defined on region rg)
+	@param U   The field (dofs of mf)
+	@param rg  Index of the region of the branch
+	@param V   Computed values, one per vertex
+ */
+void branch_vertex_values(const mesh_fem & mf, const vector_type & U,
+	size_type rg, vector_type & V);
+
+//! Update (maximum) the error indicator of the elements of a branch with a field
+/*!
+	@param line   Vertices of the branch
+	@param V      Field at the vertices
+	@param scale  Range of the field over the network (the indicator is relative)
+	@param eta    Indicator of each element (line.size()-1 entries)
+ */
+void interpolation_indicator(const std::vector<base_node> & line,
+	const vector_type & V, scalar_type scale, vector_type & eta);
+
+//! Refine and coarsen a branch (returns the number of split and removed elements)
+size_type adapt_polyline(const std::vector<base_node> & line,
+	const vector_type & eta, const adapt1d_param & par,
+	std::vector<base_node> & newline);
+
+//! Copy a file of points replacing the points of each arc with the given vertices
+void rewrite_pts_file(std::istream & in, std::ostream & out,
+	const std::vector< std::vector<base_node> > & lines);
+
+} /* end of namespace */
+
+#endif
@@ -22,6 +22,7 @@
 #include <utilities.hpp>
 #include <algorithm>
 #include <Fahraeus.hpp>
+#include <topology1dHT.hpp>
 
 namespace getfem {
 //! Build the advection and artificial diffusion matrices for the 1D Hematocrit transport problem,
@@ -114,6 +115,8 @@ generic_assembly
 
 } /*end asm_advection_hematocrit_rvar */
 
+//! Build the artificial diffusion matrix @f$ \int_\Lambda \nu\, h' \varphi' ds @f$ of a branch,
+//! with the coefficient @f$ \nu @f$ given on mf_data (diff)
 template<typename MAT, typename VEC>
 void 
 asm_network_artificial_diffusion
@@ -127,10 +130,60 @@ asm_network_artificial_diffusion
 	 
 	 {
 
- getfem::asm_stiffness_matrix_for_laplacian(D,mim,mf_h,mf_h, diff, rg);
+ getfem::asm_stiffness_matrix_for_laplacian(D,mim,mf_h,mf_data, diff, rg);
 
 } /*end asm_network_artificial_diffusion */
 
+//! Build the per-element diffusion coefficient of the streamline upwind (SUPG) stabilization
+//! @f$ \nu_e = A\,\kappa + A\,\frac{|u_e| h_e}{2}\,\xi(Pe_e) @f$, 
+//! @f$ \xi(Pe) = \coth(Pe) - 1/Pe @f$, @f$ Pe_e = \frac{|u_e| h_e}{2 \kappa} @f$
+/*!
+	For the pure advection of the hematocrit with linear elements the SUPG
+	term reduces to a streamline diffusion, so the coefficient is used with
+	asm_network_artificial_diffusion. Unlike the global artificial diffusion,
+	it scales with the local velocity and element size: slow branches and 
+	fine elements are not over-diffused.
+
+	@param diff      Computed coefficient on mf_coef
+	@param mf_coef   The finite element method for the coefficient (piecewise constant)
+	@param mf_u      The finite element method for the velocity @f$ \mathbf{u} @f$
+	@param U	 Velocity of the branch
+	@param area      Cross section area of the branch
+	@param kappa     Physical diffusivity of the hematocrit (0 = pure advection, @f$ \xi=1 @f$)
+	@param rg        Index of the region of the branch
+
+	@ingroup asm
+ */ 
+template<typename VEC>
+void 
+asm_hematocrit_supg_coef
+	(VEC & diff,
+	 const mesh_fem & mf_coef,
+	 const mesh_fem & mf_u,
+	 const VEC & U,
+	 const scalar_type area,
+	 const scalar_type kappa,
+	 const size_type rg
+	 ) 	
+{
+	// Velocity at the element centers
+	VEC Ue(mf_coef.nb_dof());
+	getfem::interpolation(mf_u, mf_coef, U, Ue);
+	gmm::resize(diff, mf_coef.nb_dof()); gmm::clear(diff);
+	const mesh & m = mf_coef.linked_mesh();
+	for (getfem::mr_visitor mrv(m.region(rg)); !mrv.finished(); ++mrv){
+		size_type j = mf_coef.ind_basic_dof_of_element(mrv.cv())[0];
+		scalar_type h = m.convex_area_estimate(mrv.cv(), 2);
+		scalar_type uh = fabs(Ue[j])*h/2.0;
+		scalar_type xi = 1.0;
+		if (kappa > 0){
+			scalar_type Pe = uh/kappa;
+			xi = (Pe < 1.0E-3) ? Pe/3.0 : 1.0/tanh(Pe) - 1.0/Pe;
+		}
+		diff[j] = area*(kappa + uh*xi);
+	}
+} /*end asm_hematocrit_supg_coef */
+
 //! Build the junction matrices for the 1D Hematocrit transport problem,
 //! --> conservation of mass or Pries formula for birfucation (Pries et al 2005)
 /*!
@@ -288,6 +341,78 @@ asm_hematocrit_junctions
 	
 } /* end of asm_junctions */
 
+//! Build the junction matrix for the 1D Hematocrit transport problem from the network topology,
+//! --> conservation of mass or Pries formula for birfucation (Pries et al 2005)
+/*!
+	Same matrix of asm_hematocrit_junctions, without scanning the rows of 
+	the fluid junction matrix: inflow and outflow branches of each junction
+	are given by the topology.
+
+	@param Jh        Junction matrix for hematocrit problem
+	@param T         Oriented topology of the network (updated with the current velocity)
+	@param diameter  Diameter of each branch [um]
+	@param H_old	 Hematocrit along the vessel in previous iteration
+
+	@ingroup asm
+ */ 
+template<typename MAT, typename VEC>
+void
+asm_hematocrit_junctions
+	(MAT & Jh,
+	 const network_topology & T,
+	 const VEC & diameter,
+	 const VEC & H_old
+	 ) 
+{
+	GMM_ASSERT1 (T.oriented(), "network topology not updated with the velocity");
+	// Flux of the branch end in the junction balance: positive if it leaves the junction
+	auto flux = [&T](size_type i, size_type e){ return e ? -T.Q(i,1) : T.Q(i,0); };
+
+	for (size_type n=0; n<T.nb_junctions(); ++n){
+		// Outflow branches with positive flux
+		size_type nb_pos = 0;
+		for (size_type k=0; k<T.nb_out(n); ++k)
+			if (flux(T.out_branch(n,k), T.out_end(n,k)) > 0) nb_pos++;
+		// Father: inflow branch with negative flux and lowest dof
+		size_type father = network_topology::none, end_f = 0, col_f = 0;
+		for (size_type k=0; k<T.nb_in(n); ++k){
+			size_type i = T.in_branch(n,k), e = T.in_end(n,k);
+			if (flux(i,e) < 0 && (father == network_topology::none || T.h_dof(i,e) < col_f)){
+				father = i; end_f = e; col_f = T.h_dof(i,e);
+			}
+		}
+
+		for (size_type k=0; k<T.nb_out(n); ++k){
+			size_type i = T.out_branch(n,k), e = T.out_end(n,k);
+			size_type row = T.h_dof(i,e);
+			if (flux(i,e) <= 0) continue;
+			if (nb_pos == 2 && father != network_topology::none){
+				// Bifurcation: the other outflow branch with positive flux
+				size_type other = i;
+				for (size_type kk=0; kk<T.nb_out(n); ++kk){
+					size_type ii = T.out_branch(n,kk), ee = T.out_end(n,kk);
+					if ((ii != i || ee != e) && flux(ii,ee) > 0) other = ii;
+				}
+				scalar_type flux_f = flux(father, end_f);
+				scalar_type FQB = -flux(i,e)/flux_f;  // flow fraction: outflow / the father
+				scalar_type FQE = fractional_Erythrocytes(FQB, diameter[father], diameter[i], diameter[other], H_old[col_f]);
+				Jh(row, col_f) = flux_f*FQE;
+			}
+			else {
+				// Mass conservation: all the other branches of the junction
+				for (size_type kk=0; kk<T.nb_in(n); ++kk){
+					size_type ii = T.in_branch(n,kk), ee = T.in_end(n,kk);
+					Jh(row, T.h_dof(ii,ee)) = flux(ii,ee);
+				}
+				for (size_type kk=0; kk<T.nb_out(n); ++kk){
+					size_type ii = T.out_branch(n,kk), ee = T.out_end(n,kk);
+					if (ii != i || ee != e) Jh(row, T.h_dof(ii,ee)) = flux(ii,ee);
+				}
+			}
+		}
+	}
+} /* end of asm_hematocrit_junctions */
+
 
 template<typename MAT, typename VEC>
 void
@@ -668,6 +793,23 @@ for (size_type i=0; i < mf_h.size(); i++) {   // branch loop
 
 }/* end of asm_HT_out*/
 
+//! Add the outflow term at the downstream end of each branch, from the network topology
+template<typename MAT>
+void
+asm_HT_out
+	(MAT & M,
+	 const network_topology & T
+	) 
+{
+	GMM_ASSERT1 (T.oriented(), "network topology not updated with the velocity");
+	for (size_type i=0; i < T.nb_branches(); i++) {   // branch loop
+		if (T.Q(i,1) > 0)
+			M(T.h_dof(i,1), T.h_dof(i,1)) += T.Q(i,1);
+		else
+			M(T.h_dof(i,0), T.h_dof(i,0)) -= T.Q(i,0);
+	}
+}/* end of asm_HT_out*/
+
 template<typename MAT, typename VEC>
 void
 asm_HT_out_rvar
@@ -0,0 +1,378 @@
+/* -*- c++ -*- (enables emacs c++ mode) */
+/*======================================================================
+    "Mixed Finite Element Methods for Coupled 3D/1D Fluid Problems"
+
+              Copyright (C) 2026 M3D1D contributors
+======================================================================*/
+/*!
+  @file   cache3d1d.cpp
+  @author M3D1D contributors
+  @date   October 2026.
+  @brief  Definition of the on-disk cache of preprocessed geometry and coupling operators.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cache3d1d.hpp>
+
+namespace getfem {
+
+// Aux functions for binary I/O of scalars, strings and nodes
+namespace {
+
+const char *  CACHE_MAGIC   = "M3D1DCACHE";
+const std::uint32_t CACHE_VERSION = 2;
+
+template <typename T>
+void write_pod(std::ostream & o, const T & v)
+{ o.write(reinterpret_cast<const char *>(&v), sizeof(T)); }
+
+template <typename T>
+void read_pod(std::istream & i, T & v)
+{ i.read(reinterpret_cast<char *>(&v), sizeof(T)); }
+
+void write_header(std::ostream & o, const std::string & kind, std::uint64_t key)
+{
+	o.write(CACHE_MAGIC, std::strlen(CACHE_MAGIC));
+	write_pod(o, CACHE_VERSION);
+	write_pod(o, std::uint64_t(kind.size()));
+	o.write(kind.data(), kind.size());
+	write_pod(o, key);
+}
+
+bool check_header(std::istream & i, const std::string & kind, std::uint64_t key)
+{
+	std::string magic(std::strlen(CACHE_MAGIC), ' ');
+	i.read(&magic[0], magic.size());
+	std::uint32_t ver = 0; read_pod(i, ver);
+	std::uint64_t len = 0; read_pod(i, len);
+	if (!i.good() || magic != CACHE_MAGIC || ver != CACHE_VERSION || len != kind.size())
+		return false;
+	std::string k(len, ' ');
+	i.read(&k[0], len);
+	std::uint64_t stored = 0; read_pod(i, stored);
+	return i.good() && k == kind && stored == key;
+}
+
+void write_nodes(std::ostream & o, const vector<node> & N)
+{
+	write_pod(o, std::uint64_t(N.size()));
+	for (const node & n : N) {
+		write_pod(o, std::uint64_t(n.label.size()));
+		o.write(n.label.data(), n.label.size());
+		write_pod(o, n.value);
+		write_pod(o, std::uint64_t(n.idx));
+		write_pod(o, std::uint64_t(n.rg));
+		write_pod(o, std::uint64_t(n.branches.size()));
+		for (long signed int b : n.branches) write_pod(o, std::int64_t(b));
+	}
+}
+
+void read_nodes(std::istream & i, vector<node> & N)
+{
+	std::uint64_t size = 0; read_pod(i, size);
+	N.clear(); N.reserve(size);
+	for (std::uint64_t k = 0; k < size && i.good(); ++k) {
+		std::uint64_t len = 0; read_pod(i, len);
+		std::string label(len, ' ');
+		if (len > 0) i.read(&label[0], len);
+		scalar_type value = 0; read_pod(i, value);
+		std::uint64_t idx = 0, rg = 0, nb = 0;
+		read_pod(i, idx); read_pod(i, rg); read_pod(i, nb);
+		N.emplace_back(label, value, idx, rg);
+		for (std::uint64_t b = 0; b < nb; ++b) {
+			std::int64_t br = 0; read_pod(i, br);
+			N.back().branches.emplace_back(br);
+		}
+	}
+	GMM_ASSERT1(i.good(), "corrupted cache entry: truncated node list");
+}
+
+void write_vectors(std::ostream & o, const vector<vector_type> & V)
+{
+	write_pod(o, std::uint64_t(V.size()));
+	for (const vector_type & v : V) write_binary_vector(o, v);
+}
+
+void read_vectors(std::istream & i, vector<vector_type> & V)
+{
+	std::uint64_t size = 0; read_pod(i, size);
+	GMM_ASSERT1(i.good(), "corrupted cache entry: cannot read vector list");
+	V.resize(size);
+	for (vector_type & v : V) read_binary_vector(i, v);
+}
+
+} /* end of anonymous namespace */
+
+
+void
+cache3d1d::import(ftool::md_param & PARAM)
+{
+	DIR = PARAM.string_value("CACHE_DIR");
+	GEOMETRY_KEY = 0;
+	if (DIR == "") return;
+	if (DIR.back() != '/') DIR += "/";
+
+	std::uint64_t h = hash_string("M3D1D", 14695981039346656037ULL);
+	if (PARAM.int_value("TEST_GEOMETRY")) {
+		// A noised regular mesh is random: it cannot be cached
+		std::string noised = PARAM.string_value("NOISED_T");
+		if (noised != "" && noised != "0") {
+			cout << "  Cache disabled: NOISED_T regular mesh is not reproducible" << endl;
+			return;
+		}
+		h = hash_string(PARAM.string_value("GT_T"), h);
+		h = hash_string(PARAM.string_value("NSUBDIV_T"), h);
+		h = hash_string(PARAM.string_value("ORG_T"), h);
+		h = hash_string(PARAM.string_value("SIZES_T"), h);
+	}
+	else
+		h = hash_file(PARAM.string_value("MESH_FILET"), h);
+	h = hash_file(PARAM.string_value("MESH_FILEV"), h);
+	int curve  = PARAM.int_value("CURVE_PROBLEM");
+	int import = PARAM.int_value("IMPORT_CURVE");
+	h = hash_bytes(&curve, sizeof(curve), h);
+	h = hash_bytes(&import, sizeof(import), h);
+	if (curve && import)
+		h = hash_file(PARAM.string_value("CURVE_FILE"), h);
+	const char * descriptors[] = {"MESH_TYPET", "MESH_TYPEV",
+		"FEM_TYPET", "FEM_TYPET_P", "FEM_TYPET_DATA",
+		"FEM_TYPEV", "FEM_TYPEV_P", "FEM_TYPEV_DATA",
+		"IM_TYPET", "IM_TYPEV"};
+	for (const char * d : descriptors)
+		h = hash_string(PARAM.string_value(d), h);
+	GEOMETRY_KEY = (h == 0) ? 1 : h;
+
+	#ifdef M3D1D_VERBOSE_
+	cout << "  Cache directory " << DIR << ", geometry key "
+		 << std::hex << GEOMETRY_KEY << std::dec << endl;
+	#endif
+}
+
+std::uint64_t
+cache3d1d::coupling_key(size_type NInt, const vector_type & R) const
+{
+	std::uint64_t n = NInt;
+	std::uint64_t h = hash_bytes(&n, sizeof(n), GEOMETRY_KEY);
+	return hash_vector(R, h);
+}
+
+std::uint64_t
+cache3d1d::boundary_key(const vector_type & R) const
+{
+	return hash_vector(R, hash_string("boundary", GEOMETRY_KEY));
+}
+
+bool
+cache3d1d::load_exchange(std::uint64_t key,
+	sparse_matrix_type & Mbar, sparse_matrix_type & Mlin) const
+{
+	if (!enabled()) return false;
+	std::ifstream ifs(filename("exchange", key), std::ios::binary);
+	if (!ifs.good() || !check_header(ifs, "exchange", key)) return false;
+	read_binary_matrix(ifs, Mbar);
+	read_binary_matrix(ifs, Mlin);
+	#ifdef M3D1D_VERBOSE_
+	cout << "  Loaded Mbar and Mlin from " << filename("exchange", key) << endl;
+	#endif
+	return true;
+}
+
+void
+cache3d1d::save_exchange(std::uint64_t key,
+	const sparse_matrix_type & Mbar, const sparse_matrix_type & Mlin) const
+{
+	if (!enabled()) return;
+	std::string fname = filename("exchange", key);
+	std::ofstream ofs(fname + ".tmp", std::ios::binary | std::ios::trunc);
+	if (!ofs.good()) { cerr << "impossible to write cache file " << fname << endl; return; }
+	write_header(ofs, "exchange", key);
+	write_binary_matrix(ofs, Mbar);
+	write_binary_matrix(ofs, Mlin);
+	ofs.close();
+	std::rename((fname + ".tmp").c_str(), fname.c_str());
+}
+
+bool
+cache3d1d::load_curve(std::uint64_t key,
+	vector<vector_type> & Curv, vector<vector_type> & lambdax,
+	vector<vector_type> & lambday, vector<vector_type> & lambdaz) const
+{
+	if (!enabled()) return false;
+	std::ifstream ifs(filename("curve", key), std::ios::binary);
+	if (!ifs.good() || !check_header(ifs, "curve", key)) return false;
+	read_vectors(ifs, Curv);
+	read_vectors(ifs, lambdax);
+	read_vectors(ifs, lambday);
+	read_vectors(ifs, lambdaz);
+	#ifdef M3D1D_VERBOSE_
+	cout << "  Loaded curvature and tangent versors from " << filename("curve", key) << endl;
+	#endif
+	return true;
+}
+
+void
+cache3d1d::save_curve(std::uint64_t key,
+	const vector<vector_type> & Curv, const vector<vector_type> & lambdax,
+	const vector<vector_type> & lambday, const vector<vector_type> & lambdaz) const
+{
+	if (!enabled()) return;
+	std::string fname = filename("curve", key);
+	std::ofstream ofs(fname + ".tmp", std::ios::binary | std::ios::trunc);
+	if (!ofs.good()) { cerr << "impossible to write cache file " << fname << endl; return; }
+	write_header(ofs, "curve", key);
+	write_vectors(ofs, Curv);
+	write_vectors(ofs, lambdax);
+	write_vectors(ofs, lambday);
+	write_vectors(ofs, lambdaz);
+	ofs.close();
+	std::rename((fname + ".tmp").c_str(), fname.c_str());
+}
+
+bool
+cache3d1d::load_boundary(std::uint64_t key, mesh & meshv, size_type nb_branches,
+	vector<node> & BCv, vector<node> & Jv,
+	size_type & nb_extrema, size_type & nb_junctions) const
+{
+	if (!enabled()) return false;
+	std::ifstream ifs(filename("boundary", key), std::ios::binary);
+	if (!ifs.good() || !check_header(ifs, "boundary", key)) return false;
+	vector<node> BC, J;
+	read_nodes(ifs, BC);
+	read_nodes(ifs, J);
+	std::uint64_t nb_ext = 0, nb_jun = 0;
+	read_pod(ifs, nb_ext); read_pod(ifs, nb_jun);
+	// Single-face regions (region, convex, face)
+	std::uint64_t nb_rg = 0; read_pod(ifs, nb_rg);
+	vector<std::uint64_t> faces(3*nb_rg);
+	for (auto & f : faces) read_pod(ifs, f);
+	GMM_ASSERT1(ifs.good(), "corrupted cache entry " << filename("boundary", key));
+	for (size_type k = 0; k < nb_rg; ++k) {
+		GMM_ASSERT1(faces[3*k] >= nb_branches && meshv.has_region(faces[3*k]) == 0,
+			"Overload in meshv region assembling!");
+		meshv.region(faces[3*k]).add(faces[3*k+1], short_type(faces[3*k+2]));
+	}
+	BCv = BC;
+	Jv = J;
+	nb_extrema = size_type(nb_ext);
+	nb_junctions = size_type(nb_jun);
+	#ifdef M3D1D_VERBOSE_
+	cout << "  Loaded vessel boundary from " << filename("boundary", key) << endl;
+	#endif
+	return true;
+}
+
+void
+cache3d1d::save_boundary(std::uint64_t key, const mesh & meshv, size_type nb_branches,
+	const vector<node> & BCv, const vector<node> & Jv,
+	size_type nb_extrema, size_type nb_junctions) const
+{
+	if (!enabled()) return;
+	std::string fname = filename("boundary", key);
+	std::ofstream ofs(fname + ".tmp", std::ios::binary | std::ios::trunc);
+	if (!ofs.good()) { cerr << "impossible to write cache file " << fname << endl; return; }
+	write_header(ofs, "boundary", key);
+	write_nodes(ofs, BCv);
+	write_nodes(ofs, Jv);
+	write_pod(ofs, std::uint64_t(nb_extrema));
+	write_pod(ofs, std::uint64_t(nb_junctions));
+	vector<std::uint64_t> faces;
+	for (size_type rg = nb_branches; meshv.has_region(rg); ++rg)
+		for (getfem::mr_visitor mrv(meshv.region(rg)); !mrv.finished(); ++mrv) {
+			faces.emplace_back(rg);
+			faces.emplace_back(mrv.cv());
+			faces.emplace_back(mrv.f());
+		}
+	write_pod(ofs, std::uint64_t(faces.size()/3));
+	for (auto f : faces) write_pod(ofs, f);
+	ofs.close();
+	std::rename((fname + ".tmp").c_str(), fname.c_str());
+}
+
+std::uint64_t
+cache3d1d::hash_bytes(const void * data, size_type n, std::uint64_t h)
+{
+	const unsigned char * p = static_cast<const unsigned char *>(data);
+	for (size_type k = 0; k < n; ++k) {
+		h ^= p[k];
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
+std::uint64_t
+cache3d1d::hash_string(const std::string & s, std::uint64_t h)
+{
+	std::uint64_t n = s.size();
+	h = hash_bytes(&n, sizeof(n), h);
+	return hash_bytes(s.data(), s.size(), h);
+}
+
+std::uint64_t
+cache3d1d::hash_file(const std::string & fname, std::uint64_t h)
+{
+	std::ifstream ifs(fname, std::ios::binary);
+	if (!ifs.good()) return hash_string(fname, h);
+	char buf[65536];
+	while (ifs.read(buf, sizeof(buf)) || ifs.gcount() > 0)
+		h = hash_bytes(buf, ifs.gcount(), h);
+	return h;
+}
+
+std::uint64_t
+cache3d1d::hash_vector(const vector_type & V, std::uint64_t h)
+{
+	std::uint64_t n = V.size();
+	h = hash_bytes(&n, sizeof(n), h);
+	return V.empty() ? h : hash_bytes(&V[0], V.size()*sizeof(scalar_type), h);
+}
+
+std::string
+cache3d1d::filename(const std::string & kind, std::uint64_t key) const
+{
+	std::ostringstream name;
+	name << DIR << kind << "_" << std::hex << std::setw(16) << std::setfill('0') << key << ".bin";
+	return name.str();
+}
+
+
+// Write a sparse matrix in binary form: nrows, ncols, then (nnz, (index, value)*) per row
+void
+write_binary_matrix(std::ostream & o, const sparse_matrix_type & M)
+{
+	write_pod(o, std::uint64_t(gmm::mat_nrows(M)));
+	write_pod(o, std::uint64_t(gmm::mat_ncols(M)));
+	for (size_type i = 0; i < gmm::mat_nrows(M); ++i) {
+		const sparse_vector_type & row = gmm::mat_const_row(M, i);
+		write_pod(o, std::uint64_t(gmm::nnz(row)));
+		auto it = gmm::vect_const_begin(row), ite = gmm::vect_const_end(row);
+		for (; it != ite; ++it) {
+			write_pod(o, std::uint64_t(it.index()));
+			write_pod(o, scalar_type(*it));
+		}
+	}
+}
+
+// Read a sparse matrix written by write_binary_matrix
+void
+read_binary_matrix(std::istream & i, sparse_matrix_type & M)
+{
+	std::uint64_t nr = 0, nc = 0;
+	read_pod(i, nr); read_pod(i, nc);
+	GMM_ASSERT1(i.good(), "corrupted binary stream: cannot read matrix size");
+	gmm::resize(M, nr, nc); gmm::clear(M);
+	for (size_type r = 0; r < nr; ++r) {
+		std::uint64_t nnz = 0; read_pod(i, nnz);
+		for (std::uint64_t k = 0; k < nnz; ++k) {
+			std::uint64_t c = 0; scalar_type v = 0;
+			read_pod(i, c); read_pod(i, v);
+			M(r, c) = v;
+		}
+	}
+	GMM_ASSERT1(i.good(), "corrupted binary stream: truncated matrix");
+}
+
+} /* end of namespace */
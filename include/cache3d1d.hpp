@@ -0,0 +1,109 @@
+/* -*- c++ -*- (enables emacs c++ mode) */
+/*======================================================================
+    "Mixed Finite Element Methods for Coupled 3D/1D Fluid Problems"
+
+              Copyright (C) 2026 M3D1D contributors
+======================================================================*/
+/*!
+  @file   cache3d1d.hpp
+  @author M3D1D contributors
+  @date   October 2026.
+  @brief  Declaration of the on-disk cache of preprocessed geometry and coupling operators.
+  @details
+	Content-addressed cache stored in the directory CACHE_DIR:
+	- tangent versors and curvature of the network (key: geometry),
+	- boundary/junction node lists and their mesh regions (key: geometry + radii),
+	- aux exchange matrices @f$\bar{\Pi}_{tv}@f$, @f$\Pi_{tv}@f$ (key: geometry + NInt + radii).
+
+	The geometry key is a 64-bit FNV-1a hash of the mesh files (or regular
+	mesh descriptors) and of the GetFEM descriptors. An empty CACHE_DIR
+	disables the cache.
+
+	\ingroup input
+ */
+#ifndef M3D1D_CACHE3D1D_HPP_
+#define M3D1D_CACHE3D1D_HPP_
+
+#include <getfem/bgeot_ftool.h>
+#include <getfem/getfem_mesh.h>
+#include <gmm/gmm.h>
+#include <cstdint>
+#include <string>
+#include <defines.hpp>
+#include <node.hpp>
+#include <utilities.hpp>
+
+namespace getfem {
+
+//! Class to handle the on-disk cache of the 3D/1D preprocessing
+struct cache3d1d {
+
+	//! Cache directory ("" = cache disabled)
+	std::string DIR;
+	//! Key of the current geometry (0 = not cacheable)
+	std::uint64_t GEOMETRY_KEY;
+
+	cache3d1d(void) : DIR(""), GEOMETRY_KEY(0) {}
+
+	//! Import the cache directory and build the geometry key from file .param
+	void import(ftool::md_param & fname);
+	//! True if the cache can be used
+	inline bool enabled(void) const { return DIR != "" && GEOMETRY_KEY != 0; }
+
+	//! Key of the coupling operators (geometry + NInt + radii)
+	std::uint64_t coupling_key(size_type NInt, const vector_type & R) const;
+	//! Key of the network boundary (geometry + radii)
+	std::uint64_t boundary_key(const vector_type & R) const;
+
+	//! Load the aux exchange matrices Mbar, Mlin (false if not cached)
+	bool load_exchange(std::uint64_t key,
+		sparse_matrix_type & Mbar, sparse_matrix_type & Mlin) const;
+	//! Store the aux exchange matrices Mbar, Mlin
+	void save_exchange(std::uint64_t key,
+		const sparse_matrix_type & Mbar, const sparse_matrix_type & Mlin) const;
+
+	//! Load curvature and tangent versors of each branch (false if not cached)
+	bool load_curve(std::uint64_t key,
+		vector<vector_type> & Curv, vector<vector_type> & lambdax,
+		vector<vector_type> & lambday, vector<vector_type> & lambdaz) const;
+	//! Store curvature and tangent versors of each branch
+	void save_curve(std::uint64_t key,
+		const vector<vector_type> & Curv, const vector<vector_type> & lambdax,
+		const vector<vector_type> & lambday, const vector<vector_type> & lambdaz) const;
+
+	//! Load the boundary/junction lists and counters, rebuild their regions in meshv (false if not cached)
+	bool load_boundary(std::uint64_t key, mesh & meshv, size_type nb_branches,
+		vector<node> & BCv, vector<node> & Jv,
+		size_type & nb_extrema, size_type & nb_junctions) const;
+	//! Store the boundary/junction lists, their counters and the single-face regions built on meshv
+	void save_boundary(std::uint64_t key, const mesh & meshv, size_type nb_branches,
+		const vector<node> & BCv, const vector<node> & Jv,
+		size_type nb_extrema, size_type nb_junctions) const;
+
+	// Hashing utils (64-bit FNV-1a)
+	//! Hash a raw buffer
+	static std::uint64_t hash_bytes(const void * data, size_type n, std::uint64_t h);
+	//! Hash a string
+	static std::uint64_t hash_string(const std::string & s, std::uint64_t h);
+	//! Hash the content of a file (the name is hashed if the file cannot be read)
+	static std::uint64_t hash_file(const std::string & fname, std::uint64_t h);
+	//! Hash a dense vector
+	static std::uint64_t hash_vector(const vector_type & V, std::uint64_t h);
+
+private:
+	//! Full path of the cache entry of given kind and key
+	std::string filename(const std::string & kind, std::uint64_t key) const;
+
+}; /* end of class */
+
+//! Aux function to write a sparse matrix in binary form (row-wise)
+void
+write_binary_matrix(std::ostream & o, const sparse_matrix_type & M);
+
+//! Aux function to read a sparse matrix written by write_binary_matrix
+void
+read_binary_matrix(std::istream & i, sparse_matrix_type & M);
+
+} /* end of namespace */
+
+#endif
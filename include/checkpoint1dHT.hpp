@@ -0,0 +1,142 @@
+/* -*- c++ -*- (enables emacs c++ mode) */
+/*======================================================================
+    "Mixed Finite Element Methods for Coupled 3D/1D Fluid Problems"
+
+              Copyright (C) 2026 M3D1D contributors
+======================================================================*/
+/*!
+  @file   checkpoint1dHT.hpp
+  @author M3D1D contributors
+  @date   October 2026.
+  @brief  Definition of the aux class for checkpoint/restart of the fixed point method.
+  @details
+	The state of problemHT::solve_fixpoint is dumped in a binary file:
+	- fixed point iteration count,
+	- monolithic fluid solution UM,
+	- hematocrit solution UM_HT,
+	- viscosity MU,
+	- (compliant) radius, cross section area and perimeter,
+	- residual history (solution, mass conservation, hematocrit).
+
+	The file starts with a magic string and a format version; every vector
+	is stored as its length followed by the raw values (see write_binary_vector).
+ */
+
+#ifndef M3D1D_CHECKPOINT1DHT_HPP_
+#define M3D1D_CHECKPOINT1DHT_HPP_
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <utilities.hpp>
+
+namespace getfem {
+
+//! Class to save and reload the state of the coupled fixed point method
+struct checkpoint1dHT {
+
+	//! Number of completed fixed point iterations
+	size_type iteration;
+	//! Monolithic solution of the fluid problem
+	vector_type UM;
+	//! Solution of the hematocrit problem
+	vector_type UM_HT;
+	//! Viscosity on the network
+	vector_type MU;
+	//! Dimensionless radius
+	vector_type R;
+	//! Dimensionless areas of the cross sections
+	vector_type CSarea;
+	//! Dimensionless perimeters of the cross sections
+	vector_type CSper;
+	//! History of the solution residual
+	vector_type RES_SOL;
+	//! History of the mass conservation residual
+	vector_type RES_CM;
+	//! History of the hematocrit residual
+	vector_type RES_H;
+
+	checkpoint1dHT(void) : iteration(0) {}
+
+	//! Write the checkpoint to file
+	/*!
+		Data are first written to fname.tmp and then renamed, so that an
+		interrupted write never corrupts the previous checkpoint.
+	 */
+	void save(const std::string & fname) const
+	{
+		std::string tmpname = fname + ".tmp";
+		std::ofstream ofs(tmpname, std::ios::binary | std::ios::trunc);
+		GMM_ASSERT1(ofs.good(), "impossible to write checkpoint file " << tmpname);
+		ofs.write(magic(), std::strlen(magic()));
+		std::uint32_t ver = version();
+		ofs.write(reinterpret_cast<const char *>(&ver), sizeof(ver));
+		std::uint64_t it = iteration;
+		ofs.write(reinterpret_cast<const char *>(&it), sizeof(it));
+		write_binary_vector(ofs, UM);
+		write_binary_vector(ofs, UM_HT);
+		write_binary_vector(ofs, MU);
+		write_binary_vector(ofs, R);
+		write_binary_vector(ofs, CSarea);
+		write_binary_vector(ofs, CSper);
+		write_binary_vector(ofs, RES_SOL);
+		write_binary_vector(ofs, RES_CM);
+		write_binary_vector(ofs, RES_H);
+		GMM_ASSERT1(ofs.good(), "error while writing checkpoint file " << tmpname);
+		ofs.close();
+		GMM_ASSERT1(std::rename(tmpname.c_str(), fname.c_str()) == 0,
+			"impossible to move " << tmpname << " to " << fname);
+	}
+
+	//! Read the checkpoint from file
+	void load(const std::string & fname)
+	{
+		std::ifstream ifs(fname, std::ios::binary);
+		GMM_ASSERT1(ifs.good(), "impossible to read checkpoint file " << fname);
+		std::string head(std::strlen(magic()), ' ');
+		ifs.read(&head[0], head.size());
+		GMM_ASSERT1(ifs.good() && head == magic(),
+			"file " << fname << " is not a valid checkpoint");
+		std::uint32_t ver = 0;
+		ifs.read(reinterpret_cast<char *>(&ver), sizeof(ver));
+		GMM_ASSERT1(ver == version(),
+			"unsupported checkpoint version " << ver << " in " << fname);
+		std::uint64_t it = 0;
+		ifs.read(reinterpret_cast<char *>(&it), sizeof(it));
+		iteration = it;
+		read_binary_vector(ifs, UM);
+		read_binary_vector(ifs, UM_HT);
+		read_binary_vector(ifs, MU);
+		read_binary_vector(ifs, R);
+		read_binary_vector(ifs, CSarea);
+		read_binary_vector(ifs, CSper);
+		read_binary_vector(ifs, RES_SOL);
+		read_binary_vector(ifs, RES_CM);
+		read_binary_vector(ifs, RES_H);
+		ifs.close();
+	}
+
+	//! Overloading of the output operator
+	friend std::ostream & operator << (
+		std::ostream & out, const checkpoint1dHT & ckp
+		)
+	{
+		out << "--- CHECKPOINT ------------" << endl;
+		out << "  iteration  : " << ckp.iteration     << endl;
+		out << "  nb_dof_UM  : " << ckp.UM.size()     << endl;
+		out << "  nb_dof_H   : " << ckp.UM_HT.size()  << endl;
+		out << "  nb_dof_MU  : " << ckp.MU.size()     << endl;
+		out << "--------------------------" << endl;
+		return out;
+	}
+
+private:
+	static const char * magic(void) { return "M3D1DHTCKP"; }
+	static std::uint32_t version(void) { return 1; }
+
+}; /* end of class */
+
+} /* end of namespace */
+
+#endif
@@ -0,0 +1,78 @@
+/* -*- c++ -*- (enables emacs c++ mode) */
+/*======================================================================
+    "Mixed Finite Element Methods for Coupled 3D/1D Fluid Problems"
+
+              Copyright (C) 2026 M3D1D contributors
+======================================================================*/
+/*!
+  @file   compliance1dHT.cpp
+  @author M3D1D contributors
+  @date   October 2026.
+  @brief  Definition of the radius update kernel of compliant vessels.
+ */
+
+#include <compliance1dHT.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace getfem {
+
+void
+compliant_radius_update(const compliance_param & P, compliance_soa & S)
+{
+	size_type n = S.size();
+	GMM_ASSERT1(S.hu.size() == n && S.E.size() == n && S.curv.size() == n &&
+		S.p_int.size() == n && S.p_ext.size() == n,
+		"compliant vessels: input arrays of different size");
+	S.R.resize(n); S.area.resize(n); S.per.resize(n); S.cond.resize(n);
+	if (n == 0) return;
+
+	const scalar_type nu = P.nu;
+	const scalar_type nu2 = 1.0 - nu*nu;
+	const scalar_type * Ru = &S.Ru[0];
+	const scalar_type * hu = &S.hu[0];
+	const scalar_type * E  = &S.E[0];
+	const scalar_type * k  = &S.curv[0];
+	const scalar_type * pint = &S.p_int[0];
+	const scalar_type * pext = &S.p_ext[0];
+	scalar_type * R    = &S.R[0];
+	scalar_type * area = &S.area[0];
+	scalar_type * per  = &S.per[0];
+	scalar_type * cond = &S.cond[0];
+
+	for (size_type j = 0; j < n; ++j) {
+		scalar_type deltap = pext[j] - pint[j];
+		scalar_type ratio  = hu[j]/Ru[j];
+		scalar_type ratio3 = ratio*ratio*ratio;
+		scalar_type Ru2 = Ru[j]*Ru[j];
+		scalar_type Ro2 = (Ru[j]+hu[j])*(Ru[j]+hu[j]);
+		// Arteriole: the cross section remains circular (thick wall)
+		scalar_type den = Ro2 - Ru2;
+		scalar_type B1  = (pint[j]*Ru2 - pext[j]*Ro2)/den;
+		scalar_type B2  = deltap*Ru2*Ro2/den;
+		scalar_type R_art = Ru[j]*(1.0 + (1.0-nu)/E[j]*B1 - (1.0+nu)/E[j]*B2/Ru2);
+		// Venule below the buckling threshold: circular (thin wall)
+		scalar_type R_ven = Ru[j]*(1.0 - nu2/ratio/E[j]*deltap);
+		scalar_type threshold = 0.25*E[j]*ratio3/nu2;
+		bool arteriole = (ratio >= 0.1);
+		bool buckled   = !arteriole && (deltap > threshold);
+		// Buckled venule: p_adim is the equivalent pressure of Tadjfar et al.;
+		// the hydraulic radius uses the actual area, while area and conductivity
+		// are frozen at the collapsed configuration p_adim = 5
+		scalar_type p_adim = std::max(deltap*12.0*nu2/E[j]/ratio3, 0.0);
+		scalar_type p_lim  = std::min(p_adim, 5.0);
+		scalar_type per_b  = 2.0*pi*Ru[j];
+		scalar_type R_b    = 15.95*exp(-0.545*p_adim)*Ru2/per_b;
+		scalar_type a_lim  = 15.95*exp(-0.545*p_lim);
+		scalar_type cond_b = a_lim*a_lim/(69.56*exp(-1.74*p_lim));
+		// Circular section
+		scalar_type R_c = arteriole ? R_art : R_ven;
+
+		R[j]    = buckled ? R_b : R_c;
+		area[j] = buckled ? a_lim*Ru2 : pi*R_c*R_c;
+		per[j]  = buckled ? per_b : 2.0*pi*R_c;
+		cond[j] = buckled ? cond_b : P.cond_circ*(1.0 + k[j]*k[j]*R_c*R_c);
+	}
+} /* end of compliant_radius_update */
+
+} /* end of namespace */
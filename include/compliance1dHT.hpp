@@ -0,0 +1,86 @@
+/* -*- c++ -*- (enables emacs c++ mode) */
+/*======================================================================
+    "Mixed Finite Element Methods for Coupled 3D/1D Fluid Problems"
+
+              Copyright (C) 2026 M3D1D contributors
+======================================================================*/
+/*!
+  @file   compliance1dHT.hpp
+  @author M3D1D contributors
+  @date   October 2026.
+  @brief  Declaration of the radius update kernel of compliant vessels.
+  @details
+	The deformed cross section of each coefficient dof only depends on
+	local data, so the update is a single loop over flat arrays
+	(structure of arrays) with no access to PARAM, to the mesh or to
+	the mesh_fem:
+	- arterioles (@f$h/R_u \ge 0.1@f$): thick-walled cylinder (Lamé);
+	- venules below the buckling threshold: thin-walled cylinder;
+	- buckled venules: tube law of Tadjfar et al. (hydraulic radius,
+	  collapsed configuration at @f$\tilde{p}=5@f$).
+ */
+
+#ifndef M3D1D_COMPLIANCE1DHT_HPP_
+#define M3D1D_COMPLIANCE1DHT_HPP_
+
+#include <getfem/getfem_mesh.h>
+#include <getfem/bgeot_ftool.h>
+#include <defines.hpp>
+
+namespace getfem {
+
+//! Constants of the compliant vessel model, resolved once from PARAM
+struct compliance_param {
+
+	//! Poisson modulus of the vessel wall [-]
+	scalar_type nu;
+	//! Factor of the conductivity of a circular section, @f$ 2(\gamma+2)\pi\,U/(P\,d) @f$
+	scalar_type cond_circ;
+
+	compliance_param(void) : nu(0), cond_circ(0) {}
+
+	//! Import the constants from the input file
+	void import(ftool::md_param & PARAM)
+	{
+		scalar_type U_    = PARAM.real_value("U", "characteristic flow speed in the capillary bed [m/s]");
+		scalar_type P_    = PARAM.real_value("P", "average interstitial pressure [Pa]");
+		scalar_type d     = PARAM.real_value("d", "Characteristic length of the problem [m]");
+		scalar_type Gamma = PARAM.real_value("Gamma", "Order of velocity profile in the vessels");
+		nu = PARAM.real_value("nu", "Poisson modulus of the vessel wall");
+		// area^2/R^4 = pi^2 for a circular section
+		cond_circ = U_/P_/d*2.0*(Gamma+2.0)*pi;
+	}
+};
+
+//! Structure of arrays of the compliant vessel model (one entry per coefficient dof)
+struct compliance_soa {
+
+	//! Inputs: undeformed radius, wall thickness, dimensionless Young modulus, curvature
+	vector_type Ru, hu, E, curv;
+	//! Inputs: internal and external pressure
+	vector_type p_int, p_ext;
+	//! Outputs: radius, area, perimeter and conductivity of the deformed section
+	vector_type R, area, per, cond;
+
+	//! Number of entries
+	inline size_type size(void) const { return Ru.size(); }
+	//! Resize all the arrays
+	void resize(size_type n)
+	{
+		Ru.resize(n); hu.resize(n); E.resize(n); curv.resize(n);
+		p_int.resize(n); p_ext.resize(n);
+		R.resize(n); area.resize(n); per.resize(n); cond.resize(n);
+	}
+};
+
+//! Compute radius, area, perimeter and conductivity of all the entries in one pass
+/*!
+	The loop body has no function calls besides exp and no early exits:
+	the three regimes are evaluated and blended, so that the loop can be
+	vectorized and split among threads.
+ */
+void compliant_radius_update(const compliance_param & P, compliance_soa & S);
+
+} /* end of namespace */
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef DARCYPRECONDAV
+#define DARCYPRECONDAV
+
+#include "darcy_preconditioner_mon.hpp"
+
+// Block diagonal preconditioner of the arterial-venous problem
+// [Ut; Pt; Uva; Pva; Uvv; Pvv] (see merge_and_solve):
+// - tissue and arterial blocks: darcy_precond_mon;
+// - venous block: diag(Mvv)^-1 on the velocity, inverse of the pressure
+//   mass matrix (SuperLU) on the pressure, as for the arterial block.
+template <class MATRIX>
+class darcy_precond_av
+{
+public:
+    darcy_precond_av(const MATRIX &At,
+                  const getfem::mesh_fem mf_p,
+                  const getfem::mesh_im mim,
+                  const MATRIX &Ava,
+                  const getfem::mesh_fem mf_p_a,
+                  const getfem::mesh_im mim_a,
+                  const MATRIX &Avv,
+                  const getfem::mesh_fem mf_p_v,
+                  const getfem::mesh_im mim_v);
+
+    getfem::size_type nrows() const { return n_ + gmm::mat_nrows(Avv_) + gmm::mat_nrows(Sv_); }
+
+    getfem::size_type ncols() const { return nrows(); }
+
+    template <class L2, class L3>
+    void mult(const L2 &src, L3 &dst) const
+    {
+        const getfem::size_type n3 = gmm::mat_ncols(Avv_),
+                                n4 = gmm::mat_ncols(Sv_);
+        // Tissue and arteries
+        std::vector<double> r(n_), x(n_);
+        gmm::copy(gmm::sub_vector(src, gmm::sub_interval(0, n_)), r);
+        pa_.mult(r, x);
+        gmm::copy(x, gmm::sub_vector(dst, gmm::sub_interval(0, n_)));
+        // Veins
+        gmm::mult(pAvv_, gmm::sub_vector(src, gmm::sub_interval(n_, n3)),
+                  gmm::sub_vector(dst, gmm::sub_interval(n_, n3)));
+        sluv_.solve(gmm::sub_vector(dst, gmm::sub_interval(n_+n3, n4)),
+                    gmm::sub_vector(src, gmm::sub_interval(n_+n3, n4)));
+    }
+
+private:
+    darcy_precond_mon<MATRIX> pa_;
+    // Size of the tissue and arterial blocks
+    getfem::size_type n_;
+    const MATRIX &Avv_;
+    gmm::diagonal_precond<MATRIX> pAvv_;
+    MATRIX Sv_;
+    gmm::SuperLU_factor<double> sluv_;
+};
+
+
+namespace gmm {
+    template <class MATRIX>
+    struct linalg_traits<::darcy_precond_av<MATRIX>> {
+        using this_type = ::darcy_precond_av<MATRIX>;
+        using sub_orientation = owned_implementation;
+
+        static size_type nrows(const this_type &m) { return m.nrows(); }
+        static size_type ncols(const this_type &m) { return m.ncols(); }
+    };
+} // namespace gmm
+
+
+template <class MATRIX>
+darcy_precond_av<MATRIX>::darcy_precond_av(const MATRIX &At,
+                                     const getfem::mesh_fem mf_p,
+                                     const getfem::mesh_im mim,
+                                     const MATRIX &Ava,
+                                     const getfem::mesh_fem mf_p_a,
+                                     const getfem::mesh_im mim_a,
+                                     const MATRIX &Avv,
+                                     const getfem::mesh_fem mf_p_v,
+                                     const getfem::mesh_im mim_v)
+: pa_(At, mf_p, mim, Ava, mf_p_a, mim_a)
+, n_(gmm::mat_nrows(At) + mf_p.nb_dof() + gmm::mat_nrows(Ava) + mf_p_a.nb_dof())
+, Avv_(Avv) , pAvv_(Avv)
+{
+    getfem::ga_workspace wpv;
+
+    std::vector<double> pv(mf_p_v.nb_dof());
+    wpv.add_fem_variable("p", mf_p_v, gmm::sub_interval(0, mf_p_v.nb_dof()), pv);
+    wpv.add_expression("p*Test_p", mim_v);
+    wpv.assembly(2);
+
+    gmm::copy(wpv.assembled_matrix(), Sv_);
+    sluv_.build_with(Sv_);
+}
+
+#endif // ifndef DARCYPRECONDAV
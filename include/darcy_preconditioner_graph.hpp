@@ -0,0 +1,135 @@
+#ifndef DARCYPRECONDGRAPH
+#define DARCYPRECONDGRAPH
+
+#include "darcy_preconditioner.hpp"
+#include "network_graph.hpp"
+
+// Two-level preconditioner of the monolithic problem:
+// - tissue block [Ut; Pt]: darcy_precond (diagonal + Schur complement);
+// - vessel block [Uv; Pv] = [M  B; D  C]: block factorization with
+//     y_u = diag(M)^-1 r_u,  g = r_p - D y_u,
+//     x_p = two-level solve of S = C - D diag(M)^-1 B on g
+//           (coarse: P Ar^-1 P^T, Ar = reduced network graph;
+//            fine: one Jacobi sweep on S),
+//     x_u = diag(M)^-1 (r_u - B x_p).
+// The coarse problem has one unknown per junction/boundary node.
+template <class MATRIX>
+class darcy_precond_graph
+{
+public:
+    darcy_precond_graph(const MATRIX &At,
+                  const getfem::mesh_fem mf_p,
+                  const getfem::mesh_im mim,
+                  const MATRIX &Av,
+                  const getfem::size_type nb_dof_uv,
+                  const getfem::network_graph &graph);
+
+    getfem::size_type nrows() const {
+        return pt_.nrows() + gmm::mat_nrows(Av_);
+    }
+
+    getfem::size_type ncols() const {
+        return pt_.ncols() + gmm::mat_ncols(Av_);
+    }
+
+    template <class L2, class L3>
+    void mult(const L2 &src, L3 &dst) const
+    {
+        const getfem::size_type nt = pt_.nrows(),
+                                nu = nu_,
+                                np = gmm::mat_nrows(Av_) - nu_;
+        // Tissue
+        std::vector<double> rt(nt), xt(nt);
+        gmm::copy(gmm::sub_vector(src, gmm::sub_interval(0, nt)), rt);
+        pt_.mult(rt, xt);
+        gmm::copy(xt, gmm::sub_vector(dst, gmm::sub_interval(0, nt)));
+
+        // Vessel
+        std::vector<double> ru(nu), rp(np), yu(nu), g(np), xp(np), xu(nu);
+        gmm::copy(gmm::sub_vector(src, gmm::sub_interval(nt, nu)), ru);
+        gmm::copy(gmm::sub_vector(src, gmm::sub_interval(nt+nu, np)), rp);
+        for (getfem::size_type i = 0; i < nu; ++i) yu[i] = ru[i]*invM_[i];
+        gmm::mult(D_, gmm::scaled(yu, -1.0), rp, g);
+        // coarse correction
+        std::vector<double> gr, cr;
+        graph_.restrict_residual(g, gr);
+        graph_.solve(cr, gr);
+        graph_.prolong(cr, xp);
+        // Jacobi sweep on the fine Schur complement
+        std::vector<double> Sx(np);
+        gmm::mult(S_, xp, Sx);
+        for (getfem::size_type i = 0; i < np; ++i)
+            xp[i] += (g[i] - Sx[i])*invS_[i];
+        gmm::mult(B_, gmm::scaled(xp, -1.0), ru, xu);
+        for (getfem::size_type i = 0; i < nu; ++i) xu[i] *= invM_[i];
+        gmm::copy(xu, gmm::sub_vector(dst, gmm::sub_interval(nt, nu)));
+        gmm::copy(xp, gmm::sub_vector(dst, gmm::sub_interval(nt+nu, np)));
+    }
+
+private:
+    darcy_precond<MATRIX> pt_;
+    const MATRIX &Av_;
+    getfem::size_type nu_;
+    const getfem::network_graph &graph_;
+    // Inverse diagonal of M and of the approximate Schur complement S
+    std::vector<double> invM_, invS_;
+    // Off-diagonal blocks and approximate Schur complement
+    gmm::row_matrix<gmm::rsvector<double>> B_, D_, S_;
+};
+
+
+namespace gmm {
+    template <class MATRIX>
+    struct linalg_traits<::darcy_precond_graph<MATRIX>> {
+        using this_type = ::darcy_precond_graph<MATRIX>;
+        using sub_orientation = owned_implementation;
+
+        static size_type nrows(const this_type &m) { return m.nrows(); }
+        static size_type ncols(const this_type &m) { return m.ncols(); }
+    };
+} // namespace gmm
+
+
+template <class MATRIX>
+darcy_precond_graph<MATRIX>::darcy_precond_graph(const MATRIX &At,
+                                     const getfem::mesh_fem mf_p,
+                                     const getfem::mesh_im mim,
+                                     const MATRIX &Av,
+                                     const getfem::size_type nb_dof_uv,
+                                     const getfem::network_graph &graph)
+: pt_(At, mf_p, mim)
+, Av_(Av)
+, nu_(nb_dof_uv)
+, graph_(graph)
+{
+    const getfem::size_type nu = nu_,
+                            np = gmm::mat_nrows(Av) - nu_;
+    gmm::resize(B_, nu, np);
+    gmm::resize(D_, np, nu);
+    gmm::copy(gmm::sub_matrix(Av, gmm::sub_interval(0, nu), gmm::sub_interval(nu, np)), B_);
+    gmm::copy(gmm::sub_matrix(Av, gmm::sub_interval(nu, np), gmm::sub_interval(0, nu)), D_);
+
+    invM_.resize(nu);
+    for (getfem::size_type i = 0; i < nu; ++i) {
+        double m = Av(i, i);
+        invM_[i] = (m != 0.0) ? 1.0/m : 0.0;
+    }
+
+    // S = C - D diag(M)^-1 B
+    gmm::row_matrix<gmm::wsvector<double>> DMB(np, np), MB(nu, np);
+    gmm::copy(B_, MB);
+    for (getfem::size_type i = 0; i < nu; ++i)
+        gmm::scale(gmm::mat_row(MB, i), invM_[i]);
+    gmm::mult(D_, MB, DMB);
+    gmm::resize(S_, np, np);
+    gmm::copy(gmm::sub_matrix(Av, gmm::sub_interval(nu, np), gmm::sub_interval(nu, np)), S_);
+    gmm::add(gmm::scaled(DMB, -1.0), S_);
+
+    invS_.resize(np);
+    for (getfem::size_type i = 0; i < np; ++i) {
+        double s = S_(i, i);
+        invS_[i] = (s != 0.0) ? 1.0/s : 0.0;
+    }
+}
+
+#endif // ifndef DARCYPRECONDGRAPH
@@ -0,0 +1,83 @@
+#ifndef DARCYPRECONDSCHWARZ
+#define DARCYPRECONDSCHWARZ
+
+#include <gmm/gmm_superlu_interface.h>
+#include "gmm_fix.hpp"
+#include "mpi3d1d.hpp"
+
+// Restricted additive Schwarz preconditioner of the distributed monolithic
+// problem (one subdomain per process):
+//     z = sum_p R_p^owned A_p^-1 R_p r
+// A_p is the monolithic matrix restricted to the local dofs of the process
+// (owned + one layer of overlap, see tissue_partition), built from its owned
+// rows A and overlap rows H, and factorized with SuperLU. Only the owned
+// entries of the local solution are kept, so that the sum over the
+// processes does not count the overlap twice.
+template <class MATRIX>
+class darcy_precond_schwarz
+{
+public:
+    darcy_precond_schwarz(const MATRIX &A,
+                  const MATRIX &H,
+                  const getfem::tissue_partition &part);
+
+    getfem::size_type nrows() const { return n_; }
+    getfem::size_type ncols() const { return n_; }
+
+    //! Number of local dofs (size of the subdomain problem)
+    getfem::size_type nb_local() const { return part_.local_dofs().size(); }
+
+    template <class L2, class L3>
+    void mult(const L2 &src, L3 &dst) const
+    {
+        const std::vector<getfem::size_type> &loc = part_.local_dofs();
+        const getfem::size_type nl = loc.size();
+        std::vector<double> r(n_), z(n_, 0.0), rl(nl), zl(nl);
+        gmm::copy(src, r);
+        for (getfem::size_type k = 0; k < nl; ++k) rl[k] = r[loc[k]];
+        if (nl > 0) slu_.solve(zl, rl);
+        for (getfem::size_type k = 0; k < nl; ++k)
+            if (part_.owned(loc[k])) z[loc[k]] = zl[k];
+        getfem::mpi_sum(z);
+        gmm::copy(z, dst);
+    }
+
+private:
+    const getfem::tissue_partition &part_;
+    getfem::size_type n_;
+    gmm::SuperLU_factor<double> slu_;
+};
+
+
+namespace gmm {
+    template <class MATRIX>
+    struct linalg_traits<::darcy_precond_schwarz<MATRIX>> {
+        using this_type = ::darcy_precond_schwarz<MATRIX>;
+        using sub_orientation = owned_implementation;
+
+        static size_type nrows(const this_type &m) { return m.nrows(); }
+        static size_type ncols(const this_type &m) { return m.ncols(); }
+    };
+} // namespace gmm
+
+
+template <class MATRIX>
+darcy_precond_schwarz<MATRIX>::darcy_precond_schwarz(const MATRIX &A,
+                                     const MATRIX &H,
+                                     const getfem::tissue_partition &part)
+: part_(part)
+, n_(gmm::mat_nrows(A))
+{
+    const std::vector<getfem::size_type> &loc = part_.local_dofs();
+    const getfem::size_type nl = loc.size();
+    if (nl == 0) return;
+    gmm::sub_index I(loc);
+    gmm::row_matrix<gmm::rsvector<double>> Al(nl, nl);
+    gmm::copy(gmm::sub_matrix(A, I, I), Al);
+    gmm::add(gmm::sub_matrix(H, I, I), Al);
+    gmm::csc_matrix<double> Ac;
+    gmm::copy(Al, Ac);
+    slu_.build_with(Ac);
+}
+
+#endif // ifndef DARCYPRECONDSCHWARZ
@@ -46,6 +46,32 @@ struct descr1dHT {
 	bool HEMATOCRIT_TRANS; 
 	//! Flag to have complinat vessels
 	bool COMPLIANT_VESSELS;
+	//! Identifier of hematocrit solver ("FEM" or "SWEEP")
+	std::string HEMATOCRIT_SOLVER;
+	//! Identifier of the stabilization of the FEM hematocrit problem ("GLOBAL" artificial diffusion or per-element "SUPG")
+	std::string HT_STABILIZATION;
+	//! Physical diffusivity of the hematocrit (SUPG only, 0 = pure advection)
+	scalar_type HT_DIFFUSIVITY;
+	//! Flag to use lookup tables for the viscosity and phase separation laws
+	bool RHEOLOGY_TABLE;
+	//! Maximum interpolation error of the lookup tables
+	scalar_type RHEOLOGY_TABLE_TOL;
+	//! Initial number of intervals per variable of the lookup tables
+	size_type RHEOLOGY_TABLE_SIZE;
+	//! Flag to report the deviation of the lookup tables from the analytic laws
+	bool RHEOLOGY_TABLE_VALIDATE;
+	//! Absolute path to the checkpoint used to restart the fixed point method ("" = no restart)
+	std::string RESTART_FILE;
+	//! Absolute path to the checkpoint written during the fixed point method
+	std::string CHECKPOINT_FILE;
+	//! Number of iterations between two checkpoints (0 = no checkpoint)
+	size_type CHECKPOINT_IT;
+	//! Flag to export the columnar per-segment table of the network results
+	bool EXPORT_SEGMENTS;
+	//! Hematocrit convergence criterion ("RESIDUAL" or "BALANCE" of the RBC flux at the junctions)
+	std::string HEMATOCRIT_CONVERGENCE;
+	//! Number of junctions with the largest RBC imbalance reported at each iteration
+	size_type BALANCE_WORST;
 	// Utils
 	//! File .param
 	ftool::md_param FILE_;
@@ -63,7 +89,32 @@ struct descr1dHT {
 		FEM_TYPEH_DATA = FILE_.string_value("FEM_TYPEH_DATA");
 		IM_TYPEH 	= FILE_.string_value("IM_TYPEH","Name of integration method");
 		COMPLIANT_VESSELS = FILE_.int_value("COMPLIANT_VESSELS", "Flag to have compliant vessels");
-		if(FEM_TYPEH_DATA=="") FEM_TYPEH_DATA = "FEM_PK(1,0)";}
+		if(FEM_TYPEH_DATA=="") FEM_TYPEH_DATA = "FEM_PK(1,0)";
+		HEMATOCRIT_SOLVER = FILE_.string_value("HEMATOCRIT_SOLVER");
+		if(HEMATOCRIT_SOLVER=="") HEMATOCRIT_SOLVER = "FEM";
+		GMM_ASSERT1(HEMATOCRIT_SOLVER == "FEM" || HEMATOCRIT_SOLVER == "SWEEP",
+			"unknown HEMATOCRIT_SOLVER " << HEMATOCRIT_SOLVER << " (FEM or SWEEP)");
+		HT_STABILIZATION = FILE_.string_value("HT_STABILIZATION");
+		if(HT_STABILIZATION=="") HT_STABILIZATION = "GLOBAL";
+		GMM_ASSERT1(HT_STABILIZATION == "GLOBAL" || HT_STABILIZATION == "SUPG",
+			"unknown HT_STABILIZATION " << HT_STABILIZATION << " (GLOBAL or SUPG)");
+		HT_DIFFUSIVITY = FILE_.real_value("HT_DIFFUSIVITY");
+		RHEOLOGY_TABLE = FILE_.int_value("RHEOLOGY_TABLE");
+		RHEOLOGY_TABLE_TOL = FILE_.real_value("RHEOLOGY_TABLE_TOL");
+		if(RHEOLOGY_TABLE_TOL<=0) RHEOLOGY_TABLE_TOL = 1.0E-4;
+		RHEOLOGY_TABLE_SIZE = FILE_.int_value("RHEOLOGY_TABLE_SIZE");
+		if(RHEOLOGY_TABLE_SIZE==0) RHEOLOGY_TABLE_SIZE = 16;
+		RHEOLOGY_TABLE_VALIDATE = FILE_.int_value("RHEOLOGY_TABLE_VALIDATE");
+		RESTART_FILE    = FILE_.string_value("RESTART_FILE");
+		CHECKPOINT_FILE = FILE_.string_value("CHECKPOINT_FILE");
+		CHECKPOINT_IT   = FILE_.int_value("CHECKPOINT_ITERATION");
+		EXPORT_SEGMENTS = FILE_.int_value("EXPORT_SEGMENTS");
+		HEMATOCRIT_CONVERGENCE = FILE_.string_value("HEMATOCRIT_CONVERGENCE");
+		if(HEMATOCRIT_CONVERGENCE=="") HEMATOCRIT_CONVERGENCE = "RESIDUAL";
+		GMM_ASSERT1(HEMATOCRIT_CONVERGENCE == "RESIDUAL" || HEMATOCRIT_CONVERGENCE == "BALANCE",
+			"unknown HEMATOCRIT_CONVERGENCE " << HEMATOCRIT_CONVERGENCE << " (RESIDUAL or BALANCE)");
+		BALANCE_WORST = FILE_.int_value("BALANCE_WORST");
+		if(BALANCE_WORST==0) BALANCE_WORST = 5;}
 	}
 
 	//! Overloading of the output operator
@@ -76,6 +127,15 @@ struct descr1dHT {
 		cout << " IM  TYPE  1D problem      : " << descr.IM_TYPEH	<< endl;
 		cout << " FEM TYPE  1D velocity     : " << descr.FEM_TYPEH   << endl;
 		cout << " FEM TYPE  1D coefficients : " << descr.FEM_TYPEH_DATA << endl;
+		cout << " HEMATOCRIT SOLVER         : " << descr.HEMATOCRIT_SOLVER << endl;
+		cout << " HEMATOCRIT CONVERGENCE    : " << descr.HEMATOCRIT_CONVERGENCE << endl;
+		cout << " HEMATOCRIT STABILIZATION  : " << descr.HT_STABILIZATION << endl;
+		if(descr.RHEOLOGY_TABLE)
+		cout << " RHEOLOGY TABLES (tol)     : " << descr.RHEOLOGY_TABLE_TOL << endl;
+		if(descr.RESTART_FILE != "")
+		cout << " RESTART FILE              : " << descr.RESTART_FILE << endl;
+		if(descr.CHECKPOINT_IT > 0)
+		cout << " CHECKPOINT FILE           : " << descr.CHECKPOINT_FILE << " (every " << descr.CHECKPOINT_IT << " iterations)" << endl;
 		cout << "--------------------------------------------------" << endl;
 
 		return out;            
@@ -55,9 +55,29 @@ struct descr3d1d {
 	std::string IM_TYPEV;
 	//! Output directory
 	std::string OUTPUT;	
+	//! Path to the JSON-lines metrics file ("" = no metrics)
+	std::string METRICS_FILE;
 	// Solver information
 	//! Identifief of the monolithic solver
 	std::string SOLVE_METHOD;
+	//! Identifier of the network solver ("FEM" or reduced "GRAPH")
+	std::string NETWORK_SOLVER;
+	//! Identifier of the network preconditioner of GMRES ("SCHUR" or two-level "GRAPH")
+	std::string NETWORK_PRECOND;
+	//! Flag to distribute the tissue domain among the MPI processes (GMRES only)
+	bool DISTRIBUTED;
+	//! Nested iteration: coarsening factor of the tissue mesh of the coarse level (0 = off)
+	size_type NESTED_COARSENING;
+	//! Nested iteration: tissue mesh file of the coarse level (imported meshes)
+	std::string MESH_FILET_COARSE;
+	//! Output of the adjoint gradient after the solve ("TFR", "FRLYMPH" or "" = none)
+	std::string ADJOINT_OUTPUT;
+	//! Points file of the venous network sharing the tissue ("" = none)
+	std::string MESH_FILEV_VENOUS;
+	//! Number of threads of the setup task graph (1 = sequential)
+	size_type SETUP_THREADS;
+	//! Flag to compare a parallel setup with a sequential one (SETUP_THREADS > 1)
+	bool SETUP_CHECK;
 	//! Maximum number of iterations (iterative solvers)
 	size_type   MAXITER;
 	//! Mamimum residual (iterative solvers)
@@ -112,8 +132,48 @@ struct descr3d1d {
 			MAXITER  = FILE_.int_value("MAXITER", "Max number of sub-iterations");
 			RES = FILE_.real_value("RES"); if (RES == 0.) RES = 2.0e-10;
 		}
+		NETWORK_SOLVER = FILE_.string_value("NETWORK_SOLVER");
+		if (NETWORK_SOLVER == "") NETWORK_SOLVER = "FEM";
+		GMM_ASSERT1(NETWORK_SOLVER == "FEM" || NETWORK_SOLVER == "GRAPH",
+			"unknown NETWORK_SOLVER " << NETWORK_SOLVER << " (FEM or GRAPH)");
+		NETWORK_PRECOND = FILE_.string_value("NETWORK_PRECOND");
+		if (NETWORK_PRECOND == "") NETWORK_PRECOND = "SCHUR";
+		GMM_ASSERT1(NETWORK_PRECOND == "SCHUR" || NETWORK_PRECOND == "GRAPH",
+			"unknown NETWORK_PRECOND " << NETWORK_PRECOND << " (SCHUR or GRAPH)");
+		DISTRIBUTED = FILE_.int_value("DISTRIBUTED");
+		#ifndef WITH_MPI
+		GMM_ASSERT1(!DISTRIBUTED, "DISTRIBUTED = 1 needs the library compiled with WITH_MPI=1");
+		#endif
+		GMM_ASSERT1(!DISTRIBUTED || (SOLVE_METHOD == "GMRES" && NETWORK_SOLVER == "FEM"),
+			"DISTRIBUTED = 1 needs SOLVE_METHOD = 'GMRES' and NETWORK_SOLVER = 'FEM'");
+		long nested = FILE_.int_value("NESTED_COARSENING");
+		NESTED_COARSENING = nested > 1 ? size_type(nested) : 0;
+		MESH_FILET_COARSE = FILE_.string_value("MESH_FILET_COARSE");
+		GMM_ASSERT1(NESTED_COARSENING <= 1 || !DISTRIBUTED,
+			"NESTED_COARSENING needs DISTRIBUTED = 0");
+		ADJOINT_OUTPUT = FILE_.string_value("ADJOINT_OUTPUT");
+		GMM_ASSERT1(ADJOINT_OUTPUT == "" || ADJOINT_OUTPUT == "TFR" || ADJOINT_OUTPUT == "FRLYMPH",
+			"unknown ADJOINT_OUTPUT " << ADJOINT_OUTPUT << " (TFR, FRLYMPH or '')");
+		GMM_ASSERT1(ADJOINT_OUTPUT == "" || (!DISTRIBUTED && NETWORK_SOLVER == "FEM"),
+			"ADJOINT_OUTPUT needs DISTRIBUTED = 0 and NETWORK_SOLVER = 'FEM'");
+		long setup_threads = FILE_.int_value("SETUP_THREADS");
+		SETUP_THREADS = setup_threads > 1 ? size_type(setup_threads) : 1;
+		#if !defined(_OPENMP) || (!defined(GETFEM_HAVE_OPENMP) && !defined(GETFEM_HAS_OPENMP))
+		// The setup tasks are OpenMP tasks, and the descriptor tables of
+		// GetFEM are only thread safe in an OpenMP build
+		if (SETUP_THREADS > 1)
+			cerr << "SETUP_THREADS = " << SETUP_THREADS
+			     << " needs WITH_OPENMP and GetFEM built with OpenMP: sequential setup" << endl;
+		SETUP_THREADS = 1;
+		#endif
+		SETUP_CHECK = FILE_.int_value("SETUP_CHECK");
+		MESH_FILEV_VENOUS = FILE_.string_value("MESH_FILEV_VENOUS");
+		GMM_ASSERT1(MESH_FILEV_VENOUS == "" || (!DISTRIBUTED && NETWORK_SOLVER == "FEM"
+			&& ADJOINT_OUTPUT == ""),
+			"MESH_FILEV_VENOUS needs DISTRIBUTED = 0, NETWORK_SOLVER = 'FEM' and no ADJOINT_OUTPUT");
 		NInt = size_type(FILE_.int_value("NInt", "Node numbers on the circle for the nonlocal term"));  
 		OUTPUT = FILE_.string_value("OUTPUT","Output Directory");
+		METRICS_FILE = FILE_.string_value("METRICS_FILE");
 	}
 
 	//! Overloading of the output operator
@@ -132,6 +192,12 @@ struct descr3d1d {
 		cout << " FEM TYPE  1D velocity     : " << descr.FEM_TYPEV   << endl;
 		cout << " FEM TYPE  1D pressure     : " << descr.FEM_TYPEV_P << endl;
 		cout << " FEM TYPE  1D coefficients : " << descr.FEM_TYPEV_DATA << endl;
+		cout << " NETWORK SOLVER            : " << descr.NETWORK_SOLVER << endl;
+		cout << " DISTRIBUTED TISSUE        : " << descr.DISTRIBUTED << endl;
+		cout << " NESTED COARSENING         : " << descr.NESTED_COARSENING << endl;
+		cout << " ADJOINT OUTPUT            : " << descr.ADJOINT_OUTPUT << endl;
+		cout << " MESH FILE 1D venous       : " << descr.MESH_FILEV_VENOUS << endl;
+		cout << " SETUP THREADS             : " << descr.SETUP_THREADS << endl;
 		cout << "--------------------------------------------------" << endl;
 
 		return out;            
@@ -67,16 +67,16 @@ namespace getfem {
 	\ingroup geom
  */
 //! \note It also build vessel mesh regions (#=0 for branch 0, #=1 for branch 1, ...).
+//! \note The BC labels are the inlet conditions: outflow ends are labelled "OUT" 
+//! from the velocity by network_topology::label_boundary.
 template<typename VEC>
 void 
 import_pts_file_HT(
 		std::istream & ist, 
 		getfem::mesh & mh1D, 
 		std::vector<getfem::node> &  BCList,
-		VEC & Nn, vector_type & U,
-		const std::string & MESH_TYPE,
-		const mesh_im & mim_U,
-		const std::vector<getfem::mesh_fem> & mf_u
+		VEC & Nn,
+		const std::string & MESH_TYPE
 		) 
 {	
 	size_type N_bc=0;
@@ -105,15 +105,6 @@ import_pts_file_HT(
 		size_type bcintI = 0, bcintF = 0;
 		node BCA, BCB;
 
-			size_type fine_u=0;
-			scalar_type uvi=0;
-			vector_type dofu_enum; gmm::clear(dofu_enum);
-			for (getfem::mr_visitor mrv(mf_u[Nb-1].linked_mesh().region(Nb-1)); !mrv.finished(); ++mrv)
-				for (auto ub : mf_u[Nb-1].ind_basic_dof_of_element(mrv.cv()))
-					{dofu_enum.emplace_back(ub);
-				fine_u++;}
-			scalar_type first_u=dofu_enum[0];
-			scalar_type last_u=dofu_enum[fine_u-1];
 
 		// Read an arc from data file and write to lpoints
 		while (!thend) {
@@ -127,55 +118,19 @@ import_pts_file_HT(
 			else if (tmp.compare("BC") == 0) { 
 				bcflag++;
 				bgeot::get_token(ist, BCtype, 4);
-				if (BCtype.compare("DIR") == 0) {
+				if (BCtype.compare("DIR") == 0 || BCtype.compare("MIX") == 0) {
 					bgeot::get_token(ist, value, 1023);
-						N_bc++;
-					if (bcflag ==1)
-					uvi=U[(Nb-1)*mf_u[Nb-1].nb_dof()+first_u];
-					else
-					uvi=U[(Nb-1)*mf_u[Nb-1].nb_dof()+last_u];
-					if (bcflag == 1 && uvi >0) {
+					if (BCtype.compare("DIR") == 0) N_bc++;
+					if (bcflag == 1) {
 						BCA.label = BCtype; 
 						BCA.value = stof(value); 
 					}
-					else if (bcflag == 2 && uvi >0) {
-						BCB.label = "OUT"; 
-						BCB.value = stof(value);
-					}
-					else if (bcflag == 1 && uvi <0) {
-						BCA.label = "OUT"; 
-						BCA.value = stof(value);
-					}
-					else if (bcflag == 2 && uvi <0) {
+					else if (bcflag == 2) {
 						BCB.label = BCtype; 
 						BCB.value = stof(value);
 					}
 					else
 						GMM_ASSERT1(0, "More than 2 BC found on this arc!");
-						
-				}
-				else if (BCtype.compare("MIX") == 0) {
-					bgeot::get_token(ist, value, 1023);
-										if (bcflag ==1)
-					uvi=U[(Nb-1)*mf_u[Nb-1].nb_dof()+last_u];
-					else
-					uvi=U[(Nb-1)*mf_u[Nb-1].nb_dof()+first_u];
-					if (bcflag == 1 && uvi >0) {
-						BCA.label = BCtype; 
-						BCA.value = stof(value); 
-					}
-					else if (bcflag == 2 && uvi >0) {
-						BCB.label = "OUT"; 
-						BCB.value = stof(value);
-					}
-					else if (bcflag == 1 && uvi <0) {
-						BCA.label = "OUT"; 
-						BCA.value = stof(value);
-					}
-					else if (bcflag == 2 && uvi <0) {
-						BCB.label = BCtype; 
-						BCB.value = stof(value);
-					}
 				}
 				else if (BCtype.compare("INT") == 0) {
 					if (bcflag == 1) {
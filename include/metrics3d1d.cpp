@@ -0,0 +1,138 @@
+/* -*- c++ -*- (enables emacs c++ mode) */
+/*======================================================================
+    "Mixed Finite Element Methods for Coupled 3D/1D Fluid Problems"
+
+              Copyright (C) 2026 M3D1D contributors
+======================================================================*/
+/*!
+  @file   metrics3d1d.cpp
+  @author M3D1D contributors
+  @date   October 2026.
+  @brief  Definition of the machine-readable run log (JSON lines).
+ */
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <sys/resource.h>
+#include <metrics3d1d.hpp>
+
+namespace getfem {
+
+// Escape a string for JSON output
+static std::string
+json_escape(const std::string & s)
+{
+	std::string out;
+	for (char c : s) {
+		if (c == '"' || c == '\\') { out += '\\'; out += c; }
+		else if (c == '\n') out += "\\n";
+		else if (c == '\t') out += "\\t";
+		else out += c;
+	}
+	return out;
+}
+
+metrics_record::metrics_record(const std::string & type)
+{
+	fields_ << std::setprecision(std::numeric_limits<scalar_type>::digits10 + 1);
+	fields_ << "\"type\":\"" << json_escape(type) << "\"";
+}
+
+metrics_record &
+metrics_record::add(const std::string & key, scalar_type value)
+{
+	fields_ << ",\"" << json_escape(key) << "\":";
+	if (std::isfinite(value)) fields_ << value;
+	else fields_ << "null"; // NaN/Inf are not valid JSON
+	return *this;
+}
+
+metrics_record &
+metrics_record::add(const std::string & key, size_type value)
+{
+	fields_ << ",\"" << json_escape(key) << "\":" << value;
+	return *this;
+}
+
+metrics_record &
+metrics_record::add(const std::string & key, int value)
+{
+	fields_ << ",\"" << json_escape(key) << "\":" << value;
+	return *this;
+}
+
+metrics_record &
+metrics_record::add(const std::string & key, const std::string & value)
+{
+	fields_ << ",\"" << json_escape(key) << "\":\"" << json_escape(value) << "\"";
+	return *this;
+}
+
+metrics_record &
+metrics_record::add(const std::string & key, const char * value)
+{
+	return add(key, std::string(value));
+}
+
+std::string
+metrics_record::str(void) const
+{
+	return "{" + fields_.str() + "}";
+}
+
+
+void
+metrics3d1d::open(const std::string & fname)
+{
+	if (fname == "") return;
+	ofs_.open(fname, std::ios::trunc);
+	if (!ofs_.good()) {
+		cerr << "impossible to write metrics file " << fname << endl;
+		return;
+	}
+	start_ = wall_time();
+}
+
+void
+metrics3d1d::write(metrics_record & rec)
+{
+	if (!enabled()) return;
+	rec.add("t", wall_time() - start_);
+	rec.add("rss_peak_kb", peak_memory_kb());
+	ofs_ << rec.str() << std::endl; // flush: the stream is read while the run is going on
+}
+
+scalar_type
+metrics3d1d::phase(const std::string & name, scalar_type t0)
+{
+	scalar_type elapsed = wall_time() - t0;
+	if (enabled()) {
+		metrics_record rec("phase");
+		rec.add("name", name).add("wall_s", elapsed);
+		write(rec);
+	}
+	return elapsed;
+}
+
+scalar_type
+metrics3d1d::wall_time(void)
+{
+	return std::chrono::duration<scalar_type>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+size_type
+metrics3d1d::peak_memory_kb(void)
+{
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+	#ifdef __APPLE__
+	return size_type(usage.ru_maxrss) / 1024; // bytes on macOS
+	#else
+	return size_type(usage.ru_maxrss);        // kilobytes on Linux
+	#endif
+}
+
+} /* end of namespace */
@@ -0,0 +1,86 @@
+/* -*- c++ -*- (enables emacs c++ mode) */
+/*======================================================================
+    "Mixed Finite Element Methods for Coupled 3D/1D Fluid Problems"
+
+              Copyright (C) 2026 M3D1D contributors
+======================================================================*/
+/*!
+  @file   metrics3d1d.hpp
+  @author M3D1D contributors
+  @date   October 2026.
+  @brief  Declaration of the machine-readable run log (JSON lines).
+  @details
+	Each line of METRICS_FILE is a JSON object with a "type" field:
+	- "phase": wall time of a setup/assembly/solve/export phase,
+	- "iteration": outer fixed point iteration (residuals, flow rates, phase times).
+
+	Every record also holds the wall clock since the log was opened ("t")
+	and the memory high-water mark of the process in kB ("rss_peak_kb").
+ */
+#ifndef M3D1D_METRICS3D1D_HPP_
+#define M3D1D_METRICS3D1D_HPP_
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <getfem/getfem_mesh.h>
+#include <defines.hpp>
+
+namespace getfem {
+
+//! Class to build a single JSON record of the run log
+class metrics_record {
+
+public:
+	//! Constructor: set the record type
+	metrics_record(const std::string & type);
+	//! Add a real field
+	metrics_record & add(const std::string & key, scalar_type value);
+	//! Add an integer field
+	metrics_record & add(const std::string & key, size_type value);
+	//! Add an integer field
+	metrics_record & add(const std::string & key, int value);
+	//! Add a string field
+	metrics_record & add(const std::string & key, const std::string & value);
+	//! Add a string field
+	metrics_record & add(const std::string & key, const char * value);
+	//! Get the JSON object (single line)
+	std::string str(void) const;
+
+private:
+	std::ostringstream fields_;
+
+}; /* end of class */
+
+
+//! Class to write the JSON-lines metrics stream of a run
+class metrics3d1d {
+
+public:
+	metrics3d1d(void) : start_(0.0) {}
+
+	//! Open the stream (an empty name disables it)
+	void open(const std::string & fname);
+	//! Close the stream (every record is already flushed)
+	inline void close(void) { if (ofs_.is_open()) ofs_.close(); }
+	//! True if the stream is active
+	inline bool enabled(void) const { return ofs_.is_open(); }
+	//! Write a record (adds "t" and "rss_peak_kb")
+	void write(metrics_record & rec);
+	//! Write a "phase" record with the wall time elapsed since t0 (returns the elapsed time)
+	scalar_type phase(const std::string & name, scalar_type t0);
+
+	//! Wall clock time [s]
+	static scalar_type wall_time(void);
+	//! Memory high-water mark of the process [kB]
+	static size_type peak_memory_kb(void);
+
+private:
+	std::ofstream ofs_;
+	scalar_type start_;
+
+}; /* end of class */
+
+} /* end of namespace */
+
+#endif
@@ -0,0 +1,206 @@
+/* -*- c++ -*- (enables emacs c++ mode) */
+/*======================================================================
+    "Mixed Finite Element Methods for Coupled 3D/1D Fluid Problems"
+
+              Copyright (C) 2026 M3D1D contributors
+======================================================================*/
+/*!
+  @file   mpi3d1d.cpp
+  @author M3D1D contributors
+  @date   October 2026.
+  @brief  Definition of the distributed (MPI) tissue domain.
+ */
+
+#include <mpi3d1d.hpp>
+#include <algorithm>
+#ifdef WITH_MPI
+#include <mpi.h>
+#include <metis.h>
+#endif
+
+namespace getfem {
+
+int
+mpi_rank(void)
+{
+	int rank = 0;
+	#ifdef WITH_MPI
+	// Drivers without MPI_Init (sweep, transient) run as a single process
+	int initialized = 0;
+	MPI_Initialized(&initialized);
+	if (initialized) MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	#endif
+	return rank;
+}
+
+int
+mpi_size(void)
+{
+	int size = 1;
+	#ifdef WITH_MPI
+	// Drivers without MPI_Init (sweep, transient) run as a single process
+	int initialized = 0;
+	MPI_Initialized(&initialized);
+	if (initialized) MPI_Comm_size(MPI_COMM_WORLD, &size);
+	#endif
+	return size;
+}
+
+void
+mpi_sum(vector_type & v)
+{
+	#ifdef WITH_MPI
+	if (mpi_size() > 1 && v.size() > 0)
+		MPI_Allreduce(MPI_IN_PLACE, &v[0], int(v.size()), MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+	#endif
+}
+
+scalar_type
+mpi_max(scalar_type x)
+{
+	#ifdef WITH_MPI
+	if (mpi_size() > 1)
+		MPI_Allreduce(MPI_IN_PLACE, &x, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+	#endif
+	return x;
+}
+
+scalar_type
+mpi_sum(scalar_type x)
+{
+	#ifdef WITH_MPI
+	if (mpi_size() > 1)
+		MPI_Allreduce(MPI_IN_PLACE, &x, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+	#endif
+	return x;
+}
+
+size_type
+mpi_sum(size_type n)
+{
+	#ifdef WITH_MPI
+	if (mpi_size() > 1) {
+		unsigned long long m = n;
+		MPI_Allreduce(MPI_IN_PLACE, &m, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+		n = size_type(m);
+	}
+	#endif
+	return n;
+}
+
+size_type
+mpi_max(size_type n)
+{
+	#ifdef WITH_MPI
+	if (mpi_size() > 1) {
+		unsigned long long m = n;
+		MPI_Allreduce(MPI_IN_PLACE, &m, 1, MPI_UNSIGNED_LONG_LONG, MPI_MAX, MPI_COMM_WORLD);
+		n = size_type(m);
+	}
+	#endif
+	return n;
+}
+
+void
+tissue_partition::build(const mesh & mt, const mesh_fem & mf_u, const mesh_fem & mf_p,
+	size_type nb_dof_v)
+{
+	rank_ = mpi_rank();
+	nb_parts_ = size_type(mpi_size());
+	const size_type nu = mf_u.nb_dof(), np = mf_p.nb_dof();
+	ndof_ = nu + np + nb_dof_v;
+	owned_.clear(); local_bv_.clear(); local_.clear();
+	local_rg_ = mesh_region();
+
+	std::vector<size_type> cvs;
+	for (dal::bv_visitor cv(mt.convex_index()); !cv.finished(); ++cv)
+		cvs.push_back(cv);
+	std::vector<size_type> part(mt.convex_index().last_true()+1, 0);
+
+	#ifdef WITH_MPI
+	if (nb_parts_ > 1) {
+		// METIS partition of the dual graph (elements sharing a face),
+		// computed by the process 0 and broadcast
+		std::vector<idx_t> epart(cvs.size(), 0);
+		if (root()) {
+			std::vector<idx_t> pos(part.size(), 0);
+			for (size_type k = 0; k < cvs.size(); ++k) pos[cvs[k]] = idx_t(k);
+			std::vector<idx_t> xadj(1, 0), adjncy;
+			for (size_type k = 0; k < cvs.size(); ++k) {
+				for (short_type f = 0; f < mt.nb_faces_of_convex(cvs[k]); ++f) {
+					size_type nb = mt.neighbor_of_convex(cvs[k], f);
+					if (nb != size_type(-1)) adjncy.push_back(pos[nb]);
+				}
+				xadj.push_back(idx_t(adjncy.size()));
+			}
+			idx_t n = idx_t(cvs.size()), ncon = 1, nparts = idx_t(nb_parts_), objval;
+			idx_t options[METIS_NOPTIONS];
+			METIS_SetDefaultOptions(options);
+			int err = METIS_PartGraphKway(&n, &ncon, xadj.data(), adjncy.data(),
+				NULL, NULL, NULL, &nparts, NULL, NULL, options, &objval, epart.data());
+			GMM_ASSERT1(err == METIS_OK, "tissue partition: METIS failed (" << err << ")");
+		}
+		MPI_Bcast(epart.data(), int(epart.size()*sizeof(idx_t)), MPI_BYTE, 0, MPI_COMM_WORLD);
+		for (size_type k = 0; k < cvs.size(); ++k) part[cvs[k]] = size_type(epart[k]);
+	}
+	#endif
+
+	// Owner of a tissue dof: lowest part among the elements containing it
+	std::vector<size_type> owner(nu+np, nb_parts_);
+	for (size_type cv : cvs) {
+		for (size_type d : mf_u.ind_basic_dof_of_element(cv))
+			owner[d] = std::min(owner[d], part[cv]);
+		for (size_type d : mf_p.ind_basic_dof_of_element(cv))
+			owner[nu+d] = std::min(owner[nu+d], part[cv]);
+	}
+	for (size_type i = 0; i < nu+np; ++i)
+		if (owner[i] == size_type(rank_)) owned_.add(i);
+	// The network is owned by the process 0
+	if (root())
+		for (size_type i = nu+np; i < ndof_; ++i) owned_.add(i);
+
+	// Local elements: the elements with an owned dof (so that the owned rows are complete)
+	for (size_type cv : cvs) {
+		bool local = false;
+		for (size_type d : mf_u.ind_basic_dof_of_element(cv))
+			local = local || owner[d] == size_type(rank_);
+		for (size_type d : mf_p.ind_basic_dof_of_element(cv))
+			local = local || owner[nu+d] == size_type(rank_);
+		if (!local) continue;
+		local_rg_.add(cv);
+		for (size_type d : mf_u.ind_basic_dof_of_element(cv)) local_bv_.add(d);
+		for (size_type d : mf_p.ind_basic_dof_of_element(cv)) local_bv_.add(nu+d);
+	}
+	if (root())
+		for (size_type i = nu+np; i < ndof_; ++i) local_bv_.add(i);
+	for (dal::bv_visitor i(local_bv_); !i.finished(); ++i)
+		local_.push_back(i);
+}
+
+void
+tissue_partition::split_rows(sparse_matrix_type & M, sparse_matrix_type & H) const
+{
+	gmm::resize(H, gmm::mat_nrows(M), gmm::mat_ncols(M)); gmm::clear(H);
+	for (size_type i = 0; i < gmm::mat_nrows(M); ++i) {
+		if (owned_.is_in(i)) continue;
+		if (local_bv_.is_in(i))
+			gmm::copy(gmm::mat_row(M, i), gmm::mat_row(H, i));
+		gmm::clear(gmm::mat_row(M, i));
+	}
+}
+
+void
+tissue_partition::keep_owned(vector_type & v) const
+{
+	for (size_type i = 0; i < v.size(); ++i)
+		if (!owned_.is_in(i)) v[i] = 0.0;
+}
+
+void
+tissue_partition::keep_local_rows(sparse_matrix_type & M, size_type shift) const
+{
+	for (size_type i = 0; i < gmm::mat_nrows(M); ++i)
+		if (!local_bv_.is_in(shift + i)) gmm::clear(gmm::mat_row(M, i));
+}
+
+} /* end of namespace */
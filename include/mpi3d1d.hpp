@@ -0,0 +1,177 @@
+/* -*- c++ -*- (enables emacs c++ mode) */
+/*======================================================================
+    "Mixed Finite Element Methods for Coupled 3D/1D Fluid Problems"
+
+              Copyright (C) 2026 M3D1D contributors
+======================================================================*/
+/*!
+  @file   mpi3d1d.hpp
+  @author M3D1D contributors
+  @date   October 2026.
+  @brief  Declaration of the distributed (MPI) tissue domain.
+  @details
+	The tissue mesh is partitioned with METIS on its dual graph (one part
+	per process). Each row of the monolithic system is owned by exactly
+	one process:
+	- a tissue dof is owned by the lowest part among the elements
+	  containing it,
+	- the network dofs (small, replicated 1D problem) are owned by the
+	  process 0.
+
+	Each process assembles the tissue terms on its "local" elements
+	(owned elements plus one layer of overlap, i.e. the elements sharing
+	a dof with them), so that its owned rows are complete. The owned rows
+	form the local part of the matrix, the rows of the overlap dofs are
+	kept for the restricted additive Schwarz preconditioner. The product
+	by the monolithic matrix is the sum over the processes of the local
+	products; the vectors are replicated.
+
+	Only the matrix is distributed: every process holds the whole tissue
+	mesh, the FEMs, the vectors and the exchange aux matrices (Mbar,
+	Mlin). The exchange rows are restricted to the local tissue dofs and
+	the network rows are assembled by the process 0 only.
+
+	Without WITH_MPI, on a single process, or when MPI_Init was not called
+	(drivers other than the example main), everything is owned by the
+	process 0 and the sums are identities.
+
+	\ingroup geom
+ */
+#ifndef M3D1D_MPI3D1D_HPP_
+#define M3D1D_MPI3D1D_HPP_
+
+#include <getfem/getfem_mesh.h>
+#include <getfem/getfem_mesh_fem.h>
+#include <gmm/gmm.h>
+#include <defines.hpp>
+#include <gmm_fix.hpp>
+
+namespace getfem {
+
+//! Rank of the process (0 without MPI)
+int mpi_rank(void);
+//! Number of processes (1 without MPI)
+int mpi_size(void);
+//! Sum of v over the processes (in place)
+void mpi_sum(vector_type & v);
+//! Sum of x over the processes
+scalar_type mpi_sum(scalar_type x);
+//! Maximum of x over the processes
+scalar_type mpi_max(scalar_type x);
+//! Sum of n over the processes
+size_type mpi_sum(size_type n);
+//! Maximum of n over the processes
+size_type mpi_max(size_type n);
+
+//! Partition of the tissue domain among the processes
+class tissue_partition {
+
+public:
+
+	tissue_partition(void) : rank_(0), nb_parts_(1), ndof_(0) {}
+
+	//! Partition the tissue mesh and set the owned and local dofs
+	/*!
+		@param mt         The 3D mesh
+		@param mf_u       The finite element method for the tissue velocity
+		@param mf_p       The finite element method for the tissue pressure
+		@param nb_dof_v   Number of network dofs (after the tissue ones)
+
+		The monolithic numbering is [Ut, Pt, network].
+	 */
+	void build(const mesh & mt, const mesh_fem & mf_u, const mesh_fem & mf_p,
+		size_type nb_dof_v);
+
+	//! True on the process owning the network
+	inline bool root(void) const { return rank_ == 0; }
+	//! True if the domain is split among more processes
+	inline bool distributed(void) const { return nb_parts_ > 1; }
+	//! Number of parts
+	inline size_type nb_parts(void) const { return nb_parts_; }
+	//! Elements where the process assembles the tissue terms (owned + overlap)
+	inline const mesh_region & local_region(void) const { return local_rg_; }
+	//! True if the process owns the row i of the monolithic system
+	inline bool owned(size_type i) const { return owned_.is_in(i); }
+	//! Rows owned by the process
+	inline const dal::bit_vector & owned_dofs(void) const { return owned_; }
+	//! Rows of the local problem of the preconditioner (owned + overlap)
+	inline const vector_size_type & local_dofs(void) const { return local_; }
+
+	//! Split M in the owned rows (kept in M) and the overlap rows (moved to H)
+	/*!
+		The rows which are neither owned nor local are cleared.
+	 */
+	void split_rows(sparse_matrix_type & M, sparse_matrix_type & H) const;
+	//! Clear the entries of v which are not owned
+	void keep_owned(vector_type & v) const;
+	//! Clear the rows of M which are not local (row i of M is the row shift+i of the system)
+	void keep_local_rows(sparse_matrix_type & M, size_type shift) const;
+
+	//! Overloading of the output operator
+	friend std::ostream & operator << (
+		std::ostream & out, const tissue_partition & p
+		)
+	{
+		out << "---- TISSUE PARTITION ----------------------------" << endl;
+		out << " PARTS      : " << p.nb_parts_ << endl;
+		out << " OWNED DOFS : " << p.owned_.card() << " / " << p.ndof_ << endl;
+		out << " LOCAL DOFS : " << p.local_.size() << endl;
+		out << "--------------------------------------------------" << endl;
+		return out;
+	}
+
+private:
+
+	int rank_;
+	size_type nb_parts_;
+	//! Size of the monolithic system
+	size_type ndof_;
+	//! Owned and local elements (owned + one layer of overlap)
+	mesh_region local_rg_;
+	//! Owned rows
+	dal::bit_vector owned_;
+	//! Local rows (owned + overlap)
+	dal::bit_vector local_bv_;
+	//! Local rows, increasing
+	vector_size_type local_;
+};
+
+//! Monolithic operator distributed by rows: y = sum over the processes of A_p x
+class distributed_matrix {
+
+public:
+
+	distributed_matrix(const sparse_matrix_type & A) : A_(A) {}
+
+	size_type nrows(void) const { return gmm::mat_nrows(A_); }
+	size_type ncols(void) const { return gmm::mat_ncols(A_); }
+
+	template <class L2, class L3>
+	void mult(const L2 & src, L3 & dst) const
+	{
+		vector_type x(ncols()), y(nrows());
+		gmm::copy(src, x);
+		gmm::mult(A_, x, y);
+		mpi_sum(y);
+		gmm::copy(y, dst);
+	}
+
+private:
+	const sparse_matrix_type & A_;
+};
+
+} /* end of namespace */
+
+
+namespace gmm {
+	template <>
+	struct linalg_traits<getfem::distributed_matrix> {
+		using this_type = getfem::distributed_matrix;
+		using sub_orientation = owned_implementation;
+
+		static size_type nrows(const this_type &m) { return m.nrows(); }
+		static size_type ncols(const this_type &m) { return m.ncols(); }
+	};
+} // namespace gmm
+
+#endif
@@ -0,0 +1,138 @@
+/* -*- c++ -*- (enables emacs c++ mode) */
+/*======================================================================
+    "Mixed Finite Element Methods for Coupled 3D/1D Fluid Problems"
+
+              Copyright (C) 2026 M3D1D contributors
+======================================================================*/
+/*!
+  @file   network_graph.cpp
+  @author M3D1D contributors
+  @date   October 2026.
+  @brief  Definition of the reduced (resistance graph) model of the network.
+ */
+
+#include <network_graph.hpp>
+#include <map>
+
+namespace getfem {
+
+void
+network_graph::build(const mesh & meshv, size_type nb_branches,
+	const mesh_fem & mf_p, const std::vector<node> & BCv)
+{
+	// Nodes: first vertex of the first element and last vertex of the
+	// last element of each branch (import_pts_file order)
+	std::map<size_type, size_type> node_of_point;
+	start_.assign(nb_branches, 0);
+	end_.assign(nb_branches, 0);
+	std::vector<size_type> first_cv(nb_branches), last_cv(nb_branches);
+	for (size_type i = 0; i < nb_branches; ++i) {
+		bool first = true;
+		for (getfem::mr_visitor mrv(meshv.region(i)); !mrv.finished(); ++mrv) {
+			if (first) first_cv[i] = mrv.cv();
+			last_cv[i] = mrv.cv();
+			first = false;
+		}
+		GMM_ASSERT1(!first, "network graph: empty branch " << i);
+		size_type a = meshv.ind_points_of_convex(first_cv[i])[0];
+		size_type b = meshv.ind_points_of_convex(last_cv[i])[1];
+		for (size_type pt : {a, b})
+			if (!node_of_point.count(pt)) {
+				size_type nn = node_of_point.size();
+				node_of_point[pt] = nn;
+			}
+		start_[i] = node_of_point[a];
+		end_[i]   = node_of_point[b];
+	}
+	nb_nodes_ = node_of_point.size();
+
+	// Prolongation: linear in the arc length between the ends of the branch
+	gmm::resize(P_, mf_p.nb_dof(), nb_nodes_); gmm::clear(P_);
+	dal::bit_vector done;
+	for (size_type i = 0; i < nb_branches; ++i) {
+		scalar_type L = 0.0;
+		for (getfem::mr_visitor mrv(meshv.region(i)); !mrv.finished(); ++mrv)
+			L += gmm::vect_dist2(meshv.points_of_convex(mrv.cv())[0],
+				meshv.points_of_convex(mrv.cv())[1]);
+		scalar_type s0 = 0.0;
+		for (getfem::mr_visitor mrv(meshv.region(i)); !mrv.finished(); ++mrv) {
+			const base_node & x0 = meshv.points_of_convex(mrv.cv())[0];
+			for (auto d : mf_p.ind_basic_dof_of_element(mrv.cv())) {
+				if (done.is_in(d)) continue;
+				done.add(d);
+				scalar_type w = (s0 + gmm::vect_dist2(mf_p.point_of_basic_dof(d), x0))/L;
+				w = std::min(std::max(w, 0.0), 1.0);
+				if (start_[i] == end_[i]) w = 0.0; // closed loop
+				if (w < 1.0) P_(d, start_[i]) += 1.0 - w;
+				if (w > 0.0) P_(d, end_[i])   += w;
+			}
+			s0 += gmm::vect_dist2(x0, meshv.points_of_convex(mrv.cv())[1]);
+		}
+	}
+
+	// Boundary nodes (the labels and values are resolved at assembly)
+	bc_.clear();
+	for (const node & n : BCv) {
+		GMM_ASSERT1(node_of_point.count(n.idx),
+			"network graph: boundary node " << n.idx << " is not a branch end");
+		node bn(n);
+		bn.idx = node_of_point[n.idx];
+		// build_vessel_boundary changes the sign of the values at the outflow ends
+		size_type i = std::abs(n.branches[0]);
+		if (bn.idx == end_[i] && bn.idx != start_[i]) bn.value = -bn.value;
+		bc_.push_back(bn);
+	}
+}
+
+void
+network_graph::set_conductance(const vector_type & G)
+{
+	GMM_ASSERT1(G.size() == nb_branches(), "network graph: wrong number of conductances");
+	G_ = G;
+}
+
+void
+network_graph::add_laplacian(sparse_matrix_type & A) const
+{
+	for (size_type i = 0; i < nb_branches(); ++i) {
+		size_type a = start_[i], b = end_[i];
+		if (a == b) continue;
+		A(a, a) += G_[i]; A(b, b) += G_[i];
+		A(a, b) -= G_[i]; A(b, a) -= G_[i];
+	}
+}
+
+void
+network_graph::build_boundary(sparse_matrix_type & A, scalar_type p0)
+{
+	bnode_.clear(); bdir_.clear(); bval_.clear();
+	for (const node & n : bc_) {
+		if (n.label == "DIR") {
+			bnode_.push_back(n.idx); bdir_.push_back(true); bval_.push_back(n.value);
+		}
+		else if (n.label == "MIX") {
+			// Q = beta*(p-p0) leaves the network (dead ends have beta = 0)
+			scalar_type beta = std::abs(n.value);
+			A(n.idx, n.idx) += beta;
+			bnode_.push_back(n.idx); bdir_.push_back(false); bval_.push_back(beta*p0);
+		}
+	}
+	dirichlet_rows(A, 0);
+}
+
+void
+network_graph::factorize(void)
+{
+	gmm::csc_matrix<scalar_type> Ac;
+	gmm::copy(A_, Ac);
+	slu_.build_with(Ac);
+}
+
+void
+network_graph::solve(vector_type & x, const vector_type & b) const
+{
+	gmm::resize(x, nb_nodes_);
+	slu_.solve(x, b);
+}
+
+} /* end of namespace */
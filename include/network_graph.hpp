@@ -0,0 +1,179 @@
+/* -*- c++ -*- (enables emacs c++ mode) */
+/*======================================================================
+    "Mixed Finite Element Methods for Coupled 3D/1D Fluid Problems"
+
+              Copyright (C) 2026 M3D1D contributors
+======================================================================*/
+/*!
+  @file   network_graph.hpp
+  @author M3D1D contributors
+  @date   October 2026.
+  @brief  Declaration of the reduced (resistance graph) model of the network.
+  @details
+	The nodes of the graph are the ends of the branches (junctions and
+	boundary nodes), the edges are the branches. The flow rate of a
+	branch is @f$ Q_i = G_i\,(p_{start}-p_{end}) @f$, with the Poiseuille
+	conductance
+	@f[ G_i^{-1} = \int_{\Lambda_i} \frac{c_i}{(\pi R_i^2)^2}~ds, \qquad
+	    c_i = \frac{\pi^2 R_i^4}{\kappa_v}\,(1+C_i^2R_i^2) @f]
+	(the coefficient of the mass matrix @f$ M_{vv} @f$).
+
+	The vessel pressure is prolonged from the nodes to the pressure dofs
+	linearly in the arc length of each branch (matrix @f$ P @f$). The
+	exchange with the tissue is lumped on the nodes by the Galerkin
+	projection of the FEM exchange blocks, @f$ P^T B_{vv} P @f$ and
+	@f$ P^T B_{vt} @f$, so that the reduced operator is
+	@f[ A_r = L + P^T B_{vv} P @f]
+	where @f$ L @f$ is the weighted graph Laplacian. Mixed nodes add their
+	conductance @f$ \beta @f$ to the diagonal, Dirichlet nodes replace
+	their row with the identity.
+
+	\ingroup geom
+ */
+#ifndef M3D1D_NETWORK_GRAPH_HPP_
+#define M3D1D_NETWORK_GRAPH_HPP_
+
+#include <getfem/getfem_mesh.h>
+#include <getfem/getfem_mesh_fem.h>
+#include <gmm/gmm_superlu_interface.h>
+#include <defines.hpp>
+#include <node.hpp>
+
+namespace getfem {
+
+//! Reduced model of the network as a weighted graph (one unknown per branch end)
+class network_graph {
+
+public:
+
+	network_graph(void) : nb_nodes_(0) {}
+
+	//! Build the nodes and the prolongation from the nodes to the pressure dofs
+	/*!
+		@param meshv        The 1D mesh (region i = branch i)
+		@param nb_branches  Number of branches
+		@param mf_p         The finite element method for the vessel pressure
+		@param BCv          List of the boundary nodes (with the labels of build_vessel_boundary)
+	 */
+	void build(const mesh & meshv, size_type nb_branches,
+		const mesh_fem & mf_p, const std::vector<node> & BCv);
+
+	//! Set the conductance of each branch
+	void set_conductance(const vector_type & G);
+
+	//! Assemble the reduced operator @f$ A_r = L + P^T C P @f$ (and the boundary terms)
+	/*!
+		@param C   Pressure-pressure block of the FEM problem (@f$ B_{vv} @f$)
+		@param p0  External pressure of the mixed nodes
+	 */
+	template<typename MAT>
+	void assemble(const MAT & C, scalar_type p0 = 0.0)
+	{
+		GMM_ASSERT1(G_.size() == nb_branches(), "network graph: conductance not set");
+		sparse_matrix_type CP(gmm::mat_nrows(P_), nb_nodes_);
+		sparse_matrix_type Pt(nb_nodes_, gmm::mat_nrows(P_));
+		gmm::mult(C, P_, CP);
+		gmm::copy(gmm::transposed(P_), Pt);
+		gmm::resize(A_, nb_nodes_, nb_nodes_); gmm::clear(A_);
+		gmm::mult(Pt, CP, A_);
+		add_laplacian(A_);
+		build_boundary(A_, p0);
+	}
+
+	//! Factorize the reduced operator (to be called after assemble)
+	void factorize(void);
+
+	//! Reduced right hand side @f$ P^T F_p @f$ plus the boundary terms
+	template<typename VEC>
+	void restrict_rhs(const VEC & Fp, vector_type & Fr) const
+	{
+		gmm::resize(Fr, nb_nodes_);
+		gmm::mult(gmm::transposed(P_), Fp, Fr);
+		for (size_type k = 0; k < bnode_.size(); ++k)
+			Fr[bnode_[k]] = (bdir_[k] ? bval_[k] : Fr[bnode_[k]] + bval_[k]);
+	}
+	//! Homogeneous restriction @f$ P^T r @f$ (no boundary values, Dirichlet entries zeroed)
+	template<typename VEC>
+	void restrict_residual(const VEC & r, vector_type & rr) const
+	{
+		gmm::resize(rr, nb_nodes_);
+		gmm::mult(gmm::transposed(P_), r, rr);
+		for (size_type k = 0; k < bnode_.size(); ++k)
+			if (bdir_[k]) rr[bnode_[k]] = 0.0;
+	}
+	//! Prolongation @f$ p = P p_r @f$ of the node pressures to the pressure dofs
+	template<typename VEC>
+	void prolong(const vector_type & pr, VEC & p) const
+	{
+		gmm::mult(P_, pr, p);
+	}
+	//! Solve @f$ A_r x = b @f$ with the factorized operator
+	void solve(vector_type & x, const vector_type & b) const;
+
+	//! Flow rate of branch i (from its start to its end) for the node pressures pr
+	scalar_type flow_rate(size_type i, const vector_type & pr) const
+	{ return G_[i]*(pr[start_[i]] - pr[end_[i]]); }
+
+	//! Replace the rows of the Dirichlet nodes (shifted by shift) with the identity
+	template<typename MAT>
+	void dirichlet_rows(MAT & A, size_type shift) const
+	{
+		for (size_type k = 0; k < bnode_.size(); ++k)
+			if (bdir_[k]) {
+				size_type r = shift + bnode_[k];
+				gmm::clear(gmm::mat_row(A, r));
+				A(r, r) = 1.0;
+			}
+	}
+
+	//! Number of nodes (unknowns of the reduced model)
+	size_type nb_nodes(void) const { return nb_nodes_; }
+	//! Number of branches (edges)
+	size_type nb_branches(void) const { return start_.size(); }
+	//! Prolongation matrix (pressure dofs x nodes)
+	const sparse_matrix_type & P(void) const { return P_; }
+	//! Reduced operator
+	const sparse_matrix_type & A(void) const { return A_; }
+
+	//! Overloading of the output operator
+	friend std::ostream & operator << (
+		std::ostream & out, const network_graph & g
+		)
+	{
+		out << "---- NETWORK GRAPH -------------------------------" << endl;
+		out << " NODES     : " << g.nb_nodes_        << endl;
+		out << " BRANCHES  : " << g.nb_branches()    << endl;
+		out << " P DOFS    : " << gmm::mat_nrows(g.P_) << endl;
+		out << "--------------------------------------------------" << endl;
+		return out;
+	}
+
+private:
+
+	size_type nb_nodes_;
+	//! Start and end node of each branch
+	vector_size_type start_, end_;
+	//! Conductance of each branch
+	vector_type G_;
+	//! Prolongation from the nodes to the pressure dofs
+	sparse_matrix_type P_;
+	//! Reduced operator
+	sparse_matrix_type A_;
+	//! Boundary nodes: index, Dirichlet flag and value (pressure or beta*p0)
+	vector_size_type bnode_;
+	std::vector<bool> bdir_;
+	vector_type bval_;
+	//! Boundary data of build (label, value), resolved by build_boundary
+	std::vector<node> bc_;
+	//! Factorization of the reduced operator
+	gmm::SuperLU_factor<scalar_type> slu_;
+
+	//! Add the weighted graph Laplacian to A
+	void add_laplacian(sparse_matrix_type & A) const;
+	//! Add the mixed conductances to A and set the Dirichlet rows
+	void build_boundary(sparse_matrix_type & A, scalar_type p0);
+};
+
+} /* end of namespace */
+
+#endif
@@ -33,6 +33,7 @@
 #include <mesh1d.hpp>    // import_network_radius
 #include <utilities.hpp> // compute_radius
 #include <c_mesh1d.hpp> //rasm_curve_parameter 
+#include <cache3d1d.hpp> //cache of curvature and tangent versors
 
 namespace getfem {
 
@@ -136,7 +137,8 @@ struct param3d1d {
 	void build(ftool::md_param & fname, 
 			const getfem::mesh_fem & mf_datat,
 			const getfem::mesh_fem & mf_datav,
-			const vector<getfem::mesh_fem> & mf_datavi
+			const vector<getfem::mesh_fem> & mf_datavi,
+			const cache3d1d & cache = cache3d1d()
 			) 
 	{
 		FILE_ = fname;
@@ -257,7 +259,10 @@ struct param3d1d {
 				
 			}
 		} else {
-			rasm_curve_parameter(mf_datavi,Curv_,lambdax_,lambday_,lambdaz_);
+			if (!cache.load_curve(cache.GEOMETRY_KEY, Curv_, lambdax_, lambday_, lambdaz_)){
+				rasm_curve_parameter(mf_datavi,Curv_,lambdax_,lambday_,lambdaz_);
+				cache.save_curve(cache.GEOMETRY_KEY, Curv_, lambdax_, lambday_, lambdaz_);
+			}
 			for(size_type b=0;b<n_branch;++b) //GR
 			 gmm::scaled(Curv_[b],1.0/FILE_.real_value("d")); //GR FG//gmm::scaled(Curv_[b],1.0);
 		}
@@ -16,9 +16,17 @@
 #include <problem3d1d.hpp>
 #include <AMG_Interface.hpp>
 #include <cmath>
+#include <limits>
+#include <memory>
+#include <iomanip>
+#include <unistd.h>
+#include <sys/wait.h>
 #include "darcy_preconditioner.hpp"
  #include "darcy_preconditioner_vessel.hpp"
  #include "darcy_preconditioner_mon.hpp"
+ #include "darcy_preconditioner_graph.hpp"
+ #include "darcy_preconditioner_schwarz.hpp"
+ #include "darcy_preconditioner_av.hpp"
  #include "gmm/gmm_inoutput.h"
 // #include "darcy_preconditioner_mon_coup.hpp"
 // #include "darcy_preconditioner_tissue_coup.hpp"
@@ -91,17 +99,90 @@ problem3d1d::init(int argc, char *argv[])
 	PARAM.read_command_line(argc, argv);
 	//2. Import data (algorithm specifications, boundary conditions, ...)
 	import_data();
+	//3-7. Meshes, FEMs, parameters and boundary data, as a task graph:
+	// the two mesh imports (file parsing) run concurrently, the tasks that
+	// visit a region or enumerate the dofs are serial (see tasks3d1d.hpp)
+	task_graph setup;
 	//3. Import mesh for tissue (3D) and vessel network (1D)
-	build_mesh();
-        cout << "after mesh" << endl;
+	size_type mesh_t = setup.add("mesh_import_tissue",  [this]{ build_tissue_mesh(); });
+	size_type mesh_v = setup.add("mesh_import_network", [this]{ build_network_mesh(); });
 	//4. Set finite elements and integration methods
-	set_im_and_fem();
+	size_type fem_t = setup.add_serial("fem_setup_tissue",  [this]{ set_im_and_fem_tissue(); }, {mesh_t});
+	size_type fem_v = setup.add_serial("fem_setup_network", [this]{ set_im_and_fem_network(); }, {mesh_v});
+	//6. Build the list of tissue boundary data (adds the regions of mesht)
+	size_type bc_t = setup.add_serial("build_tissue_boundary", [this]{ build_tissue_boundary(); }, {fem_t});
+	size_type dofs = setup.add_serial("fem_dofs", [this]{ set_dof(); }, {fem_t, fem_v, bc_t});
 	//5. Build problem parameters
-	build_param();
-	//6. Build the list of tissue boundary data
-	build_tissue_boundary();
-	//7. Build the list of tissue boundary (and junction) data
-	build_vessel_boundary();
+	size_type par = setup.add_serial("build_param", [this]{ build_param(); }, {dofs});
+	//7. Build the list of vessel boundary (and junction) data (radii of param)
+	setup.add_serial("build_vessel_boundary", [this]{ build_vessel_boundary(); }, {par});
+	setup.run(descr.SETUP_THREADS);
+	if (mpi_rank() == 0) setup.print(cout);
+	setup.write(metrics);
+	if (descr.SETUP_CHECK && descr.SETUP_THREADS > 1)
+		check_setup(argc, argv);
+}
+
+void 
+problem3d1d::init_network_only(int argc, char *argv[], const problem3d1d & tissue)
+{
+	//1. Read the .param filename from standard input
+	PARAM.read_command_line(argc, argv);
+	//2. Import data (algorithm specifications, boundary conditions, ...)
+	import_data();
+	GMM_ASSERT1(!descr.DISTRIBUTED, "the network-only problem needs DISTRIBUTED = 0");
+	//3-7. As init(), the tissue is taken from the other problem
+	task_graph setup;
+	size_type fem_t = setup.add_serial("fem_setup_tissue", [this, &tissue]{ set_im_and_fem_tissue(tissue); });
+	size_type mesh_v = setup.add("mesh_import_network", [this]{ build_network_mesh(); });
+	size_type fem_v = setup.add_serial("fem_setup_network", [this]{ set_im_and_fem_network(); }, {mesh_v});
+	size_type dofs = setup.add_serial("fem_dofs", [this]{ set_dof(); }, {fem_t, fem_v});
+	size_type par = setup.add_serial("build_param", [this]{ build_param(); }, {dofs});
+	setup.add_serial("build_vessel_boundary", [this]{ build_vessel_boundary(); }, {par});
+	setup.run(descr.SETUP_THREADS);
+	if (mpi_rank() == 0) setup.print(cout);
+	setup.write(metrics);
+}
+
+//! True if the meshes a and b have the same regions (same faces of the same convexes)
+bool
+same_regions(const mesh & a, const mesh & b)
+{
+	if (a.regions_index().card() != b.regions_index().card()) return false;
+	for (dal::bv_visitor rg(a.regions_index()); !rg.finished(); ++rg) {
+		if (!b.has_region(rg)) return false;
+		vector< std::pair<size_type, short_type> > fa, fb;
+		for (mr_visitor v(a.region(rg)); !v.finished(); ++v) fa.emplace_back(v.cv(), v.f());
+		for (mr_visitor v(b.region(rg)); !v.finished(); ++v) fb.emplace_back(v.cv(), v.f());
+		std::sort(fa.begin(), fa.end());
+		std::sort(fb.begin(), fb.end());
+		if (fa != fb) return false;
+	}
+	return true;
+}
+
+void
+problem3d1d::check_setup(int argc, char *argv[])
+{
+	// Same problem set up sequentially, without cache and run log
+	std::vector<std::string> seq_args = {"-dSETUP_THREADS=1", "-dSETUP_CHECK=0",
+		"-dCACHE_DIR=''", "-dMETRICS_FILE=''"};
+	std::vector<char *> args(argv, argv + argc);
+	for (auto & a : seq_args) args.push_back(&a[0]);
+	problem3d1d seq;
+	seq.init(int(args.size()), args.data());
+	GMM_ASSERT1(dof.Ut() == seq.dof.Ut() && dof.Pt() == seq.dof.Pt()
+		&& dof.Uv() == seq.dof.Uv() && dof.Pv() == seq.dof.Pv()
+		&& dof.coeft() == seq.dof.coeft() && dof.coefv() == seq.dof.coefv(),
+		"parallel and sequential setups have different dof counts");
+	GMM_ASSERT1(mesht.nb_convex() == seq.mesht.nb_convex() && meshv.nb_convex() == seq.meshv.nb_convex()
+		&& same_regions(mesht, seq.mesht) && same_regions(meshv, seq.meshv),
+		"parallel and sequential setups have different mesh regions");
+	GMM_ASSERT1(BCt.size() == seq.BCt.size() && BCv.size() == seq.BCv.size()
+		&& Jv.size() == seq.Jv.size() && nb_branches == seq.nb_branches
+		&& nb_extrema == seq.nb_extrema && nb_junctions == seq.nb_junctions,
+		"parallel and sequential setups have different boundary data");
+	cout << "Setup check: the parallel and the sequential setups are the same" << endl;
 }
 
 void
@@ -111,6 +192,9 @@ problem3d1d::import_data(void)
 	cout << "Importing descriptors for tissue and vessel problems ..." << endl;
 	#endif
 	descr.import(PARAM);
+	cache.import(PARAM);
+	// Only the process 0 writes the run log
+	metrics.open(mpi_rank() == 0 ? descr.METRICS_FILE : "");
 	if(PARAM.int_value("IMPORT_CURVE"))
 		c_descr.import(PARAM);
 	#ifdef M3D1D_VERBOSE_
@@ -123,6 +207,13 @@ problem3d1d::import_data(void)
 
 void
 problem3d1d::build_mesh(void)
+{
+	build_tissue_mesh();
+	build_network_mesh();
+}
+
+void
+problem3d1d::build_tissue_mesh(void)
 {
 	bool test = 0;
 	test = PARAM.int_value("TEST_GEOMETRY");
@@ -143,7 +234,11 @@ problem3d1d::build_mesh(void)
 		cout << "mesht description: " << st << endl;
 		regular_mesh(mesht, st);
 	}
+}
 
+void
+problem3d1d::build_network_mesh(void)
+{
 	#ifdef M3D1D_VERBOSE_
 	cout << "Importing the 1D mesh for the vessel ... "   << endl;
 	#endif
@@ -178,26 +273,24 @@ problem3d1d::build_mesh(void)
 
 void
 problem3d1d::set_im_and_fem(void)
+{
+	set_im_and_fem_tissue();
+	set_im_and_fem_network();
+	set_dof();
+}
+
+void
+problem3d1d::set_im_and_fem_tissue(void)
 {
 	#ifdef M3D1D_VERBOSE_
-	cout << "Setting IMs for tissue and vessel problems ..." << endl;
+	cout << "Setting IMs and FEMs for the tissue problem ..." << endl;
 	#endif
 	pintegration_method pim_t = int_method_descriptor(descr.IM_TYPET);
-	pintegration_method pim_v = int_method_descriptor(descr.IM_TYPEV);
 	mimt.set_integration_method(mesht.convex_index(), pim_t);
-	mimv.set_integration_method(meshv.convex_index(), pim_v);
-	
-	#ifdef M3D1D_VERBOSE_
-	cout << "Setting FEMs for tissue and vessel problems ..." << endl;
-	#endif
 	bgeot::pgeometric_trans pgt_t = bgeot::geometric_trans_descriptor(descr.MESH_TYPET);
-	bgeot::pgeometric_trans pgt_v = bgeot::geometric_trans_descriptor(descr.MESH_TYPEV);
 	pfem pf_Ut = fem_descriptor(descr.FEM_TYPET);
 	pfem pf_Pt = fem_descriptor(descr.FEM_TYPET_P);
-	pfem pf_Uv = fem_descriptor(descr.FEM_TYPEV);
-	pfem pf_Pv = fem_descriptor(descr.FEM_TYPEV_P);
 	pfem pf_coeft = fem_descriptor(descr.FEM_TYPET_DATA);
-	pfem pf_coefv = fem_descriptor(descr.FEM_TYPEV_DATA);
 	DIMT = pgt_t->dim();	//DIMV = 1;
 	mf_Ut.set_qdim(bgeot::dim_type(DIMT)); 
 	
@@ -206,9 +299,39 @@ problem3d1d::set_im_and_fem(void)
 		"Intrinsic vectorial FEM used"); // RT0 IS INTRINSIC VECTORIAL!!!
 	mf_Pt.set_finite_element(mesht.convex_index(), pf_Pt);
 	mf_coeft.set_finite_element(mesht.convex_index(), pf_coeft); 
+}
+
+void
+problem3d1d::set_im_and_fem_tissue(const problem3d1d & tissue)
+{
+	#ifdef M3D1D_VERBOSE_
+	cout << "Copying the tissue mesh, IMs and FEMs of the other problem ..." << endl;
+	#endif
+	// The mesh (with its boundary regions) is cloned, not imported again,
+	// and every element gets the same IM and FEMs: the dofs are the same
+	mesht.copy_from(tissue.mesht);
+	DIMT = tissue.DIMT;
+	mf_Ut.set_qdim(bgeot::dim_type(DIMT));
+	for (dal::bv_visitor cv(mesht.convex_index()); !cv.finished(); ++cv) {
+		mimt.set_integration_method(cv, tissue.mimt.int_method_of_element(cv));
+		mf_Ut.set_finite_element(cv, tissue.mf_Ut.fem_of_element(cv));
+		mf_Pt.set_finite_element(cv, tissue.mf_Pt.fem_of_element(cv));
+		mf_coeft.set_finite_element(cv, tissue.mf_coeft.fem_of_element(cv));
+	}
+	BCt = tissue.BCt;
+}
+
+void
+problem3d1d::set_im_and_fem_network(void)
+{
 	#ifdef M3D1D_VERBOSE_
 	cout << "Setting IMs and FEMs for vessel branches ..." << endl;
 	#endif
+	pintegration_method pim_v = int_method_descriptor(descr.IM_TYPEV);
+	mimv.set_integration_method(meshv.convex_index(), pim_v);
+	pfem pf_Uv = fem_descriptor(descr.FEM_TYPEV);
+	pfem pf_Pv = fem_descriptor(descr.FEM_TYPEV_P);
+	pfem pf_coefv = fem_descriptor(descr.FEM_TYPEV_DATA);
 	mf_Uvi.reserve(nb_branches);
 	mf_coefvi.reserve(nb_branches);
 	for(size_type i=0; i<nb_branches; ++i){
@@ -224,7 +347,11 @@ problem3d1d::set_im_and_fem(void)
 	}
 	mf_Pv.set_finite_element(meshv.convex_index(), pf_Pv);
 	mf_coefv.set_finite_element(meshv.convex_index(), pf_coefv);
-	
+}
+
+void
+problem3d1d::set_dof(void)
+{
 	#ifdef M3D1D_VERBOSE_
 	cout << "Setting FEM dimensions for tissue and vessel problems ..." << endl;
 	#endif
@@ -240,7 +367,7 @@ problem3d1d::build_param(void)
 	#ifdef M3D1D_VERBOSE_
 	cout << "Building parameters for tissue and vessel problems ..." << endl;
 	#endif
-	param.build(PARAM, mf_coeft, mf_coefv,mf_coefvi);
+	param.build(PARAM, mf_coeft, mf_coefv, mf_coefvi, cache);
 	#ifdef M3D1D_VERBOSE_
 	cout << param ;
 	#endif
@@ -319,6 +446,11 @@ problem3d1d::build_vessel_boundary(void)
 	#endif
 try {
 
+	// Load the lists (and the regions) from the cache if available
+	std::uint64_t bkey = cache.boundary_key(param.R());
+	if (cache.load_boundary(bkey, meshv, nb_branches, BCv, Jv, nb_extrema, nb_junctions))
+		return;
+
 	dal::bit_vector junctions; // global idx of junctions vertices in meshv
 	dal::bit_vector extrema;   // global idx of extreme vertices in meshv
 
@@ -588,6 +720,7 @@ try {
 	cout << "---------------------------------------- "   << endl;
 	#endif
 
+	cache.save_boundary(bkey, meshv, nb_branches, BCv, Jv, nb_extrema, nb_junctions);
 } 
 GMM_STANDARD_CATCH_ERROR; // catches standard errors
 
@@ -597,10 +730,53 @@ GMM_STANDARD_CATCH_ERROR; // catches standard errors
 void
 problem3d1d::assembly(void)
 {	
+	//0 Partition the tissue among the processes
+	scalar_type t0 = metrics3d1d::wall_time();
+	if (descr.DISTRIBUTED) {
+		partition.build(mesht, mf_Ut, mf_Pt, dof.Uv()+dof.Pv());
+		metrics.phase("partition", t0);
+		if (partition.root()) cout << partition;
+	}
+	assembly_time = 0.0;
 	//1 Build the monolithic matrix AM
+	t0 = metrics3d1d::wall_time();
 	assembly_mat();
+	assembly_time += metrics.phase("assembly_mat", t0);
 	//2 Build the monolithic rhs FM
+	t0 = metrics3d1d::wall_time();
 	assembly_rhs();
+	assembly_time += metrics.phase("assembly_rhs", t0);
+	//3 Keep the owned rows on each process
+	if (descr.DISTRIBUTED) {
+		t0 = metrics3d1d::wall_time();
+		distribute_system();
+		assembly_time += metrics.phase("distribute_system", t0);
+	}
+}
+
+mesh_region
+problem3d1d::tissue_region(void) const
+{
+	if (descr.DISTRIBUTED) return partition.local_region();
+	return mesh_region::all_convexes();
+}
+
+void
+problem3d1d::distribute_system(void)
+{
+	// The owned rows are complete (the tissue terms are assembled on the
+	// local elements, the network and the exchange terms everywhere)
+	partition.split_rows(AM, AH);
+	partition.keep_owned(FM);
+	mpi_sum(FM);
+}
+
+void
+problem3d1d::assembly_network(void)
+{
+	GMM_ASSERT1(!descr.DISTRIBUTED, "the network-only assembly needs DISTRIBUTED = 0");
+	network_only = true;
+	assembly();
 }
 
 void
@@ -609,6 +785,51 @@ problem3d1d::assembly_fixpoint(void)
 assembly();
 }
 
+void
+problem3d1d::assembly_sweep(void)
+{
+	GMM_ASSERT1(!descr.DISTRIBUTED, "the parameter sweep needs DISTRIBUTED = 0");
+	GMM_ASSERT1(LINEAR_LYMPH(), "the parameter sweep needs LINEAR_LYMPHATIC_DRAINAGE = 1");
+	sweep.init(dof.tot());
+	sweep.enabled = true;
+	assembly();
+	sweep.enabled = false;
+
+	scalar_type t0 = metrics3d1d::wall_time();
+	// Lymphatic pressure term: the sink block times PL
+	vector_type Pl(dof.Pt(), PARAM.real_value("PL"));
+	gmm::mult(gmm::sub_matrix(sweep.Alf,
+			gmm::sub_interval(dof.Ut(), dof.Pt()),
+			gmm::sub_interval(dof.Ut(), dof.Pt())),
+		Pl, gmm::sub_vector(sweep.Flf, gmm::sub_interval(dof.Ut(), dof.Pt())));
+	// Inflow boundary term: the DIR nodes at an inflow extremum (face 1)
+	vector< node > BCin;
+	for (const node & n : BCv) {
+		if (n.label != "DIR") continue;
+		bool inflow = false;
+		for (mr_visitor v(meshv.region(n.rg)); !v.finished(); ++v)
+			inflow = inflow || (v.f() == 1);
+		if (inflow) BCin.push_back(n);
+	}
+	sparse_matrix_type Mvv(dof.Uv(), dof.Uv());
+	vector_type Fv(dof.Uv());
+	vector_type P0_vel(mf_coefv.nb_dof(), PARAM.real_value("P0"));
+	asm_network_bc(Mvv, Fv, mimv, mf_Uvi, mf_coefv, BCin, P0_vel, param.R());
+	gmm::copy(Fv, gmm::sub_vector(sweep.Fin, gmm::sub_interval(dof.Ut()+dof.Pt(), dof.Uv())));
+	// System and parameters of the .param values
+	gmm::resize(sweep.AM0, dof.tot(), dof.tot());
+	gmm::copy(AM, sweep.AM0);
+	sweep.FM0 = FM;
+	sweep.Q0 = param.Q_;
+	sweep.sigma0 = param.sigma_;
+	sweep.sigma_vec0 = param.sigma_vec_;
+	sweep.Q_LF0 = param.Q_LF_;
+	sweep.kt0 = param.kt_;
+	sweep.kv0 = param.kv_;
+	metrics.phase("asm_sweep", t0);
+	cout << "Parameter sweep: " << BCin.size() << " inflow DIR nodes" << endl;
+}
+
 void 
 problem3d1d::assembly_mat(void)
 {
@@ -618,6 +839,7 @@ problem3d1d::assembly_mat(void)
 	gmm::resize(AM, dof.tot(), dof.tot()); gmm::clear(AM);
 	gmm::resize(UM, dof.tot()); gmm::clear(UM);
 	gmm::resize(FM, dof.tot()); gmm::clear(FM);
+	factorized = false;
 	#ifdef M3D1D_VERBOSE_
 	cout << "Assembling the monolithic matrix AM ..." << endl;
 	#endif
@@ -642,43 +864,60 @@ problem3d1d::assembly_mat(void)
         // Mass matrix for lymphatic sink in the interstitium
         sparse_matrix_type Mlf(dof.Pt(), dof.Pt());
 	
-	#ifdef M3D1D_VERBOSE_
-	cout << "  Assembling Mtt and Dtt ..." << endl;
-	#endif
-	asm_tissue_darcy(Mtt, Dtt, mimt, mf_Ut, mf_Pt);
-        gmm::scale(Mtt, 1.0/param.kt(0)); // kt scalar
-	// Copy Mtt
-	gmm::add(Mtt, 
-			  gmm::sub_matrix(AM, 
-					gmm::sub_interval(0, dof.Ut()), 
-					gmm::sub_interval(0, dof.Ut()))); 
-	// Copy -Dtt^T
-	gmm::add(gmm::scaled(gmm::transposed(Dtt), -1.0),  
-			  gmm::sub_matrix(AM, 
+	scalar_type t0 = metrics3d1d::wall_time();
+	// The tissue blocks are shared with the other network (merge_and_solve)
+	if (!network_only){
+		#ifdef M3D1D_VERBOSE_
+		cout << "  Assembling Mtt and Dtt ..." << endl;
+		#endif
+		asm_tissue_darcy(Mtt, Dtt, mimt, mf_Ut, mf_Pt, tissue_region());
+		gmm::scale(Mtt, 1.0/param.kt(0)); // kt scalar
+		// Copy Mtt
+		gmm::add(Mtt, 
+				  gmm::sub_matrix(AM, 
+						gmm::sub_interval(0, dof.Ut()), 
+						gmm::sub_interval(0, dof.Ut()))); 
+		// Copy -Dtt^T
+		gmm::add(gmm::scaled(gmm::transposed(Dtt), -1.0),  
+				  gmm::sub_matrix(AM, 
+						gmm::sub_interval(0, dof.Ut()),
+						gmm::sub_interval(dof.Ut(), dof.Pt()))); 
+		// Copy Dtt
+		gmm::add(Dtt,
+				  gmm::sub_matrix(AM, 
+						gmm::sub_interval(dof.Ut(), dof.Pt()),
+						gmm::sub_interval(0, dof.Ut())));
+		// Tissue mass of the sweep decomposition (linear in 1/kt)
+		if (sweep.enabled)
+			gmm::add(Mtt,
+				gmm::sub_matrix(sweep.Akt,
 					gmm::sub_interval(0, dof.Ut()),
-					gmm::sub_interval(dof.Ut(), dof.Pt()))); 
-	// Copy Dtt
-	gmm::add(Dtt,
-			  gmm::sub_matrix(AM, 
+					gmm::sub_interval(0, dof.Ut())));
+		//L2
+		//cout << param.Q_LF(0) << endl;
+		scalar_type lf_coef=param.Q_LF(0);//scalar then uniform untill now
+		asm_tissue_lymph_sink(Mlf, mimt, mf_Pt, tissue_region());
+		gmm::scale(Mlf,lf_coef);
+		//Copy Mlf
+		gmm::add(Mlf,
+				  gmm::sub_matrix(AM,
+						gmm::sub_interval(dof.Ut(), dof.Pt()),
+						gmm::sub_interval(dof.Ut(), dof.Pt())));
+		if (sweep.enabled)
+			gmm::add(Mlf,
+				gmm::sub_matrix(sweep.Alf,
 					gmm::sub_interval(dof.Ut(), dof.Pt()),
-                    gmm::sub_interval(0, dof.Ut())));
-        //L2
-	//cout << param.Q_LF(0) << endl;
-        scalar_type lf_coef=param.Q_LF(0);//scalar then uniform untill now
-        asm_tissue_lymph_sink(Mlf, mimt, mf_Pt);
-        gmm::scale(Mlf,lf_coef);
-        //Copy Mlf
-        gmm::add(Mlf,
-                          gmm::sub_matrix(AM,
-                                        gmm::sub_interval(dof.Ut(), dof.Pt()),
-                                        gmm::sub_interval(dof.Ut(), dof.Pt())));
+					gmm::sub_interval(dof.Ut(), dof.Pt())));
+	}
+	metrics.phase("asm_tissue", t0);
     
 	#ifdef M3D1D_VERBOSE_
 	cout << "  Assembling Mvv and Dvv ..." << endl;
 	#endif
-	// Local matrices
+	t0 = metrics3d1d::wall_time();
+	// Local matrices (the network rows are owned by the process 0)
 	size_type shift = 0;
-	for(size_type i=0; i<nb_branches; ++i){
+	for(size_type i=0; i<nb_branches && network_rows(); ++i){
 
 		if(i>0) shift += mf_Uvi[i-1].nb_dof();
 // scalar_type Ri = param.Ri(i);
@@ -709,6 +948,12 @@ problem3d1d::assembly_mat(void)
 			gmm::sub_matrix(AM, 
 				gmm::sub_interval(dof.Ut()+dof.Pt()+shift, mf_Uvi[i].nb_dof()), 
 				gmm::sub_interval(dof.Ut()+dof.Pt()+shift, mf_Uvi[i].nb_dof()))); 
+		// Vessel mass of the sweep decomposition (linear in 1/kv)
+		if (sweep.enabled)
+			gmm::add(Mvvi,
+				gmm::sub_matrix(sweep.Akv,
+					gmm::sub_interval(dof.Ut()+dof.Pt()+shift, mf_Uvi[i].nb_dof()),
+					gmm::sub_interval(dof.Ut()+dof.Pt()+shift, mf_Uvi[i].nb_dof())));
 		gmm::add(gmm::scaled(gmm::transposed(Dvvi), -1.0),
 			gmm::sub_matrix(AM, 
 				gmm::sub_interval(dof.Ut()+dof.Pt()+shift,    mf_Uvi[i].nb_dof()),
@@ -721,8 +966,10 @@ problem3d1d::assembly_mat(void)
 		gmm::clear(Dvvi);
 		
 	} /* end of branches loop */
+	metrics.phase("asm_network", t0);
 	
-if (nb_junctions > 0){
+	t0 = metrics3d1d::wall_time();
+if (nb_junctions > 0 && network_rows()){
 	#ifdef M3D1D_VERBOSE_
 	cout << "  Assembling Jvv" << " ..." << endl;
 	#endif
@@ -743,17 +990,26 @@ if (nb_junctions > 0){
 			 gmm::sub_interval(dof.Ut()+dof.Pt()+dof.Uv(), dof.Pv()),
 			 gmm::sub_interval(dof.Ut()+dof.Pt(), dof.Uv())));
 }
+	metrics.phase("asm_junctions", t0);
 	#ifdef M3D1D_VERBOSE_
 	cout << "  Assembling aux exchange matrices Mbar and Mlin ..." << endl;
 	#endif
-	asm_exchange_aux_mat(Mbar, Mlin, 
-			mimv, mf_Pt, mf_Pv, param.R(), descr.NInt);
+	t0 = metrics3d1d::wall_time();
+	build_exchange_aux_mat(Mbar, Mlin);
+	metrics.phase("asm_exchange_aux_mat", t0);
 	#ifdef M3D1D_VERBOSE_
 	cout << "  Assembling exchange matrices ..." << endl;
 	#endif
+	t0 = metrics3d1d::wall_time();
 	bool NEWFORM = PARAM.int_value("NEW_FORMULATION");
 	asm_exchange_mat(Btt, Btv, Bvt, Bvv,
 			mimv, mf_Pv, mf_coefv, Mbar, Mlin, param.Q(), NEWFORM);
+	if (descr.DISTRIBUTED) {
+		// Only the local tissue rows, and the network rows on the process 0
+		partition.keep_local_rows(Btt, dof.Ut());
+		partition.keep_local_rows(Btv, dof.Ut());
+		if (!network_rows()) { gmm::clear(Bvt); gmm::clear(Bvv); }
+	}
 	// Copying Btt
 	gmm::add(Btt, 
 			  gmm::sub_matrix(AM, 
@@ -774,25 +1030,32 @@ if (nb_junctions > 0){
 			  gmm::sub_matrix(AM, 
 					gmm::sub_interval(dof.Ut()+dof.Pt()+dof.Uv(), dof.Pv()), 
 					gmm::sub_interval(dof.Ut()+dof.Pt()+dof.Uv(), dof.Pv()))); 
+	// Exchange blocks of the sweep decomposition (linear in Lp)
+	if (sweep.enabled) {
+		gmm::add(Btt,
+			gmm::sub_matrix(sweep.Aex,
+				gmm::sub_interval(dof.Ut(), dof.Pt()),
+				gmm::sub_interval(dof.Ut(), dof.Pt())));
+		gmm::add(gmm::scaled(Btv, -1),
+			gmm::sub_matrix(sweep.Aex,
+				gmm::sub_interval(dof.Ut(), dof.Pt()),
+				gmm::sub_interval(dof.Ut()+dof.Pt()+dof.Uv(), dof.Pv())));
+		gmm::add(gmm::scaled(Bvt, -1),
+			gmm::sub_matrix(sweep.Aex,
+				gmm::sub_interval(dof.Ut()+dof.Pt()+dof.Uv(), dof.Pv()),
+				gmm::sub_interval(dof.Ut(), dof.Pt())));
+		gmm::add(Bvv,
+			gmm::sub_matrix(sweep.Aex,
+				gmm::sub_interval(dof.Ut()+dof.Pt()+dof.Uv(), dof.Pv()),
+				gmm::sub_interval(dof.Ut()+dof.Pt()+dof.Uv(), dof.Pv())));
+	}
+	metrics.phase("asm_exchange_mat", t0);
 
         //adding oncotic
-	scalar_type Pi_t=param.pi_t();
-	scalar_type Pi_v=param.pi_v();
-	scalar_type sigma=param.sigma();;
-	scalar_type picoef=sigma*(Pi_v-Pi_t);
-        //add variable sigma
-        vector_type DeltaPi(dof.Pv(),picoef);
-        bool IMPORT_SIGMA = PARAM.int_value("IMPORT_SIGMA");
-        if(IMPORT_SIGMA) 
-            for(size_type i=0; i<nb_branches; ++i)
-            {   
-                std::cout<< "Branch "<< i << " has "<< mf_Pv.dof_on_region(i)<< " dofs and sigma " <<  param.sigma(mimv, i)<<std::endl;
-                for (int idof=0; idof < mf_Pv.dof_on_region(i).size() ;idof++)
-                {
-                    int glob_idx=mf_Pv.dof_on_region(i)[idof];
-                    DeltaPi[glob_idx] =  param.sigma(mimv, i) *(Pi_v-Pi_t); 
-                }
-            }
+        //add variable sigma (IMPORT_SIGMA)
+        vector_type DeltaPi;
+        vector_size_type DeltaPi_branch;
+        oncotic_jump(DeltaPi, DeltaPi_branch);
         // Coefficient  \pi^2*Ri'^4/\kappa_v *(1+Ci^2*Ri^2) //Adaptation to the curve model
         vector_type auxOSt(dof.Pt());
         vector_type auxOSv(dof.Pv());
@@ -801,6 +1064,10 @@ if (nb_junctions > 0){
         gmm::scale(auxOSt,-1);
         gmm::add(auxOSt,gmm::sub_vector(FM,gmm::sub_interval(dof.Ut(),dof.Pt())));
         gmm::add(auxOSv,gmm::sub_vector(FM,gmm::sub_interval(dof.Ut()+dof.Pt()+dof.Uv(),dof.Pv())));
+	if (sweep.enabled) {
+		gmm::add(auxOSt, gmm::sub_vector(sweep.Fonc, gmm::sub_interval(dof.Ut(), dof.Pt())));
+		gmm::add(auxOSv, gmm::sub_vector(sweep.Fonc, gmm::sub_interval(dof.Ut()+dof.Pt()+dof.Uv(), dof.Pv())));
+	}
 
 
 	// De-allocate memory
@@ -813,6 +1080,32 @@ if (nb_junctions > 0){
 
 }
 
+void
+problem3d1d::oncotic_jump(vector_type & DeltaPi, vector_size_type & branch)
+{
+	scalar_type dpi = param.pi_v() - param.pi_t();
+	bool IMPORT_SIGMA = PARAM.int_value("IMPORT_SIGMA");
+	DeltaPi.assign(dof.Pv(), param.sigma()*dpi);
+	branch.assign(dof.Pv(), 0);
+	for (size_type i = 0; i < nb_branches; ++i) {
+		scalar_type sigmai = IMPORT_SIGMA ? param.sigma(mimv, i) : param.sigma();
+		for (dal::bv_visitor j(mf_Pv.dof_on_region(i)); !j.finished(); ++j) {
+			DeltaPi[j] = sigmai*dpi;
+			branch[j] = i;
+		}
+	}
+}
+
+void
+problem3d1d::build_exchange_aux_mat(sparse_matrix_type & Mbar, sparse_matrix_type & Mlin)
+{
+	std::uint64_t key = cache.coupling_key(descr.NInt, param.R());
+	if (cache.load_exchange(key, Mbar, Mlin)) return;
+	asm_exchange_aux_mat(Mbar, Mlin, 
+			mimv, mf_Pt, mf_Pv, param.R(), descr.NInt);
+	cache.save_exchange(key, Mbar, Mlin);
+}
+
 void 
 problem3d1d::assembly_rhs(void)
 {
@@ -850,13 +1143,14 @@ problem3d1d::assembly_rhs(void)
 	}
 	
 	
-	if (PARAM.int_value("TEST_RHS")) { // non lo fa
+	// The tissue boundary terms are assembled by the other network (merge_and_solve)
+	if (!network_only && PARAM.int_value("TEST_RHS")) { // non lo fa
 		#ifdef M3D1D_VERBOSE_
 		cout << "  ... as the divergence of exact velocity ... " << endl;
 		#endif
 		assembly_tissue_test_rhs();
 	}
-	else {
+	else if (!network_only) {
 		sparse_matrix_type Mtt(dof.Ut(), dof.Ut());
 		asm_tissue_bc(Mtt, Ft, mimt, mf_Ut, mf_coeft, BCt, P0, beta);
 		gmm::add(Mtt, 
@@ -882,11 +1176,13 @@ problem3d1d::assembly_rhs(void)
 
         //lymph sink
         //L2
-        scalar_type lf_coef=param.Q_LF(0);//scalar then uniform untill now
-        asm_tissue_lymph_sink(Mlf, mimt, mf_Pt);
-        gmm::scale(Mlf,lf_coef);
-        gmm::mult(Mlf,Pl,Pl_aux); // multiplying by zero..
-        gmm::add(Pl_aux, gmm::sub_vector(FM, gmm::sub_interval(dof.Ut(),dof.Pt())));
+	if (!network_only){
+		scalar_type lf_coef=param.Q_LF(0);//scalar then uniform untill now
+		asm_tissue_lymph_sink(Mlf, mimt, mf_Pt, tissue_region());
+		gmm::scale(Mlf,lf_coef);
+		gmm::mult(Mlf,Pl,Pl_aux); // multiplying by zero..
+		gmm::add(Pl_aux, gmm::sub_vector(FM, gmm::sub_interval(dof.Ut(),dof.Pt())));
+	}
 
 	// De-allocate memory
         gmm::clear(Ft); gmm::clear(Fv); gmm::clear(Mvv); gmm::clear(Mlf); gmm::clear(Pl); gmm::clear(Pl_aux);
@@ -974,6 +1270,8 @@ problem3d1d::assembly_tissue_test_rhs(void)
 bool
 problem3d1d::solve(void)
 {
+	if (descr.NETWORK_SOLVER == "GRAPH")
+		return solve_graph();
 	#ifdef M3D1D_VERBOSE_
 	cout << "Solving the monolithic system ... " << endl;
 	#endif
@@ -984,12 +1282,16 @@ problem3d1d::solve(void)
 
 	//gmm::clear(AM); // to be postponed for preconditioner
 	double time = gmm::uclock_sec();
+	scalar_type t_solve = metrics3d1d::wall_time();
         const int dim_u_t = dof.Ut(),
                   dim_matrix_t = dof.Ut() + dof.Pt();
 	const int dim_uv = dof.Uv(),
                   dim_matrix_v = dof.Uv() + dof.Pv();
        int  dim_matrix = dof.Ut() + dof.Pt() + dof.Uv() + dof.Pv();
-	if ( descr.SOLVE_METHOD == "SuperLU" ) { // direct solver //
+	if ( descr.DISTRIBUTED ) { // distributed tissue, replicated network //
+		solve_distributed();
+	}
+	else if ( descr.SOLVE_METHOD == "SuperLU" ) { // direct solver //
 		#ifdef M3D1D_VERBOSE_ 
 		cout << "  Applying the SuperLU method ... " << endl;
 		#endif
@@ -1000,11 +1302,19 @@ problem3d1d::solve(void)
 			gmm::sub_interval(0 , dim_matrix)), A_csr);*/
 
                 double time2 = gmm::uclock_sec();
-		gmm::SuperLU_solve(gmm::sub_matrix(A,
-			gmm::sub_interval(0 , dim_matrix),
-			gmm::sub_interval(0 , dim_matrix)), gmm::sub_vector(UM,gmm::sub_interval(0,dim_matrix)), gmm::sub_vector(FM,gmm::sub_interval(0,dim_matrix)), cond);
+		// Factorization and solution are split to log them separately
+		scalar_type t0 = metrics3d1d::wall_time();
+		// (the factorization is kept for the adjoint solves)
+		SLU_AM.build_with(A);
+		factorized = true;
+		metrics.phase("factorization", t0);
+		t0 = metrics3d1d::wall_time();
+		SLU_AM.solve(UM, FM);
+		metrics.phase("solve", t0);
+		cond = SLU_AM.rcond();
+		inner_iterations = 0;
 		#ifdef M3D1D_VERBOSE_ 
-		cout << "  Condition number : " << cond << endl;
+		cout << "  Reciprocal condition number (rcond) : " << cond << endl;
 		cout << "-----ZZZZZ ----- ... time to solveLu : " << gmm::uclock_sec() - time2 << " seconds\n";
                 #endif
 	//	gmm::SuperLU_solve(gmm::sub_matrix(A,
@@ -1013,7 +1323,7 @@ problem3d1d::solve(void)
 	//		 gmm::sub_vector(FM,gmm::sub_interval(dim_matrix,dim_matrix_v)), cond);
 		
                 #ifdef M3D1D_VERBOSE_ 
-                cout << "  Condition number : " << cond << endl;
+                cout << "  Reciprocal condition number (rcond) : " << cond << endl;
 		#endif
 	}
 	else { // Iterative solver //
@@ -1082,7 +1392,13 @@ problem3d1d::solve(void)
                         cout << " starting precond" << endl;
                         //cout<< "k_t"<< param.kt(0)<<endl;
                         //   darcy_precond< gmm::csr_matrix<double>> precon(Mtt, mf_Pt, mimt); dim_matrix = dim_matrix_t;
-			darcy_precond_mon< gmm::csr_matrix<double>> precon(Mtt, mf_Pt, mimt, Mtv, mf_Pv, mimv);
+			// Vessel block and coarse network graph for NETWORK_PRECOND = 'GRAPH'
+			gmm::csr_matrix<double> Av;
+			if (descr.NETWORK_PRECOND == "GRAPH") {
+				build_graph();
+				gmm::copy(gmm::sub_matrix(AM, gmm::sub_interval(dof.Ut()+dof.Pt(), dof.Uv()+dof.Pv()),
+				                              gmm::sub_interval(dof.Ut()+dof.Pt(), dof.Uv()+dof.Pv())), Av);
+			}
                         // darcy_precond_mon_coup< gmm::csr_matrix<double>> precon(Mtt, mf_Pt, mimt, Mtt1,Qtv, Mtv, mf_Pv, mimv,Mtv1);
 
 
@@ -1097,11 +1413,22 @@ problem3d1d::solve(void)
                         double time3 = gmm::uclock_sec();
 
                 // precon
+		if (descr.NETWORK_PRECOND == "GRAPH") {
+			darcy_precond_graph< gmm::csr_matrix<double>> precon_g(Mtt, mf_Pt, mimt, Av, dof.Uv(), graph);
+	 	        gmm::gmres(gmm::sub_matrix(AM, gmm::sub_interval(0, dim_matrix),
+                                   gmm::sub_interval(0, dim_matrix)),    
+                                   solution,
+                                   rhs,
+                                   precon_g, restart, iter);
+		}
+		else {
+			darcy_precond_mon< gmm::csr_matrix<double>> precon(Mtt, mf_Pt, mimt, Mtv, mf_Pv, mimv);
 	 	        gmm::gmres(gmm::sub_matrix(AM, gmm::sub_interval(0, dim_matrix),
                                    gmm::sub_interval(0, dim_matrix)),    
                                    solution,
                                    rhs,
                                    precon, restart, iter);
+		}
 	        #ifdef M3D1D_VERBOSE_
                 cout << "-----ZZZZZ ----- ... time to solveGmres::gmm: " << gmm::uclock_sec() - time3 << " seconds\n";
 		#endif
@@ -1312,45 +1639,34 @@ problem3d1d::solve(void)
 			cout << "  ... converged in " << iter.get_iteration() << " iterations." << endl;
 		else if (iter.get_iteration() == descr.MAXITER)
 			cerr << "  ... reached the maximum number of iterations!" << endl;
+		inner_iterations = iter.get_iteration();
 
 	}
 	cout << "... time to solve : " << gmm::uclock_sec() - time << " seconds\n";
+	if (metrics.enabled()) {
+		metrics_record rec("phase");
+		rec.add("name", "monolithic_solve").add("method", descr.SOLVE_METHOD)
+		   .add("wall_s", metrics3d1d::wall_time() - t_solve)
+		   .add("inner_iterations", inner_iterations);
+		metrics.write(rec);
+	}
+
+	compute_flow_rates(UM, TFR, FRlymph, FRCube);
+        return true;
+}
 
+void
+problem3d1d::compute_flow_rates(const vector_type & U,
+	scalar_type & tfr, scalar_type & frlymph, scalar_type & frcube)
+{
 	#ifdef M3D1D_VERBOSE_
 	cout << "Compute the total flow rate ... " << endl;
 	#endif
-	// Aux vector
-	vector_type Uphi(dof.Pv()); 
-	// Extracting matrices Bvt, Bvv
-	sparse_matrix_type Bvt(dof.Pv(), dof.Pt());
-	sparse_matrix_type Bvv(dof.Pv(), dof.Pv());
-	gmm::copy(gmm::sub_matrix(A, 
-			gmm::sub_interval(dof.Ut()+dof.Pt()+dof.Uv()	, dof.Pv()),
-			gmm::sub_interval(dof.Ut(), dof.Pt())),
-				Bvt); 
-	gmm::copy(gmm::sub_matrix(A, 
-			gmm::sub_interval(dof.Ut()+dof.Pt()+dof.Uv(), dof.Pv()), 
-			gmm::sub_interval(dof.Ut()+dof.Pt()+dof.Uv(), dof.Pv())),
-				Bvv); 
-	// Extracting solutions Pt, Pv 
+	tfr = network_flow_rate(U);
+	// Extracting solution Pt
 	vector_type Pt(dof.Pt()); 
-	vector_type Pv(dof.Pv()); 
-	gmm::copy(gmm::sub_vector(UM, 
+	gmm::copy(gmm::sub_vector(U, 
 		gmm::sub_interval(dof.Ut(), dof.Pt())), Pt);
-	gmm::copy(gmm::sub_vector(UM, 
-		gmm::sub_interval(dof.Ut()+dof.Pt()+dof.Uv(), dof.Pv())), Pv);
-	// Computing Bvv*Pv - Bvt*Pt
-	gmm::mult(Bvt, Pt, Uphi);
-	gmm::mult_add(Bvv, Pv, Uphi);
-        //oncotic term
-	scalar_type Pi_t=param.pi_t();
-	scalar_type Pi_v=param.pi_v();
-	scalar_type sigma=param.sigma();
-	scalar_type picoef=sigma*(Pi_v-Pi_t);
-        vector_type DeltaPi(dof.Pv(),picoef);
-        gmm::scale(DeltaPi,-1);
-        gmm::mult_add(Bvv, DeltaPi, Uphi);
-	TFR = std::accumulate(Uphi.begin(), Uphi.end(), 0.0);
 
         //computing flowrate from the cube
         // Aux vector
@@ -1366,7 +1682,7 @@ problem3d1d::solve(void)
         gmm::mult(Mlf,Pt,Uphi2);
         gmm::add(Uphi2,Pl_aux,Uphi2);
         //computing flowrate of lymphatic system
-	FRlymph = std::accumulate(Uphi2.begin(), Uphi2.end(), 0.0);
+	frlymph = std::accumulate(Uphi2.begin(), Uphi2.end(), 0.0);
 
 
         //computing flowrate from the cube
@@ -1376,31 +1692,861 @@ problem3d1d::solve(void)
         assemU("g=data$1(#1);""V$1(#1)+=g(i).comp(vBase(#1).vBase(#1).Normal())(i,k,:,k,k);");
         assemU.push_mi(mimt);
         assemU.push_mf(mf_Ut);
-        assemU.push_data(gmm::sub_vector(UM,gmm::sub_interval(0,dof.Ut())));
+        assemU.push_data(gmm::sub_vector(U,gmm::sub_interval(0,dof.Ut())));
         assemU.push_vec(F_cube);
         for (size_type f=0; f < BCt.size(); ++f) {
             assemU.assembly(mf_Ut.linked_mesh().region(BCt[f].rg));
         }
-        FRCube = std::accumulate(F_cube.begin(), F_cube.end(), 0.0);
+        frcube = std::accumulate(F_cube.begin(), F_cube.end(), 0.0);
         //From divergence theorem FRcube = Dtt * Ut. (In this case not computed in this way to account for numeric errors)
         /*scalar_type FRCube2;
         vector_type aux3(dof.Pt());
         sparse_matrix_type Dtt (dof.Pt(), dof.Ut());
         gmm::copy(gmm::sub_matrix(AM,gmm::sub_interval(dof.Ut(), dof.Pt()), gmm::sub_interval(0, dof.Ut())),Dtt);
-        gmm::mult(Dtt,gmm::sub_vector(UM,gmm::sub_interval(0,dof.Ut())),aux3);
+        gmm::mult(Dtt,gmm::sub_vector(U,gmm::sub_interval(0,dof.Ut())),aux3);
         FRCube2 = std::accumulate(aux3.begin(), aux3.end(), 0.0);
         cout << "FRcube2 " << FRCube2 << endl;*/
 
 	// De-allocate memory
-	gmm::clear(Bvt); gmm::clear(Bvv);
-	gmm::clear(Pt);  gmm::clear(Pv);  
-        gmm::clear(Uphi); gmm::clear(Uphi2);
+	gmm::clear(Pt);
+        gmm::clear(Uphi2);
         gmm:: clear(Mlf); gmm::clear(Pl); gmm::clear(Pl_aux);
-        gmm::clear(DeltaPi); gmm::clear(F_cube);
+        gmm::clear(F_cube);
         //gmm::clear(Dtt); gmm::clear(aux3);
-        return true;
 }
 
+scalar_type
+problem3d1d::network_flow_rate(const vector_type & U)
+{
+	// Aux vector
+	vector_type Uphi(dof.Pv()); 
+	// Extracting matrices Bvt, Bvv
+	sparse_matrix_type Bvt(dof.Pv(), dof.Pt());
+	sparse_matrix_type Bvv(dof.Pv(), dof.Pv());
+	gmm::copy(gmm::sub_matrix(AM, 
+			gmm::sub_interval(dof.Ut()+dof.Pt()+dof.Uv()	, dof.Pv()),
+			gmm::sub_interval(dof.Ut(), dof.Pt())),
+				Bvt); 
+	gmm::copy(gmm::sub_matrix(AM, 
+			gmm::sub_interval(dof.Ut()+dof.Pt()+dof.Uv(), dof.Pv()), 
+			gmm::sub_interval(dof.Ut()+dof.Pt()+dof.Uv(), dof.Pv())),
+				Bvv); 
+	// Extracting solutions Pt, Pv 
+	vector_type Pt(dof.Pt()); 
+	vector_type Pv(dof.Pv()); 
+	gmm::copy(gmm::sub_vector(U, 
+		gmm::sub_interval(dof.Ut(), dof.Pt())), Pt);
+	gmm::copy(gmm::sub_vector(U, 
+		gmm::sub_interval(dof.Ut()+dof.Pt()+dof.Uv(), dof.Pv())), Pv);
+	// Computing Bvv*Pv - Bvt*Pt
+	gmm::mult(Bvt, Pt, Uphi);
+	gmm::mult_add(Bvv, Pv, Uphi);
+        //oncotic term
+	scalar_type Pi_t=param.pi_t();
+	scalar_type Pi_v=param.pi_v();
+	scalar_type sigma=param.sigma();
+	scalar_type picoef=sigma*(Pi_v-Pi_t);
+        vector_type DeltaPi(dof.Pv(),picoef);
+        gmm::scale(DeltaPi,-1);
+        gmm::mult_add(Bvv, DeltaPi, Uphi);
+	scalar_type tfr = std::accumulate(Uphi.begin(), Uphi.end(), 0.0);
+	// The network rows are on the process 0 only
+	if (descr.DISTRIBUTED) tfr = mpi_sum(tfr);
+	return tfr;
+}
+
+
+void
+problem3d1d::solve_multi_rhs(const std::vector<vector_type> & F,
+	std::vector<vector_type> & U, std::vector<flow_rates> & rates)
+{
+	GMM_ASSERT1(!descr.DISTRIBUTED && descr.NETWORK_SOLVER == "FEM",
+		"solve_multi_rhs needs DISTRIBUTED = 0 and NETWORK_SOLVER = 'FEM'");
+	const size_type ns = F.size();
+	for (size_type s = 0; s < ns; ++s)
+		GMM_ASSERT1(F[s].size() == dof.tot(), "solve_multi_rhs: wrong size of rhs " << s);
+	U.assign(ns, vector_type(dof.tot(), 0.0));
+	rates.assign(ns, flow_rates());
+	gmm::clean(AM, 1E-12);
+
+	scalar_type t0 = metrics3d1d::wall_time();
+	size_type iterations = 0;
+	if (descr.SOLVE_METHOD == "SuperLU") {
+		gmm::csc_matrix<scalar_type> A;
+		gmm::copy(AM, A);
+		gmm::SuperLU_factor<scalar_type> SLU;
+		SLU.build_with(A);
+		metrics.phase("factorization", t0);
+		t0 = metrics3d1d::wall_time();
+		for (size_type s = 0; s < ns; ++s)
+			SLU.solve(U[s], F[s]);
+	}
+	else {
+		gmm::csr_matrix<scalar_type> Mtt, Mvv;
+		gmm::copy(gmm::sub_matrix(AM, gmm::sub_interval(0, dof.Ut()),
+		                              gmm::sub_interval(0, dof.Ut())), Mtt);
+		gmm::copy(gmm::sub_matrix(AM, gmm::sub_interval(dof.Ut()+dof.Pt(), dof.Uv()),
+		                              gmm::sub_interval(dof.Ut()+dof.Pt(), dof.Uv())), Mvv);
+		darcy_precond_mon< gmm::csr_matrix<scalar_type>> precon(Mtt, mf_Pt, mimt, Mvv, mf_Pv, mimv);
+		metrics.phase("preconditioner", t0);
+		t0 = metrics3d1d::wall_time();
+		for (size_type s = 0; s < ns; ++s) {
+			gmm::iteration iter(descr.RES);
+			iter.set_maxiter(descr.MAXITER);
+			if (s > 0) gmm::copy(U[s-1], U[s]);
+			gmm::gmres(AM, U[s], F[s], precon, 50, iter);
+			if (!iter.converged())
+				cerr << "  ... scenario " << s << " reached the maximum number of iterations!" << endl;
+			iterations += iter.get_iteration();
+		}
+	}
+	scalar_type t_solve = metrics.phase("solve_multi_rhs", t0);
+	for (size_type s = 0; s < ns; ++s)
+		compute_flow_rates(U[s], rates[s].TFR, rates[s].FRlymph, rates[s].FRCube);
+	if (metrics.enabled()) {
+		metrics_record rec("multi_rhs");
+		rec.add("method", descr.SOLVE_METHOD).add("scenarios", ns)
+		   .add("wall_s", t_solve).add("inner_iterations", iterations);
+		metrics.write(rec);
+	}
+	cout << "... " << ns << " scenarios solved in " << t_solve << " seconds" << endl;
+}
+
+void
+problem3d1d::scenario_rhs(const vector<node> & BCt_s, const vector<node> & BCv_s,
+	vector_type & F)
+{
+	GMM_ASSERT1(!descr.DISTRIBUTED && !PARAM.int_value("TEST_RHS"),
+		"scenario_rhs needs DISTRIBUTED = 0 and TEST_RHS = 0");
+	GMM_ASSERT1(BCt_s.size() == BCt.size() && BCv_s.size() == BCv.size(),
+		"scenario: wrong number of boundary nodes");
+	// The boundary terms of the rhs are linear in the values: assemble
+	// them for the differences with respect to the current data
+	vector< node > dBCt(BCt), dBCv;
+	for (size_type f = 0; f < BCt.size(); ++f) {
+		GMM_ASSERT1(BCt_s[f].label == BCt[f].label && BCt_s[f].rg == BCt[f].rg,
+			"scenario: tissue face " << f << " differs from " << BCt[f]);
+		dBCt[f].value = BCt_s[f].value - BCt[f].value;
+	}
+	for (size_type bc = 0; bc < BCv.size(); ++bc) {
+		GMM_ASSERT1(BCv_s[bc].label == BCv[bc].label && BCv_s[bc].idx == BCv[bc].idx,
+			"scenario: network node " << bc << " differs from " << BCv[bc]);
+		if (BCv[bc].label == "MIX") {
+			GMM_ASSERT1(BCv_s[bc].value == BCv[bc].value,
+				"scenario: the MIX coefficients enter AM, node " << BCv[bc]);
+			continue;
+		}
+		if (BCv[bc].label != "DIR") continue;
+		dBCv.push_back(BCv[bc]);
+		dBCv.back().value = BCv_s[bc].value - BCv[bc].value;
+	}
+
+	F = FM;
+	// Tissue
+	vector_type beta(2*DIMT, 1.0);
+	vector<string> beta_values = split(PARAM.string_value("BCbeta"), ' ');
+	for (unsigned f=0; f<2*DIMT; ++f)
+		beta[f] = std::stof(beta_values[f]);
+	vector_type P0(dof.coeft(), 0.0);
+	vector_type Ft(dof.Ut());
+	sparse_matrix_type Mtt(dof.Ut(), dof.Ut());
+	asm_tissue_bc(Mtt, Ft, mimt, mf_Ut, mf_coeft, dBCt, P0, beta);
+	gmm::add(Ft, gmm::sub_vector(F, gmm::sub_interval(0, dof.Ut())));
+	// Network
+	vector_type Fv(dof.Uv());
+	vector_type P0_vel(mf_coefv.nb_dof(), 0.0);
+	sparse_matrix_type Mvv(dof.Uv(), dof.Uv());
+	asm_network_bc(Mvv, Fv, mimv, mf_Uvi, mf_coefv, dBCv, P0_vel, param.R());
+	gmm::add(Fv, gmm::sub_vector(F, gmm::sub_interval(dof.Ut()+dof.Pt(), dof.Uv())));
+}
+
+void
+problem3d1d::adjoint_gradient(const std::string & output, branch_gradient & grad)
+{
+	GMM_ASSERT1(output == "TFR" || output == "FRLYMPH",
+		"unknown adjoint output " << output << " (TFR or FRLYMPH)");
+	const gmm::sub_interval Ipt(dof.Ut(), dof.Pt());
+	const gmm::sub_interval Ipv(dof.Ut()+dof.Pt()+dof.Uv(), dof.Pv());
+	vector_type dJdU(dof.tot(), 0.0);
+	if (output == "TFR") {
+		// TFR = 1^T (Bvv Pv - Bvt Pt - Bvv DeltaPi): columns sums of the
+		// network pressure rows of AM
+		vector_type ones(dof.Pv(), 1.0);
+		gmm::mult(gmm::transposed(gmm::sub_matrix(AM, Ipv, Ipt)), ones,
+			gmm::sub_vector(dJdU, Ipt));
+		gmm::mult(gmm::transposed(gmm::sub_matrix(AM, Ipv, Ipv)), ones,
+			gmm::sub_vector(dJdU, Ipv));
+	}
+	else {
+		// FRlymph = 1^T Mlf (Pt - PL)
+		sparse_matrix_type Mlf(dof.Pt(), dof.Pt());
+		asm_tissue_lymph_sink(Mlf, mimt, mf_Pt);
+		gmm::scale(Mlf, param.Q_LF(0));
+		vector_type ones(dof.Pt(), 1.0);
+		gmm::mult(gmm::transposed(Mlf), ones, gmm::sub_vector(dJdU, Ipt));
+	}
+	adjoint_branch_gradient(dJdU, output == "TFR", grad);
+	grad.J = (output == "TFR") ? TFR : FRlymph;
+}
+
+void
+problem3d1d::adjoint_gradient(const vector_type & w, branch_gradient & grad)
+{
+	GMM_ASSERT1(w.size() == dof.tot(), "adjoint_gradient: wrong size of the weight");
+	adjoint_branch_gradient(w, false, grad);
+	grad.J = gmm::vect_sp(w, UM);
+}
+
+void
+problem3d1d::adjoint_branch_gradient(const vector_type & dJdU, bool tfr, branch_gradient & grad)
+{
+	GMM_ASSERT1(!descr.DISTRIBUTED && descr.NETWORK_SOLVER == "FEM",
+		"the adjoint gradient needs DISTRIBUTED = 0 and NETWORK_SOLVER = 'FEM'");
+	GMM_ASSERT1(LINEAR_LYMPH(), "the adjoint gradient needs LINEAR_LYMPHATIC_DRAINAGE = 1");
+	GMM_ASSERT1(UM.size() == dof.tot(), "adjoint_gradient: call solve first");
+	const gmm::sub_interval Ipt(dof.Ut(), dof.Pt());
+	const gmm::sub_interval Ipv(dof.Ut()+dof.Pt()+dof.Uv(), dof.Pv());
+
+	// Adjoint problem AM^T lambda = dJ/dUM
+	scalar_type t0 = metrics3d1d::wall_time();
+	vector_type lambda(dof.tot());
+	size_type iterations = 0;
+	if (descr.SOLVE_METHOD == "SuperLU") {
+		if (!factorized) {
+			gmm::csc_matrix<scalar_type> A;
+			gmm::clean(AM, 1E-12);
+			gmm::copy(AM, A);
+			SLU_AM.build_with(A);
+			factorized = true;
+		}
+		SLU_AM.solve(lambda, dJdU, gmm::SuperLU_factor<scalar_type>::LU_TRANSP);
+	}
+	else {
+		gmm::csr_matrix<scalar_type> Mtt, Mvv;
+		gmm::copy(gmm::sub_matrix(AM, gmm::sub_interval(0, dof.Ut()),
+		                              gmm::sub_interval(0, dof.Ut())), Mtt);
+		gmm::copy(gmm::sub_matrix(AM, gmm::sub_interval(dof.Ut()+dof.Pt(), dof.Uv()),
+		                              gmm::sub_interval(dof.Ut()+dof.Pt(), dof.Uv())), Mvv);
+		darcy_precond_mon< gmm::csr_matrix<scalar_type>> precon(Mtt, mf_Pt, mimt, Mvv, mf_Pv, mimv);
+		gmm::iteration iter(descr.RES);
+		iter.set_maxiter(descr.MAXITER);
+		gmm::gmres(gmm::transposed(AM), lambda, dJdU, precon, 50, iter);
+		if (!iter.converged())
+			cerr << "  ... the adjoint solve reached the maximum number of iterations!" << endl;
+		iterations = iter.get_iteration();
+	}
+	scalar_type t_adj = metrics.phase("adjoint_solve", t0);
+
+	// dJ/df_i = dJ/df_i (explicit) + lambda^T (dFM/df_i - dAM/df_i UM)
+	t0 = metrics3d1d::wall_time();
+	grad.Lp.assign(nb_branches, 0.0);
+	grad.sigma.assign(nb_branches, 0.0);
+	grad.kv.assign(nb_branches, 0.0);
+
+	// Exchange: with W = Mbar (NEW_FORMULATION) or Mlin the exchange blocks
+	// are [W^T Bvv Mbar, -W^T Bvv; -Bvv Mbar, Bvv] and the oncotic rhs is
+	// [-W^T Bvv DeltaPi; Bvv DeltaPi], with Bvv linear in Q on each element:
+	//   lambda^T (dFM - dAM UM) = m^T dBvv (DeltaPi - d)
+	// with m = lambda_v - W lambda_t and d = Pv - Mbar Pt. The explicit
+	// dependence of TFR = 1^T Bvv (d - DeltaPi) shifts m by -1.
+	sparse_matrix_type Mbar(dof.Pv(), dof.Pt()), Mlin(dof.Pv(), dof.Pt());
+	build_exchange_aux_mat(Mbar, Mlin);
+	const sparse_matrix_type & W = PARAM.int_value("NEW_FORMULATION") ? Mbar : Mlin;
+	vector_type m(dof.Pv()), e(dof.Pv()), DeltaPi;
+	vector_size_type branch;
+	oncotic_jump(DeltaPi, branch);
+	gmm::mult(W, gmm::scaled(gmm::sub_vector(lambda, Ipt), -1.0), gmm::sub_vector(lambda, Ipv), m);
+	if (tfr) for (scalar_type & mi : m) mi -= 1.0;
+	gmm::mult(Mbar, gmm::sub_vector(UM, Ipt), gmm::scaled(gmm::sub_vector(UM, Ipv), -1.0), e);
+	gmm::add(DeltaPi, e); // e = DeltaPi - d
+	// Lp: integral of Q m e on the elements of each branch
+	mesh_fem mf_P0(meshv);
+	mf_P0.set_classical_finite_element(0);
+	vector_type Ve(mf_P0.nb_dof());
+	generic_assembly
+	assem("m=data$1(#1); e=data$2(#1); q=data$3(#2);"
+	      "V$1(#3)+=comp(Base(#1).Base(#1).Base(#2).Base(#3))(i,j,k,:).m(i).e(j).q(k);");
+	assem.push_mi(mimv);
+	assem.push_mf(mf_Pv);
+	assem.push_mf(mf_coefv);
+	assem.push_mf(mf_P0);
+	assem.push_data(m);
+	assem.push_data(e);
+	assem.push_data(param.Q());
+	assem.push_vec(Ve);
+	assem.assembly();
+	for (size_type i = 0; i < nb_branches; ++i)
+		for (mr_visitor v(meshv.region(i)); !v.finished(); ++v)
+			grad.Lp[i] += Ve[mf_P0.ind_basic_dof_of_element(v.cv())[0]];
+	// sigma: m^T Bvv DeltaPi restricted to the dofs of each branch
+	vector_type z(dof.Pv());
+	gmm::mult(gmm::sub_matrix(AM, Ipv, Ipv), m, z);
+	for (size_type j = 0; j < dof.Pv(); ++j)
+		grad.sigma[branch[j]] += z[j]*DeltaPi[j];
+	// kv: the Poiseuille mass matrix of the branch is linear in 1/kv
+	size_type shift = dof.Ut()+dof.Pt();
+	for (size_type i = 0; i < nb_branches; ++i) {
+		if (i > 0) shift += mf_Uvi[i-1].nb_dof();
+		scalar_type Ri = param.R(mimv, i);
+		scalar_type kvi = param.kv(mimv, i);
+		vector_type ci(mf_coefvi[i].nb_dof());
+		for (size_type j = 0; j < mf_coefvi[i].nb_dof(); ++j)
+			ci[j] = pi*pi*Ri*Ri*Ri*Ri/kvi*(1.0+param.Curv(i,j)*param.Curv(i,j)*Ri*Ri);
+		sparse_matrix_type Mvvi(mf_Uvi[i].nb_dof(), mf_Uvi[i].nb_dof());
+		getfem::asm_mass_matrix_param(Mvvi, mimv, mf_Uvi[i], mf_coefvi[i], ci, meshv.region(i));
+		vector_type Mu(mf_Uvi[i].nb_dof());
+		gmm::sub_interval Ii(shift, mf_Uvi[i].nb_dof());
+		gmm::mult(Mvvi, gmm::sub_vector(UM, Ii), Mu);
+		grad.kv[i] = gmm::vect_sp(gmm::sub_vector(lambda, Ii), Mu);
+	}
+	scalar_type t_grad = metrics.phase("adjoint_gradient", t0);
+
+	if (metrics.enabled()) {
+		metrics_record rec("adjoint");
+		rec.add("method", descr.SOLVE_METHOD).add("branches", nb_branches)
+		   .add("t_adjoint", t_adj).add("t_gradient", t_grad)
+		   .add("inner_iterations", iterations);
+		metrics.write(rec);
+	}
+	cout << "... adjoint gradient on " << nb_branches << " branches in "
+		 << t_adj + t_grad << " seconds" << endl;
+}
+
+void
+problem3d1d::export_gradient(const branch_gradient & grad, const std::string & name)
+{
+	std::ofstream ofs(descr.OUTPUT + "adjoint_gradient_" + name + ".txt");
+	GMM_ASSERT1(ofs.good(), "impossible to write the adjoint gradient in " << descr.OUTPUT);
+	ofs << "% " << name << " = " << std::setprecision(10) << grad.J << endl;
+	ofs << "% Derivatives with respect to the factors on the coefficients of each branch" << endl;
+	ofs << "% BRANCH DJ_DLP DJ_DSIGMA DJ_DKV" << endl;
+	for (size_type i = 0; i < grad.Lp.size(); ++i)
+		ofs << i << " " << grad.Lp[i] << " " << grad.sigma[i] << " " << grad.kv[i] << endl;
+}
+
+void
+problem3d1d::solve_distributed(void)
+{
+	#ifdef M3D1D_VERBOSE_
+	cout << "Solving the distributed monolithic system ... " << endl;
+	#endif
+	gmm::iteration iter(descr.RES);
+	iter.set_noisy(partition.root() ? 1 : 0);
+	iter.set_maxiter(descr.MAXITER);
+	size_type restart = 50;
+
+	scalar_type t0 = metrics3d1d::wall_time();
+	darcy_precond_schwarz<sparse_matrix_type> precon(AM, AH, partition);
+	scalar_type t_setup = metrics.phase("schwarz_setup", t0);
+
+	t0 = metrics3d1d::wall_time();
+	distributed_matrix A(AM);
+	gmm::clear(UM);
+	gmm::gmres(A, UM, FM, precon, restart, iter);
+	scalar_type t_solve = metrics.phase("solve", t0);
+	inner_iterations = iter.get_iteration();
+
+	// Scaling report: slowest process and largest local problem.
+	// Strong scaling: same mesh, increasing number of processes;
+	// weak scaling: number of tissue elements proportional to the processes.
+	size_type nnz_loc = gmm::nnz(AM), nloc = precon.nb_local();
+	size_type nnz_tot = mpi_sum(nnz_loc), nnz_max = mpi_max(nnz_loc), nloc_max = mpi_max(nloc);
+	scalar_type t_asm = mpi_max(assembly_time);
+	t_setup = mpi_max(t_setup); t_solve = mpi_max(t_solve);
+	scalar_type mem_max = mpi_max(scalar_type(metrics3d1d::peak_memory_kb()));
+	if (partition.root()) {
+		cout << "---- SCALING REPORT ------------------------------" << endl;
+		cout << " PROCESSES              : " << partition.nb_parts() << endl;
+		cout << " DOFS (total/max local) : " << dof.tot() << " / " << nloc_max << endl;
+		cout << " NNZ  (total/max local) : " << nnz_tot << " / " << nnz_max << endl;
+		cout << " ASSEMBLY TIME (max)    : " << t_asm << " s" << endl;
+		cout << " SCHWARZ SETUP (max)    : " << t_setup << " s" << endl;
+		cout << " GMRES SOLVE   (max)    : " << t_solve << " s" << endl;
+		cout << " GMRES ITERATIONS       : " << inner_iterations << endl;
+		cout << " PEAK MEMORY (max, kB)  : " << mem_max << endl;
+		cout << "--------------------------------------------------" << endl;
+	}
+	if (metrics.enabled()) {
+		metrics_record rec("scaling");
+		rec.add("processes", partition.nb_parts()).add("dofs", dof.tot())
+		   .add("local_dofs_max", nloc_max).add("nnz", nnz_tot).add("nnz_local_max", nnz_max)
+		   .add("t_assembly", t_asm).add("t_setup", t_setup).add("t_solve", t_solve)
+		   .add("iterations", inner_iterations).add("converged", int(iter.converged()))
+		   .add("peak_memory_kb_max", mem_max);
+		metrics.write(rec);
+	}
+	GMM_ASSERT1(iter.converged(), "distributed GMRES did not converge");
+}
+
+void
+problem3d1d::set_sweep_point(const sweep_point & p)
+{
+	sweep.build(p, AM, FM);
+	factorized = false;
+	gmm::resize(UM, dof.tot()); gmm::clear(UM);
+	// Parameters used by the flow rates
+	param.Q_ = sweep.Q0;                 gmm::scale(param.Q_, p.Lp);
+	param.sigma_ = sweep.sigma0*p.sigma;
+	param.sigma_vec_ = sweep.sigma_vec0; gmm::scale(param.sigma_vec_, p.sigma);
+	param.Q_LF_ = sweep.Q_LF0;           gmm::scale(param.Q_LF_, p.Q_LF);
+	param.kt_ = sweep.kt0;               gmm::scale(param.kt_, p.kt);
+	param.kv_ = sweep.kv0;               gmm::scale(param.kv_, p.kv);
+}
+
+void
+problem3d1d::solve_sweep_point(const sweep_point & p, sweep_result & r)
+{
+	scalar_type t0 = metrics3d1d::wall_time();
+	set_sweep_point(p);
+	r.converged = 0;
+	try {
+		r.converged = solve() ? 1 : 0;
+	}
+	catch (const std::exception & e) {
+		cerr << "sweep: parameter set " << p.name << " failed: " << e.what() << endl;
+	}
+	r.time = metrics3d1d::wall_time() - t0;
+	if (!r.converged) return;
+	r.TFR = TFR;
+	r.FRlymph = FRlymph;
+	r.FRCube = FRCube;
+	r.mean_pt = mean_pt();
+	r.mean_pv = mean_pv();
+}
+
+void
+problem3d1d::solve_sweep(const std::vector<sweep_point> & points, size_type nb_workers,
+	std::vector<sweep_result> & results)
+{
+	GMM_ASSERT1(sweep.FM0.size() == dof.tot(), "solve_sweep: call assembly_sweep first");
+	scalar_type t0 = metrics3d1d::wall_time();
+	const size_type np = points.size();
+	results.assign(np, sweep_result());
+	for (size_type k = 0; k < np; ++k) results[k].point = k;
+	nb_workers = std::max(size_type(1), std::min(nb_workers, np));
+
+	if (nb_workers == 1) {
+		for (size_type k = 0; k < np; ++k) {
+			cout << "Parameter sweep: solving " << points[k].name
+				 << " (" << k+1 << "/" << np << ") ..." << endl;
+			solve_sweep_point(points[k], results[k]);
+		}
+	}
+	else {
+		// Worker w solves the sets w, w+nb_workers, ... and writes its results
+		// (plain data, smaller than PIPE_BUF) to the pipe
+		int fd[2];
+		GMM_ASSERT1(pipe(fd) == 0, "solve_sweep: impossible to open the pipe");
+		cout.flush(); cerr.flush();
+		std::vector<pid_t> workers;
+		for (size_type w = 0; w < nb_workers; ++w) {
+			pid_t pid = fork();
+			GMM_ASSERT1(pid >= 0, "solve_sweep: impossible to fork worker " << w);
+			if (pid == 0) {
+				close(fd[0]);
+				metrics.close(); // only the parent writes the run log
+				for (size_type k = w; k < np; k += nb_workers) {
+					sweep_result r;
+					r.point = k;
+					solve_sweep_point(points[k], r);
+					ssize_t nw = write(fd[1], &r, sizeof(r));
+					if (nw != ssize_t(sizeof(r))) _exit(1);
+				}
+				close(fd[1]);
+				cout.flush(); cerr.flush();
+				_exit(0);
+			}
+			workers.push_back(pid);
+		}
+		close(fd[1]);
+		sweep_result r;
+		while (read(fd[0], &r, sizeof(r)) == ssize_t(sizeof(r)))
+			if (r.point < np) results[r.point] = r;
+		close(fd[0]);
+		for (pid_t pid : workers) {
+			int status = 0;
+			waitpid(pid, &status, 0);
+			if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+				cerr << "sweep: worker " << pid << " terminated abnormally" << endl;
+		}
+	}
+	// Back to the system of the .param values
+	set_sweep_point(sweep_point());
+
+	size_type nconv = 0;
+	for (const sweep_result & r : results) nconv += size_type(r.converged);
+	if (metrics.enabled()) {
+		metrics_record rec("sweep");
+		rec.add("points", np).add("workers", nb_workers).add("converged", nconv)
+		   .add("wall_s", metrics3d1d::wall_time() - t0);
+		metrics.write(rec);
+	}
+	cout << "Parameter sweep: " << nconv << "/" << np << " parameter sets solved with "
+		 << nb_workers << " worker(s)" << endl;
+}
+
+void
+problem3d1d::rom_offline(const std::vector<sweep_point> & train, scalar_type pod_tol)
+{
+	GMM_ASSERT1(sweep.FM0.size() == dof.tot(), "rom_offline: call assembly_sweep first");
+	GMM_ASSERT1(!train.empty(), "rom_offline: no training parameter set");
+	// Snapshots
+	scalar_type t0 = metrics3d1d::wall_time();
+	std::vector<vector_type> S;
+	for (size_type k = 0; k < train.size(); ++k) {
+		cout << "Reduced model: snapshot " << train[k].name
+			 << " (" << k+1 << "/" << train.size() << ") ..." << endl;
+		set_sweep_point(train[k]);
+		bool ok = false;
+		try { ok = solve(); }
+		catch (const std::exception & e) {
+			cerr << "rom: training set " << train[k].name << " failed: " << e.what() << endl;
+		}
+		if (ok) S.push_back(UM);
+	}
+	GMM_ASSERT1(!S.empty(), "rom_offline: no snapshot");
+	// Back to the system of the .param values
+	set_sweep_point(sweep_point());
+	scalar_type t_snap = metrics.phase("rom_snapshots", t0);
+
+	// POD of each field and projection of the affine terms
+	t0 = metrics3d1d::wall_time();
+	rom = reduced_model();
+	rom.N_ut = pod_basis(S, 0,                          dof.Ut(), pod_tol, rom.V);
+	rom.N_pt = pod_basis(S, dof.Ut(),                   dof.Pt(), pod_tol, rom.V);
+	rom.N_uv = pod_basis(S, dof.Ut()+dof.Pt(),          dof.Uv(), pod_tol, rom.V);
+	rom.N_pv = pod_basis(S, dof.Ut()+dof.Pt()+dof.Uv(), dof.Pv(), pod_tol, rom.V);
+	GMM_ASSERT1(rom.ready(), "rom_offline: empty POD basis");
+	rom.project(sweep);
+
+	// Outputs of the basis functions: the flow rates are affine in the
+	// solution, the constant parts are the ones of the zero solution
+	const size_type N = rom.size();
+	scalar_type frcube0 = 0.0;
+	compute_flow_rates(vector_type(dof.tot(), 0.0), rom.c_tfr, rom.c_lymph, frcube0);
+	rom.l_tfr.resize(N); rom.l_lymph.resize(N); rom.l_cube.resize(N);
+	rom.l_pt.resize(N);  rom.l_pv.resize(N);
+	for (size_type i = 0; i < N; ++i) {
+		const vector_type & Vi = rom.V[i];
+		compute_flow_rates(Vi, rom.l_tfr[i], rom.l_lymph[i], rom.l_cube[i]);
+		rom.l_tfr[i]   -= rom.c_tfr;
+		rom.l_lymph[i] -= rom.c_lymph;
+		rom.l_cube[i]  -= frcube0;
+		rom.l_pt[i] = asm_mean(mf_Pt, mimt,
+			gmm::sub_vector(Vi, gmm::sub_interval(dof.Ut(), dof.Pt())));
+		rom.l_pv[i] = asm_mean(mf_Pv, mimv,
+			gmm::sub_vector(Vi, gmm::sub_interval(dof.Ut()+dof.Pt()+dof.Uv(), dof.Pv())));
+	}
+	scalar_type t_off = metrics.phase("rom_offline", t0);
+
+	cout << "Reduced model: " << N << " basis functions (Ut " << rom.N_ut
+		 << ", Pt " << rom.N_pt << ", Uv " << rom.N_uv << ", Pv " << rom.N_pv
+		 << ") from " << S.size() << " snapshots" << endl;
+	if (metrics.enabled()) {
+		metrics_record rec("rom_offline");
+		rec.add("snapshots", S.size()).add("basis", N)
+		   .add("basis_ut", rom.N_ut).add("basis_pt", rom.N_pt)
+		   .add("basis_uv", rom.N_uv).add("basis_pv", rom.N_pv)
+		   .add("pod_tol", pod_tol).add("t_snapshots", t_snap).add("t_offline", t_off);
+		metrics.write(rec);
+	}
+}
+
+void
+problem3d1d::rom_query(const std::vector<sweep_point> & points, scalar_type tol,
+	std::vector<sweep_result> & results)
+{
+	GMM_ASSERT1(rom.ready(), "rom_query: call rom_offline first");
+	scalar_type t0 = metrics3d1d::wall_time();
+	const size_type np = points.size();
+	results.assign(np, sweep_result());
+	size_type nred = 0;
+	for (size_type k = 0; k < np; ++k) {
+		sweep_result & r = results[k];
+		r.point = k;
+		scalar_type t1 = metrics3d1d::wall_time();
+		vector_type a;
+		scalar_type est = std::numeric_limits<scalar_type>::infinity();
+		try { est = rom.solve(points[k], a); }
+		catch (const std::exception & e) {
+			cerr << "rom: reduced problem of " << points[k].name << " failed: " << e.what() << endl;
+		}
+		if (est <= tol) {
+			rom.outputs(points[k], a, r);
+			r.converged = 1;
+			r.reduced = 1;
+			r.time = metrics3d1d::wall_time() - t1;
+			++nred;
+		}
+		else {
+			cout << "Reduced model: error estimate " << est << " for " << points[k].name
+				 << ", solving the full model ..." << endl;
+			solve_sweep_point(points[k], r);
+		}
+		r.estimate = est;
+	}
+	// Back to the system of the .param values
+	if (nred < np) set_sweep_point(sweep_point());
+
+	if (metrics.enabled()) {
+		metrics_record rec("rom_online");
+		rec.add("points", np).add("reduced", nred).add("full", np-nred)
+		   .add("tol", tol).add("wall_s", metrics3d1d::wall_time() - t0);
+		metrics.write(rec);
+	}
+	cout << "Reduced model: " << nred << "/" << np << " parameter sets answered by the surrogate, "
+		 << np-nred << " by the full model" << endl;
+}
+
+void
+problem3d1d::assembly_transient(void)
+{
+	GMM_ASSERT1(descr.NETWORK_SOLVER == "FEM", "the transient problem needs NETWORK_SOLVER = 'FEM'");
+	trans.dt = PARAM.real_value("TIME_STEP", "Time step of the transient problem");
+	trans.t_end = PARAM.real_value("T_END", "Final time of the transient problem");
+	trans.scheme = PARAM.string_value("TIME_SCHEME");
+	if (trans.scheme.empty()) trans.scheme = "BE";
+	GMM_ASSERT1(trans.scheme == "BE" || trans.scheme == "BDF2",
+		"unknown TIME_SCHEME " << trans.scheme << " (BE or BDF2)");
+	trans.c_t = PARAM.real_value("STORAGE_T");
+	trans.c_v = PARAM.real_value("STORAGE_V");
+	GMM_ASSERT1(trans.c_t >= 0.0 && trans.c_v >= 0.0,
+		"the storage coefficients STORAGE_T and STORAGE_V must be non negative");
+	long every = PARAM.int_value("TRANSIENT_EXPORT_EVERY");
+	trans.export_every = every > 0 ? size_type(every) : 0;
+	std::string profile = PARAM.string_value("INFLOW_PROFILE");
+	if (!profile.empty()) read_inflow_profile(profile, trans);
+	trans.nb_steps(); // checks TIME_STEP and T_END
+	// Steady system and inflow term F_in (see sweep3d1d.hpp)
+	assembly_sweep();
+
+	scalar_type t0 = metrics3d1d::wall_time();
+	// Storage matrix
+	gmm::resize(trans.S, dof.tot(), dof.tot());
+	gmm::clear(trans.S);
+	sparse_matrix_type Mpt(dof.Pt(), dof.Pt());
+	sparse_matrix_type Mpv(dof.Pv(), dof.Pv());
+	asm_mass_matrix(Mpt, mimt, mf_Pt);
+	asm_mass_matrix(Mpv, mimv, mf_Pv);
+	gmm::add(gmm::scaled(Mpt, trans.c_t),
+		gmm::sub_matrix(trans.S, gmm::sub_interval(dof.Ut(), dof.Pt())));
+	gmm::add(gmm::scaled(Mpv, trans.c_v),
+		gmm::sub_matrix(trans.S, gmm::sub_interval(dof.Ut()+dof.Pt()+dof.Uv(), dof.Pv())));
+	metrics.phase("asm_storage", t0);
+}
+
+bool
+problem3d1d::solve_transient(void)
+{
+	GMM_ASSERT1(gmm::mat_nrows(trans.S) == dof.tot(), "solve_transient: call assembly_transient first");
+	const size_type nsteps = trans.nb_steps();
+	const bool bdf2 = (trans.scheme == "BDF2");
+	const scalar_type dt = trans.dt;
+	gmm::sub_interval Ipt(dof.Ut(), dof.Pt());
+	gmm::sub_interval Ipv(dof.Ut()+dof.Pt()+dof.Uv(), dof.Pv());
+	cout << "Transient problem: " << nsteps << " " << trans.scheme << " steps of " << dt << endl;
+
+	// Initial condition: steady state of the inflow pressures at t = 0
+	scalar_type g = trans.inflow_factor(0.0);
+	gmm::copy(sweep.FM0, FM);
+	gmm::add(gmm::scaled(sweep.Fin, g - 1.0), FM);
+	if (!solve()) return false;
+	// The meshes are exported once, the time steps are streamed
+	export_vtk("_t0");
+	transient_writer out;
+	out.open(descr.OUTPUT, trans.export_every > 0);
+	if (trans.export_every > 0) {
+		std::ofstream ofs_t(descr.OUTPUT + "transient_Pt_dofs.txt");
+		for (size_type i = 0; i < dof.Pt(); ++i)
+			ofs_t << mf_Pt.point_of_basic_dof(i) << endl;
+		std::ofstream ofs_v(descr.OUTPUT + "transient_Pv_dofs.txt");
+		for (size_type i = 0; i < dof.Pv(); ++i)
+			ofs_v << mf_Pv.point_of_basic_dof(i) << endl;
+	}
+	vector_type Pt(dof.Pt()), Pv(dof.Pv());
+	out.write_step(0, 0.0, g, TFR, FRlymph, FRCube, mean_pt(), mean_pv(), inner_iterations);
+	if (trans.export_every > 0) {
+		gmm::copy(gmm::sub_vector(UM, Ipt), Pt);
+		gmm::copy(gmm::sub_vector(UM, Ipv), Pv);
+		out.write_fields(0.0, Pt, Pv);
+	}
+
+	// Time matrix A + alpha/dt S, the same at each step
+	scalar_type t0 = metrics3d1d::wall_time();
+	const scalar_type alpha = bdf2 ? 1.5 : 1.0;
+	sparse_matrix_type At(dof.tot(), dof.tot());
+	gmm::copy(AM, At);
+	gmm::add(gmm::scaled(trans.S, alpha/dt), At);
+	const bool direct = (descr.SOLVE_METHOD == "SuperLU");
+	gmm::SuperLU_factor<scalar_type> SLU;
+	gmm::csr_matrix<scalar_type> Mtt, Mvv;
+	if (direct) {
+		gmm::csc_matrix<scalar_type> A;
+		gmm::copy(At, A);
+		SLU.build_with(A);
+	}
+	else {
+		// The storage terms are on the pressure rows: the velocity blocks
+		// of the preconditioner do not depend on the time step
+		gmm::copy(gmm::sub_matrix(AM, gmm::sub_interval(0, dof.Ut())), Mtt);
+		gmm::copy(gmm::sub_matrix(AM, gmm::sub_interval(dof.Ut()+dof.Pt(), dof.Uv())), Mvv);
+	}
+	std::unique_ptr< darcy_precond_mon< gmm::csr_matrix<scalar_type> > > precon;
+	if (!direct)
+		precon.reset(new darcy_precond_mon< gmm::csr_matrix<scalar_type> >(Mtt, mf_Pt, mimt, Mvv, mf_Pv, mimv));
+	scalar_type t_setup = metrics.phase(direct ? "factorization" : "preconditioner", t0);
+
+	// Time loop; the initial state is steady, so BDF2 starts with U^{-1} = U^0
+	t0 = metrics3d1d::wall_time();
+	vector_type U0(UM), Um1(UM), F(dof.tot()), W(dof.tot()), SU(dof.tot());
+	size_type iterations = 0, failed = 0;
+	for (size_type n = 1; n <= nsteps; ++n) {
+		const scalar_type t = scalar_type(n)*dt;
+		// F(t) + S (beta_0 U^n + beta_1 U^{n-1}) / dt
+		g = trans.inflow_factor(t);
+		gmm::copy(sweep.FM0, F);
+		gmm::add(gmm::scaled(sweep.Fin, g - 1.0), F);
+		if (!bdf2) gmm::copy(gmm::scaled(U0, 1.0/dt), W);
+		else gmm::add(gmm::scaled(U0, 2.0/dt), gmm::scaled(Um1, -0.5/dt), W);
+		gmm::mult(trans.S, W, SU);
+		gmm::add(SU, F);
+		if (direct) {
+			SLU.solve(UM, F);
+			inner_iterations = 0;
+		}
+		else {
+			// Starting from the previous step
+			gmm::iteration iter(descr.RES);
+			iter.set_maxiter(descr.MAXITER);
+			gmm::gmres(At, UM, F, *precon, 50, iter);
+			if (!iter.converged()) {
+				cerr << "  ... time step " << n << " reached the maximum number of iterations!" << endl;
+				++failed;
+			}
+			inner_iterations = iter.get_iteration();
+			iterations += inner_iterations;
+		}
+		gmm::copy(U0, Um1);
+		gmm::copy(UM, U0);
+		// Streamed output
+		compute_flow_rates(UM, TFR, FRlymph, FRCube);
+		out.write_step(n, t, g, TFR, FRlymph, FRCube, mean_pt(), mean_pv(), inner_iterations);
+		if (trans.export_every > 0 && (n % trans.export_every == 0 || n == nsteps)) {
+			gmm::copy(gmm::sub_vector(UM, Ipt), Pt);
+			gmm::copy(gmm::sub_vector(UM, Ipv), Pv);
+			out.write_fields(t, Pt, Pv);
+		}
+	}
+	scalar_type t_steps = metrics.phase("time_steps", t0);
+	// Back to the steady rhs of the .param values
+	gmm::copy(sweep.FM0, FM);
+
+	if (metrics.enabled()) {
+		metrics_record rec("transient");
+		rec.add("scheme", trans.scheme).add("steps", nsteps).add("dt", dt)
+		   .add("method", descr.SOLVE_METHOD).add("t_setup", t_setup)
+		   .add("t_steps", t_steps).add("inner_iterations", iterations)
+		   .add("failed_steps", failed);
+		metrics.write(rec);
+	}
+	cout << "... " << nsteps << " time steps in " << t_steps << " seconds ("
+		 << t_setup << " seconds of " << (direct ? "factorization" : "preconditioner") << ")" << endl;
+	return failed == 0;
+}
+
+
+void
+problem3d1d::build_graph(void)
+{
+	#ifdef M3D1D_VERBOSE_
+	cout << "Building the reduced network graph ... " << endl;
+	#endif
+	scalar_type t0 = metrics3d1d::wall_time();
+	graph.build(meshv, nb_branches, mf_Pv, BCv);
+	// Poiseuille conductance: 1/G_i = \int (1+Ci^2*Ri^2)/kv_i ds (= c_i/(pi*Ri^2)^2, see assembly_mat)
+	vector_type G(nb_branches);
+	for(size_type i=0; i<nb_branches; ++i){
+		scalar_type Ri = param.R(mimv, i);
+		scalar_type kvi = param.kv(mimv, i);
+		scalar_type res = 0.0;
+		for (getfem::mr_visitor mrv(meshv.region(i)); !mrv.finished(); ++mrv){
+			// works only for P0 coefficients
+			size_type j = mf_coefvi[i].ind_basic_dof_of_element(mrv.cv())[0];
+			res += (1.0+param.Curv(i,j)*param.Curv(i,j)*Ri*Ri)/kvi*estimate_h(meshv, mrv.cv());
+		}
+		G[i] = 1.0/res;
+	}
+	graph.set_conductance(G);
+	graph.assemble(gmm::sub_matrix(AM,
+			gmm::sub_interval(dof.Ut()+dof.Pt()+dof.Uv(), dof.Pv()),
+			gmm::sub_interval(dof.Ut()+dof.Pt()+dof.Uv(), dof.Pv())), PARAM.real_value("P0"));
+	graph.factorize();
+	metrics.phase("build_graph", t0);
+	#ifdef M3D1D_VERBOSE_
+	cout << graph;
+	#endif
+}
+
+bool
+problem3d1d::solve_graph(void)
+{
+	#ifdef M3D1D_VERBOSE_
+	cout << "Solving the tissue coupled with the reduced network ... " << endl;
+	#endif
+	build_graph();
+	const size_type nt = dof.Ut()+dof.Pt(), nr = graph.nb_nodes();
+	gmm::sub_interval It(0, nt), Ir(nt, nr);
+	gmm::sub_interval Ipv(dof.Ut()+dof.Pt()+dof.Uv(), dof.Pv());
+
+	// Reduced monolithic system: tissue blocks of AM and one vessel pressure per node
+	sparse_matrix_type AR(nt+nr, nt+nr);
+	sparse_matrix_type Ctv(nt, nr), Cvt(nr, nt), PT(nr, dof.Pv());
+	vector_type UR(nt+nr), FR(nt+nr), Fr;
+	gmm::copy(gmm::transposed(graph.P()), PT);
+	gmm::mult(gmm::sub_matrix(AM, It, Ipv), graph.P(), Ctv);
+	gmm::mult(PT, gmm::sub_matrix(AM, Ipv, It), Cvt);
+	gmm::add(gmm::sub_matrix(AM, It, It), gmm::sub_matrix(AR, It, It));
+	gmm::add(Ctv, gmm::sub_matrix(AR, It, Ir));
+	gmm::add(Cvt, gmm::sub_matrix(AR, Ir, It));
+	gmm::add(graph.A(), gmm::sub_matrix(AR, Ir, Ir));
+	graph.dirichlet_rows(AR, nt);
+	gmm::copy(gmm::sub_vector(FM, It), gmm::sub_vector(FR, It));
+	graph.restrict_rhs(gmm::sub_vector(FM, Ipv), Fr);
+	gmm::copy(Fr, gmm::sub_vector(FR, Ir));
+	gmm::clear(Ctv); gmm::clear(Cvt); gmm::clear(PT);
+
+	scalar_type t0 = metrics3d1d::wall_time();
+	gmm::csc_matrix<scalar_type> A;
+	gmm::copy(AR, A);
+	gmm::clear(AR);
+	gmm::SuperLU_factor<scalar_type> SLU;
+	SLU.build_with(A);
+	metrics.phase("factorization", t0);
+	t0 = metrics3d1d::wall_time();
+	SLU.solve(UR, FR);
+	metrics.phase("solve", t0);
+	inner_iterations = 0;
+
+	// Back to the FEM unknowns: Pv prolonged from the nodes, Uv constant on each branch
+	vector_type pr(nr), Pv(dof.Pv());
+	gmm::copy(gmm::sub_vector(UR, Ir), pr);
+	graph.prolong(pr, Pv);
+	gmm::resize(UM, dof.tot()); gmm::clear(UM);
+	gmm::copy(gmm::sub_vector(UR, It), gmm::sub_vector(UM, It));
+	gmm::copy(Pv, gmm::sub_vector(UM, Ipv));
+	size_type shift = 0;
+	for(size_type i=0; i<nb_branches; ++i){
+		if(i>0) shift += mf_Uvi[i-1].nb_dof();
+		scalar_type Ri = param.R(mimv, i);
+		scalar_type ui = graph.flow_rate(i, pr)/(pi*Ri*Ri);
+		for(size_type j=0; j<mf_Uvi[i].nb_dof(); ++j)
+			UM[dof.Ut()+dof.Pt()+shift+j] = ui;
+	}
+	#ifdef M3D1D_VERBOSE_
+	cout << "  Network unknowns : " << nr << " (instead of " << dof.Uv()+dof.Pv() << ")" << endl;
+	#endif
+	return true;
+}
 
 bool problem3d1d::solve_samg (void)
 	{
@@ -1569,6 +2715,7 @@ problem3d1d::iteration_solve(vector_type U_O,vector_type F_N){
                 bool RK=1;
                 
 		gmm::copy(U_new_gm,U_old_gm);gmm::copy(F_N,F_new_gm);
+		inner_iterations = 0;
 		
                         //Extracting matrix
                 gmm::csr_matrix<double> Mtt;  gmm::csr_matrix<double> Btt;
@@ -1711,6 +2858,7 @@ problem3d1d::iteration_solve(vector_type U_O,vector_type F_N){
 	
                 	gmm::copy(U_new_gm,U_old_gm);
                 	gmm::copy(F_N, F_new_gm);
+                	inner_iterations += iter_gm.get_iteration();
                 	#ifdef M3D1D_VERBOSE_
                 	cout << "  .ZZZZZ .. tissue gmres converged in " << iter_gm.get_iteration() << " iterations." << endl; 		
                 	#endif
@@ -1720,6 +2868,7 @@ problem3d1d::iteration_solve(vector_type U_O,vector_type F_N){
 	} // end of if for GMRES
 	else if ( descr.SOLVE_METHOD == "SuperLU" ){ 	//Solving with SuperLU method
  		gmm::SuperLU_solve(A, U_new, F_N, cond);
+		inner_iterations = 0;
  	}
 	//--------------------------------------
 	
@@ -1736,84 +2885,15 @@ problem3d1d::iteration_solve(vector_type U_O,vector_type F_N){
 }
 
 scalar_type
-problem3d1d::calcolo_Rk(vector_type U_N, vector_type U_O){
-
-// The residual is computed as ||V(k)-V(k-1)||/||V(k-1)|| with ||V(k)|| Eucledian norm
-
-	vector_type Pt_old(dof.Pt()); // Pt(k-1) 
-	vector_type Ut_old(dof.Ut()); // Ut(k-1)
-	vector_type Pv_old(dof.Pv()); // Pv(k-1)
-	vector_type Uv_old(dof.Uv()); // Uv(k-1)
-	vector_type Pt_new(dof.Pt()); // Pt(k)
-	vector_type Ut_new(dof.Ut()); // Ut(k)
-	vector_type Pv_new(dof.Pv()); // Pv(k)
-	vector_type Uv_new(dof.Uv()); // Uv(k)
-	scalar_type R_Pt, N_Pt;
-	scalar_type R_Ut, N_Ut;
-	scalar_type R_Pv, N_Pv;
-	scalar_type R_Uv, N_Uv;
-	scalar_type residual;
-	//obtain Pt(k-1)
-	gmm::copy(gmm::sub_vector(U_O,
-				gmm::sub_interval(dof.Ut(),dof.Pt())), 
-				Pt_old);
-	//obtain Ut(k-1)
-	gmm::copy(gmm::sub_vector(U_O,
-				gmm::sub_interval(0,dof.Ut())), 
-				Ut_old);
-	//Obtain Pv(k-1)
-	gmm::copy(gmm::sub_vector(U_O,
-				gmm::sub_interval(dof.Ut()+dof.Pt()+dof.Uv(),dof.Pv())), 
-				Pv_old);
-	//Obtain Uv(k-1)
-	gmm::copy(gmm::sub_vector(U_O,
-				gmm::sub_interval(dof.Ut()+dof.Pt(),dof.Uv())), 
-				Uv_old);
-	//obtain Pt(k)
-	gmm::copy(gmm::sub_vector(U_N,
-				gmm::sub_interval(dof.Ut(),dof.Pt())), 
-				Pt_new);
-	//obtain Ut(k)
-	gmm::copy(gmm::sub_vector(U_N,
-				gmm::sub_interval(0,dof.Ut())), 
-				Ut_new);
-	//Obtain Pv(k)
-	gmm::copy(gmm::sub_vector(U_N,
-				gmm::sub_interval(dof.Ut()+dof.Pt()+dof.Uv(),dof.Pv())), 
-				Pv_new);
-	//Obtain Uv(k)
-	gmm::copy(gmm::sub_vector(U_N,
-				gmm::sub_interval(dof.Ut()+dof.Pt(),dof.Uv())), 
-				Uv_new);
-	gmm::scale(Pt_old, -1.0);
-	gmm::scale(Ut_old, -1.0);
-	gmm::scale(Pv_old, -1.0);
-	gmm::scale(Uv_old, -1.0);
-
-	gmm::add(Pt_old, Pt_new);
-	gmm::add(Ut_old, Ut_new);
-	gmm::add(Pv_old, Pv_new);
-	gmm::add(Uv_old, Uv_new);
-
-	R_Pt=gmm::vect_norm2(Pt_new);
-	R_Ut=gmm::vect_norm2(Ut_new);
-	R_Pv=gmm::vect_norm2(Pv_new);
-	R_Uv=gmm::vect_norm2(Uv_new);
-
-	N_Pt=gmm::vect_norm2(Pt_old);
-	N_Ut=gmm::vect_norm2(Ut_old);
-	N_Pv=gmm::vect_norm2(Pv_old);
-	N_Uv=gmm::vect_norm2(Uv_old);
-	
-	/*cout << " Pt Residual = " << R_Pt/N_Pt << endl;
-	cout << " Ut Residual = " << R_Ut/N_Ut << endl;
-	cout << " Pv Residual = " << R_Pv/N_Pv << endl;
-	cout << " Uv Residual = " << R_Uv/N_Uv << endl;*/
-	residual=R_Pt/N_Pt+R_Ut/N_Ut+R_Pv/N_Pv+R_Uv/N_Uv;
+problem3d1d::calcolo_Rk(const vector_type & U_N, const vector_type & U_O){
 
+// The residual is computed as ||V(k)-V(k-1)||/||V(k-1)|| with ||V(k)|| Eucledian norm,
+// summed over Ut, Pt, Uv and Pv (one pass over U_N and U_O, see residual3d1d.hpp)
 
-	return residual; // gives if residual is bigger than the max value given in input 
+	residual_norms res({dof.Ut(), dof.Pt(), dof.Uv(), dof.Pv()});
+	accumulate_residual(U_N, U_O, res);
 
+	return res.sum_relative(); // gives if residual is bigger than the max value given in input 
 
 }
 
@@ -1821,6 +2901,7 @@ problem3d1d::calcolo_Rk(vector_type U_N, vector_type U_O){
 bool
 problem3d1d::solve_fixpoint(void)
 {
+	GMM_ASSERT1(!descr.DISTRIBUTED, "the fixed point method is not available with DISTRIBUTED = 1");
     std::cout << "*************** problem3d1d::solve_fixpoint <<<<<<<<<<<<"<<std::endl;
 /*  solver 
 1- use problem3d1d::solve to obtain the initial guess U0 as starting solution for the iterative method
@@ -1845,8 +2926,9 @@ problem3d1d::solve_fixpoint(void)
 
 */
 
-// 1 - solve the problem to obtain U0
-	solve();
+// 1 - solve the problem to obtain U0 (unless it comes from the coarse level)
+	if (!initial_guess) solve();
+	initial_guess = false;
 // 2 - declaration of variables
 	vector_type U_new; 
 	vector_type U_old;
@@ -1863,8 +2945,8 @@ problem3d1d::solve_fixpoint(void)
 	int iteration_save=descr.Save_it;
 	int iteration=0;
 	bool RK=1;
-	clock_t t;
-	clock_t time_G;
+	scalar_type t;      // wall time of the fluid solve [s]
+	scalar_type time_G; // wall time of the whole fixed point [s]
 	vector_type F_LF;
 	vector_type Uphi(dof.Pv()); 
 	sparse_matrix_type Bvt(dof.Pv(), dof.Pt());
@@ -1922,7 +3004,7 @@ problem3d1d::solve_fixpoint(void)
 
 	gmm::copy(UM,U_old);
 
-	time_G=clock();
+	time_G=metrics3d1d::wall_time();
 	
 while(RK && iteration < max_iteration)
 	{
@@ -1932,11 +3014,11 @@ while(RK && iteration < max_iteration)
 	//Adding lymphatic contribution
 	F_new=modify_vector_LF(U_old,F_new);
 	
-	t=clock();
+	t=metrics3d1d::wall_time();
 
 	U_new=iteration_solve(U_old,F_new);
 
-	t=clock()-t;
+	t=metrics3d1d::wall_time()-t;
 
 
 					
@@ -2006,10 +3088,17 @@ while(RK && iteration < max_iteration)
 	iteration++;
 	//Saving residual values in an output file
 	SaveResidual << iteration << "\t" << resSol << "\t" << resCM << endl;
+	if (metrics.enabled()) {
+		metrics_record rec("iteration");
+		rec.add("iteration", iteration).add("res_sol", resSol).add("res_cm", resCM)
+		   .add("TFR", TFR).add("FRlymph", FRlymph).add("FRCube", FRCube)
+		   .add("fluid_solve_s", t).add("inner_iterations", inner_iterations);
+		metrics.write(rec);
+	}
 
 			if(print_res)  {
 			cout << "Step n°:" << iteration << " Solution Residual = " << resSol << "\t Mass Residual = " << fabs(resCM) << endl;
-			cout << "\t\t\t\t\t\t\t      Time: " <<  ((float)t)/CLOCKS_PER_SEC << " s "<< endl;
+			cout << "\t\t\t\t\t\t\t      Time: " <<  t << " s "<< endl;
 					}
 			cout << "********************************************************" << endl;
 
@@ -2029,8 +3118,8 @@ while(RK && iteration < max_iteration)
 	} //Exit the while
 	
 	gmm::copy(U_old,UM);
-	time_G=clock()-time_G;
-	cout<< "Iterative Process Time = " << ((float)time_G)/CLOCKS_PER_SEC << " s"<< endl;
+	time_G=metrics.phase("fixpoint", time_G);
+	cout<< "Iterative Process Time = " << time_G << " s"<< endl;
 	SaveResidual.close();
 	if(RK)
 		cout << "The method has NOT reached convergence for minimum residual" << endl;
@@ -2040,15 +3129,120 @@ while(RK && iteration < max_iteration)
 	return true;
 }
 
+std::vector<std::string>
+problem3d1d::coarse_level_args(void)
+{
+	const size_type c = descr.NESTED_COARSENING;
+	std::vector<std::string> args;
+	args.push_back("-dNESTED_COARSENING=0");
+	if (PARAM.int_value("TEST_GEOMETRY")) {
+		// NSUBDIV_T = '[nx,ny,nz]'
+		string nsubdiv = PARAM.string_value("NSUBDIV_T");
+		std::replace(nsubdiv.begin(), nsubdiv.end(), '[', ' ');
+		std::replace(nsubdiv.begin(), nsubdiv.end(), ']', ' ');
+		vector<string> n = split(nsubdiv, ',');
+		std::ostringstream coarse;
+		coarse << "[";
+		for (size_type k = 0; k < n.size(); ++k)
+			coarse << (k ? "," : "") << std::max(1L, std::stol(n[k])/long(c));
+		coarse << "]";
+		args.push_back("-dNSUBDIV_T='" + coarse.str() + "'");
+		cout << "Nested iteration: coarse tissue mesh NSUBDIV_T = " << coarse.str() << endl;
+	}
+	else {
+		GMM_ASSERT1(descr.MESH_FILET_COARSE != "",
+			"NESTED_COARSENING with an imported tissue mesh needs MESH_FILET_COARSE");
+		args.push_back("-dMESH_FILET='" + descr.MESH_FILET_COARSE + "'");
+		cout << "Nested iteration: coarse tissue mesh " << descr.MESH_FILET_COARSE << endl;
+	}
+	if (descr.METRICS_FILE != "")
+		args.push_back("-dMETRICS_FILE='" + descr.METRICS_FILE + ".coarse'");
+	return args;
+}
+
+void
+problem3d1d::set_initial_guess(problem3d1d & coarse)
+{
+	GMM_ASSERT1(UM.size() == dof.tot(), "set_initial_guess: call assembly first");
+	GMM_ASSERT1(coarse.dof.Uv() == dof.Uv() && coarse.dof.Pv() == dof.Pv(),
+		"set_initial_guess: the coarse level has a different network");
+	scalar_type t0 = metrics3d1d::wall_time();
+	gmm::clear(UM);
+	// Tissue: interpolation from the coarse mesh
+	vector_type Pt(dof.Pt());
+	interpolation(coarse.mf_Pt, mf_Pt,
+		gmm::sub_vector(coarse.UM, gmm::sub_interval(coarse.dof.Ut(), coarse.dof.Pt())), Pt, 2);
+	gmm::copy(Pt, gmm::sub_vector(UM, gmm::sub_interval(dof.Ut(), dof.Pt())));
+	vector_type Ut(dof.Ut());
+	if (mf_Ut.is_lagrangian()) {
+		interpolation(coarse.mf_Ut, mf_Ut,
+			gmm::sub_vector(coarse.UM, gmm::sub_interval(0, coarse.dof.Ut())), Ut, 2);
+	}
+	else {
+		// RT0: interpolation on a discontinuous P1 field of the fine mesh,
+		// then L2 projection on mf_Ut
+		mesh_fem mf_data_vec(mesht);
+		mf_data_vec.set_qdim(bgeot::dim_type(DIMT));
+		mf_data_vec.set_classical_discontinuous_finite_element(1);
+		vector_type Ut_data(mf_data_vec.nb_dof());
+		interpolation(coarse.mf_Ut, mf_data_vec,
+			gmm::sub_vector(coarse.UM, gmm::sub_interval(0, coarse.dof.Ut())), Ut_data, 2);
+		sparse_matrix_type Mtt(dof.Ut(), dof.Ut());
+		sparse_matrix_type Mtd(dof.Ut(), mf_data_vec.nb_dof());
+		asm_mass_matrix(Mtt, mimt, mf_Ut);
+		asm_mass_matrix(Mtd, mimt, mf_Ut, mf_data_vec);
+		vector_type Ft(dof.Ut());
+		gmm::mult(Mtd, Ut_data, Ft);
+		gmm::csc_matrix<scalar_type> Mtt_csc;
+		gmm::copy(Mtt, Mtt_csc);
+		scalar_type cond;
+		gmm::SuperLU_solve(Mtt_csc, Ut, Ft, cond);
+	}
+	gmm::copy(Ut, gmm::sub_vector(UM, gmm::sub_interval(0, dof.Ut())));
+	// Network: same mesh and FEMs
+	gmm::copy(gmm::sub_vector(coarse.UM,
+			gmm::sub_interval(coarse.dof.Ut()+coarse.dof.Pt(), dof.Uv()+dof.Pv())),
+		gmm::sub_vector(UM, gmm::sub_interval(dof.Ut()+dof.Pt(), dof.Uv()+dof.Pv())));
+	initial_guess = true;
+	metrics.phase("nested_interpolation", t0);
+}
+
 ////////// Export results into vtk files ///////////////////////////////
+void
+problem3d1d::project_Ut_P1(const vector_type & Ut, vector_type & Ut_P1)
+{
+	// The projection operator only depends on the tissue mesh and FEMs:
+	// build it once and reuse it for every export
+	if (gmm::mat_ncols(M_Ut_P1) != dof.Ut() || mf_Ut_P1.nb_dof() == 0) {
+		#ifdef M3D1D_VERBOSE_
+		cout << "    Building the projection of Ut on P1 ..." << endl;
+		#endif
+		mf_Ut_P1.set_qdim(bgeot::dim_type(DIMT)); 
+		mf_Ut_P1.set_classical_finite_element(1);
+		sparse_matrix_type M_P1_P1(mf_Ut_P1.nb_dof(), mf_Ut_P1.nb_dof());
+		gmm::resize(M_Ut_P1, mf_Ut_P1.nb_dof(), dof.Ut()); gmm::clear(M_Ut_P1);
+		asm_mass_matrix(M_Ut_P1, mimt, mf_Ut_P1, mf_Ut);
+		asm_mass_matrix(M_P1_P1, mimt, mf_Ut_P1, mf_Ut_P1);
+		gmm::csc_matrix<scalar_type> M_P1_csc;
+		gmm::copy(M_P1_P1, M_P1_csc);
+		SLU_Ut_P1.build_with(M_P1_csc);
+	}
+	vector_type Utt(mf_Ut_P1.nb_dof());
+	gmm::resize(Ut_P1, mf_Ut_P1.nb_dof());
+	gmm::mult(M_Ut_P1, Ut, Utt);
+	SLU_Ut_P1.solve(Ut_P1, Utt);
+}
+
 void 
 problem3d1d::export_vtk(const string & suff)
 {
-  if (PARAM.int_value("VTK_EXPORT"))
+  // The solution is replicated: only the process 0 writes
+  if (PARAM.int_value("VTK_EXPORT") && mpi_rank() == 0)
   {
 	#ifdef M3D1D_VERBOSE_
 	cout << "Exporting the solution (vtk format) to " << descr.OUTPUT << " ..." << endl;
 	#endif
+	scalar_type t0 = metrics3d1d::wall_time();
 	#ifdef M3D1D_VERBOSE_
 	cout << "  Saving the results from the monolithic unknown vector ... " << endl;
 	#endif
@@ -2131,24 +3325,13 @@ problem3d1d::export_vtk(const string & suff)
 		#ifdef M3D1D_VERBOSE_
 		cout << "    Projecting Ut on P1 ..." << endl;
 		#endif
-		mesh_fem mf_P1(mesht);
-		mf_P1.set_qdim(bgeot::dim_type(DIMT)); 
-		mf_P1.set_classical_finite_element(1);
-		sparse_matrix_type M_RT0_P1(mf_P1.nb_dof(), dof.Ut());
-		sparse_matrix_type M_P1_P1(mf_P1.nb_dof(), mf_P1.nb_dof());
-		vector_type Ut_P1(mf_P1.nb_dof());
-                asm_mass_matrix(M_RT0_P1, mimt, mf_P1, mf_Ut);
-		asm_mass_matrix(M_P1_P1,  mimt, mf_P1, mf_P1);
-		
-		vector_type Utt(mf_P1.nb_dof());
-		gmm::mult(M_RT0_P1, Ut, Utt);
-		double cond1;
-		gmm::SuperLU_solve(M_P1_P1, Ut_P1, Utt, cond1);
+		vector_type Ut_P1;
+		project_Ut_P1(Ut, Ut_P1);
 
 		vtk_export exp1(descr.OUTPUT+"Ut.vtk");
-		exp1.exporting(mf_P1);
+		exp1.exporting(mf_Ut_P1);
 		exp1.write_mesh();
-		exp1.write_point_data(mf_P1, Ut_P1, "Ut");
+		exp1.write_point_data(mf_Ut_P1, Ut_P1, "Ut");
 	}	
 	else {
 		vtk_export exp_Ut(descr.OUTPUT+"Ut.vtk");
@@ -2252,6 +3435,7 @@ problem3d1d::export_vtk(const string & suff)
 	exp_Pv.exporting(mf_Pv);
 	exp_Pv.write_mesh();
 	exp_Pv.write_point_data(mf_Pv, Pv, "Pv");
+	metrics.phase("export", t0);
 
 	#ifdef M3D1D_VERBOSE_
 	cout << "... export done, visualize the data file with (for example) Paraview " << endl; 
@@ -2263,107 +3447,82 @@ problem3d1d::export_vtk(const string & suff)
 bool 
 merge_and_solve(problem3d1d & Pba, problem3d1d & Pbv)
 {
-
-	//! \todo Improve code re-utilisation. Derived class?
+	GMM_ASSERT1(!Pba.descr.DISTRIBUTED && !Pbv.descr.DISTRIBUTED,
+		"merge_and_solve needs DISTRIBUTED = 0");
+	GMM_ASSERT1(Pba.descr.NETWORK_SOLVER == "FEM" && Pba.LINEAR_LYMPH(),
+		"merge_and_solve needs NETWORK_SOLVER = 'FEM' and LINEAR_LYMPHATIC_DRAINAGE = 1");
+	GMM_ASSERT1(!Pba.network_only && Pbv.network_only,
+		"merge_and_solve: assemble the venous problem with assembly_network()");
+	// The tissue is shared, the networks may have different sizes. The
+	// meshes and FEMs are members of each problem, so the venous problem
+	// holds its own copy of the tissue (init_network_only copies it from
+	// the arterial problem): check that it is the same one (same FEMs,
+	// same dofs at the same points)
+	GMM_ASSERT1(Pba.descr.FEM_TYPET == Pbv.descr.FEM_TYPET
+		&& Pba.descr.FEM_TYPET_P == Pbv.descr.FEM_TYPET_P
+		&& Pba.descr.IM_TYPET == Pbv.descr.IM_TYPET
+		&& Pba.dof.Ut() == Pbv.dof.Ut() && Pba.dof.Pt() == Pbv.dof.Pt(),
+		"arterial and venous problems must have the same tissue mesh and FEMs");
+	{
+		scalar_type dmax = 0.0;
+		for (size_type i = 0; i < Pba.dof.Ut(); ++i)
+			dmax = std::max(dmax, gmm::vect_dist2(Pba.mf_Ut.point_of_basic_dof(i), Pbv.mf_Ut.point_of_basic_dof(i)));
+		for (size_type i = 0; i < Pba.dof.Pt(); ++i)
+			dmax = std::max(dmax, gmm::vect_dist2(Pba.mf_Pt.point_of_basic_dof(i), Pbv.mf_Pt.point_of_basic_dof(i)));
+		GMM_ASSERT1(dmax <= 1.0E-10,
+			"arterial and venous problems have different tissue geometries (dof distance " << dmax << ")");
+	}
 	
 	#ifdef M3D1D_VERBOSE_
 	cout << "Merge arterial and venous monolithic matrix  ..." << endl;
 	#endif
-	// Dim assumption
-	GMM_ASSERT1(Pba.dof.tot() == Pbv.dof.tot(),
-		"arterial and venous problem must have same dimension");
-	// Dimensions	
-	size_type dof_t   = Pba.dof.Ut() + Pba.dof.Pt();
-	size_type dof_v   = Pba.dof.Uv() + Pba.dof.Pv();
+	scalar_type t0 = metrics3d1d::wall_time();
+	// Dimensions [Ut, Pt, Uva, Pva, Uvv, Pvv]
 	size_type dof_ut  = Pba.dof.Ut();
 	size_type dof_pt  = Pba.dof.Pt();
-	size_type dof_uv  = Pba.dof.Uv();
-	size_type dof_pv  = Pba.dof.Pv();
-	size_type dof_tot = dof_t + 2*dof_v;
-	// Temp arterial-venous monolithic matrix 
+	size_type dof_t   = dof_ut + dof_pt;
+	size_type dof_va  = Pba.dof.Uv() + Pba.dof.Pv();
+	size_type dof_vv  = Pbv.dof.Uv() + Pbv.dof.Pv();
+	size_type dof_tot = dof_t + dof_va + dof_vv;
+	gmm::sub_interval It(0, dof_t);
+	gmm::sub_interval Iva(dof_t, dof_va);
+	gmm::sub_interval Ivv(dof_t, dof_vv);
+	gmm::sub_interval Ivv_av(dof_t+dof_va, dof_vv);
+	// Arterial-venous monolithic matrix 
 	sparse_matrix_type AMav(dof_tot, dof_tot);
-	#ifdef M3D1D_VERBOSE_
-	cout << "  Copying tissue and arterial matrices ..." << endl;
-	#endif
-	gmm::copy(Pba.AM, 
-		gmm::sub_matrix(AMav,
-			gmm::sub_interval(0, dof_t + dof_v),
-			gmm::sub_interval(0, dof_t + dof_v)));
-	#ifdef M3D1D_VERBOSE_
-	cout << "  Copying venous matrices ..." << endl;
-	#endif
-	// Mvv, -Dvv^T, Dvv, Bvv
-	gmm::copy(
-		gmm::sub_matrix(Pbv.AM, 
-			gmm::sub_interval(dof_t, dof_v), 
-			gmm::sub_interval(dof_t, dof_v)),
-		gmm::sub_matrix(AMav,
-			gmm::sub_interval(dof_t+dof_v, dof_v),
-			gmm::sub_interval(dof_t+dof_v, dof_v)));
-	// Btt
-	gmm::add(
-		gmm::sub_matrix(Pbv.AM, 
-			gmm::sub_interval(dof_ut, dof_pt), 
-			gmm::sub_interval(dof_ut, dof_pt)),
-		gmm::sub_matrix(AMav,
-			gmm::sub_interval(dof_ut, dof_pt), 
-			gmm::sub_interval(dof_ut, dof_pt)));
-	// Btv
-	gmm::copy(
-		gmm::sub_matrix(Pbv.AM, 
-			gmm::sub_interval(dof_ut, dof_pt), 
-			gmm::sub_interval(dof_t+dof_uv, dof_pv)),
-		gmm::sub_matrix(AMav,
-			gmm::sub_interval(dof_ut, dof_pt), 
-			gmm::sub_interval(dof_t+dof_v+dof_uv, dof_pv)));
-	// Bvt
-	gmm::copy(
-		gmm::sub_matrix(Pbv.AM, 
-			gmm::sub_interval(dof_t+dof_uv, dof_pv),
-			gmm::sub_interval(dof_ut, dof_pt)), 
-		gmm::sub_matrix(AMav,
-			gmm::sub_interval(dof_t+dof_v+dof_uv, dof_pv),
-			gmm::sub_interval(dof_ut, dof_pt))); 
-	// De-allocate memory
-	gmm::clear(Pba.AM); gmm::clear(Pbv.AM);
-
-	#ifdef M3D1D_VERBOSE_
-	cout << "Merge arterial and venous monolithic rhs  ..." << endl;
-	#endif
+	// Tissue (assembled once, by the arterial problem) and arterial blocks
+	gmm::copy(Pba.AM, gmm::sub_matrix(AMav, gmm::sub_interval(0, dof_t+dof_va)));
+	// Venous exchange with the tissue (Btt) 
+	gmm::add(gmm::sub_matrix(Pbv.AM, It, It), gmm::sub_matrix(AMav, It, It));
+	// Venous exchange blocks (Btv, Bvt) and network (Mvv, -Dvv^T, Dvv, Bvv)
+	gmm::copy(gmm::sub_matrix(Pbv.AM, It, Ivv), gmm::sub_matrix(AMav, It, Ivv_av));
+	gmm::copy(gmm::sub_matrix(Pbv.AM, Ivv, It), gmm::sub_matrix(AMav, Ivv_av, It));
+	gmm::copy(gmm::sub_matrix(Pbv.AM, Ivv, Ivv), gmm::sub_matrix(AMav, Ivv_av, Ivv_av));
+
+	// Arterial-venous monolithic rhs (the venous tissue rows hold the oncotic term)
 	vector_type FMav(dof_tot);
-	#ifdef M3D1D_VERBOSE_
-	cout << "  Copying tissue and arterial RHS ..." << endl;
-	#endif
-	gmm::copy(Pba.FM,
-		gmm::sub_vector(FMav, gmm::sub_interval(0, dof_t+dof_v)));	
-	#ifdef M3D1D_VERBOSE_
-	cout << "  Copying venous RHS ..." << endl;
-	#endif
-	gmm::copy(
-		gmm::sub_vector(Pbv.FM,
-			gmm::sub_interval(dof_t, dof_v)),
-		gmm::sub_vector(FMav, 
-			gmm::sub_interval(dof_t+dof_v, dof_v)));
-	// De-allocate memory
-	gmm::clear(Pba.FM); gmm::clear(Pbv.FM);
+	gmm::copy(Pba.FM, gmm::sub_vector(FMav, gmm::sub_interval(0, dof_t+dof_va)));
+	gmm::add(gmm::sub_vector(Pbv.FM, It), gmm::sub_vector(FMav, It));
+	gmm::copy(gmm::sub_vector(Pbv.FM, Ivv), gmm::sub_vector(FMav, Ivv_av));
+	scalar_type t_merge = Pba.metrics.phase("merge_networks", t0);
 
 	#ifdef M3D1D_VERBOSE_
-	cout << "Solving the extended arterial-venous monolithic rhs  ..." << endl;
+	cout << "Solving the extended arterial-venous monolithic system  ..." << endl;
 	#endif
 	vector_type UMav(dof_tot);
-	double time = gmm::uclock_sec();	
-	gmm::csc_matrix<scalar_type> Aav;
+	t0 = metrics3d1d::wall_time();
+	size_type iterations = 0;
 	
 	if ( Pba.descr.SOLVE_METHOD == "SuperLU" ) { // direct solver //
-		gmm::clean(AMav, 1E-12);
-		gmm::copy(AMav, Aav);
-		gmm::clear(AMav);
 		#ifdef M3D1D_VERBOSE_
 		cout << "  Applying the SuperLU method ... " << endl;
 		#endif
+		gmm::csc_matrix<scalar_type> Aav;
+		gmm::clean(AMav, 1E-12);
+		gmm::copy(AMav, Aav);
 		scalar_type cond;
 		gmm::SuperLU_solve(Aav, UMav, FMav, cond);
-		cout << "  Condition number : " << cond << endl;
+		cout << "  Reciprocal condition number (rcond) : " << cond << endl;
 	}
 	else { // Iterative solver //
 
@@ -2393,7 +3552,14 @@ merge_and_solve(problem3d1d & Pba, problem3d1d & Pbv)
 			cout << "  Applying the Generalized Minimum Residual method ... " << endl;
 			#endif
 			size_type restart = 50;
-			gmm::gmres(AMav, UMav, FMav, PMav, restart, iter);
+			// Block diagonal preconditioner: tissue, arteries, veins
+			gmm::csr_matrix<double> Mtt, Mva, Mvv;
+			gmm::copy(gmm::sub_matrix(AMav, gmm::sub_interval(0, dof_ut)), Mtt);
+			gmm::copy(gmm::sub_matrix(AMav, gmm::sub_interval(dof_t, Pba.dof.Uv())), Mva);
+			gmm::copy(gmm::sub_matrix(AMav, gmm::sub_interval(dof_t+dof_va, Pbv.dof.Uv())), Mvv);
+			darcy_precond_av< gmm::csr_matrix<double>> precon(Mtt, Pba.mf_Pt, Pba.mimt,
+				Mva, Pba.mf_Pv, Pba.mimv, Mvv, Pbv.mf_Pv, Pbv.mimv);
+			gmm::gmres(AMav, UMav, FMav, precon, restart, iter);
 		}
 		else if ( Pba.descr.SOLVE_METHOD == "QMR" ) {
 			#ifdef M3D1D_VERBOSE_
@@ -2407,6 +3573,7 @@ merge_and_solve(problem3d1d & Pba, problem3d1d & Pbv)
 			#endif
 			gmm::least_squares_cg(AMav, UMav, FMav, iter);
 		}
+		iterations = iter.get_iteration();
 		// Check
 		if (iter.converged())
 			cout << "  ... converged in " << iter.get_iteration() << " iterations." << endl;
@@ -2414,73 +3581,37 @@ merge_and_solve(problem3d1d & Pba, problem3d1d & Pbv)
 			cerr << "  ... reached the maximum number of iterations!" << endl;
 
 	}
-	cout << "... time to solve : " << gmm::uclock_sec() - time << " seconds\n";
+	scalar_type t_solve = Pba.metrics.phase("solve_arterial_venous", t0);
+	cout << "... time to solve : " << t_solve << " seconds\n";
 
 	#ifdef M3D1D_VERBOSE_
-	cout << "Saving results of venous problem ... " << endl;
+	cout << "Saving results of arterial and venous problems ... " << endl;
 	#endif
-	gmm::copy(
-		gmm::sub_vector(UMav, 
-			gmm::sub_interval(0, dof_t+dof_v)), 
-		gmm::sub_vector(Pba.UM, 
-			gmm::sub_interval(0, dof_t+dof_v)));
-	gmm::copy(
-		gmm::sub_vector(UMav, 
-			gmm::sub_interval(dof_t+dof_v, dof_v)), 
-		gmm::sub_vector(Pbv.UM, 
-			gmm::sub_interval(dof_t, dof_v)));
-
-	#ifdef M3D1D_VERBOSE_
-	cout << "Compute the total flow rate ... " << endl;
-	#endif
-	// Aux vector
-	vector_type Uphi(dof_pv); 
-	// Extracting matrices Bvt, Bvv
-	sparse_matrix_type Bvt(dof_pv, dof_pt);
-	sparse_matrix_type Bvv(dof_pv, dof_pv);
-	gmm::copy(gmm::sub_matrix(Aav, 
-			gmm::sub_interval(dof_t+dof_uv, dof_pv),
-			gmm::sub_interval(dof_ut, dof_pt)),
-				Bvt); 
-	gmm::copy(gmm::sub_matrix(Aav, 
-			gmm::sub_interval(dof_t+dof_uv, dof_pv), 
-			gmm::sub_interval(dof_t+dof_uv, dof_pv)),
-				Bvv); 
-	// Extracting solutions Pt, Pv 
-	vector_type Pt(dof_pt); 
-	vector_type Pv(dof_pv); 
-	gmm::copy(gmm::sub_vector(UMav, 
-		gmm::sub_interval(dof_ut, dof_pt)), Pt);
-	gmm::copy(gmm::sub_vector(UMav, 
-		gmm::sub_interval(dof_t+dof_uv, dof_pv)), Pv);
-	// Computing Bvv*Pv - Bvt*Pt
-	gmm::mult(Bvt, Pt, Uphi);
-	gmm::mult_add(Bvv, Pv, Uphi);
-	Pba.TFR = std::accumulate(Uphi.begin(), Uphi.end(), 0.0);
-
-	// Extracting matrices Bvt, Bvv
-	gmm::copy(gmm::sub_matrix(Aav, 
-			gmm::sub_interval(dof_t+dof_v+dof_uv, dof_pv),
-			gmm::sub_interval(dof_ut, dof_pt)),
-				Bvt); 
-	gmm::copy(gmm::sub_matrix(Aav, 
-			gmm::sub_interval(dof_t+dof_v+dof_uv, dof_pv), 
-			gmm::sub_interval(dof_t+dof_v+dof_uv, dof_pv)),
-				Bvv); 
-	// Extracting solutions Pt, Pv 
-	gmm::copy(gmm::sub_vector(UMav, 
-		gmm::sub_interval(dof_t+dof_v+dof_uv, dof_pv)), Pv);
-	// Computing Bvv*Pv - Bvt*Pt
-	gmm::clear(Uphi);
-	gmm::mult(Bvt, Pt, Uphi);
-	gmm::mult_add(Bvv, Pv, Uphi);
-        Pbv.TFR = std::accumulate(Uphi.begin(), Uphi.end(), 0.0);
+	// The tissue solution is shared by both problems
+	gmm::copy(gmm::sub_vector(UMav, gmm::sub_interval(0, dof_t+dof_va)), Pba.UM);
+	gmm::copy(gmm::sub_vector(UMav, It), gmm::sub_vector(Pbv.UM, It));
+	gmm::copy(gmm::sub_vector(UMav, Ivv_av), gmm::sub_vector(Pbv.UM, Ivv));
+
+	// Exchange of each network, lymphatic and cube flow rates of the tissue
+	// (the venous problem has no tissue blocks: the tissue rates are copied)
+	Pba.compute_flow_rates(Pba.UM, Pba.TFR, Pba.FRlymph, Pba.FRCube);
+	Pbv.TFR     = Pbv.network_flow_rate(Pbv.UM);
+	Pbv.FRlymph = Pba.FRlymph;
+	Pbv.FRCube  = Pba.FRCube;
+
+	if (Pba.metrics.enabled()) {
+		metrics_record rec("merge_and_solve");
+		rec.add("method", Pba.descr.SOLVE_METHOD).add("dofs", dof_tot)
+		   .add("dofs_arterial", dof_va).add("dofs_venous", dof_vv)
+		   .add("t_merge", t_merge).add("t_solve", t_solve)
+		   .add("inner_iterations", iterations)
+		   .add("tfr_arterial", Pba.TFR).add("tfr_venous", Pbv.TFR);
+		Pba.metrics.write(rec);
+	}
+	cout << "  Arterial TFR = " << Pba.TFR << ", venous TFR = " << Pbv.TFR << endl;
 
 	// De-allocate memory
 	gmm::clear(AMav); gmm::clear(UMav); gmm::clear(FMav);
-	gmm::clear(Bvt); gmm::clear(Bvv);
-	gmm::clear(Pt);  gmm::clear(Pv);  
-	gmm::clear(Uphi);
 
 	return true;
 
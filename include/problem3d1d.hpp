@@ -27,6 +27,7 @@
 #include <getfem/getfem_superlu.h>
 #include <getfem/getfem_partial_mesh_fem.h>
 #include <getfem/getfem_interpolated_fem.h>
+#include <getfem/getfem_interpolation.h>
 #include <gmm/gmm.h>
 #include <gmm/gmm_inoutput.h>
 #include <gmm/gmm_iter_solvers.h>
@@ -51,6 +52,15 @@
 #include <param3d1d.hpp>
 #include <c_mesh1d.hpp>
 #include <c_descr3d1d.hpp>
+#include <cache3d1d.hpp>
+#include <metrics3d1d.hpp>
+#include <network_graph.hpp>
+#include <residual3d1d.hpp>
+#include <mpi3d1d.hpp>
+#include <sweep3d1d.hpp>
+#include <rom3d1d.hpp>
+#include <transient3d1d.hpp>
+#include <tasks3d1d.hpp>
 //#include <defines.hpp>
 #include <time.h>
 #include <random>
@@ -60,6 +70,36 @@
 
 namespace getfem {
 
+//! Flow-rate diagnostics of a solution
+struct flow_rates {
+	//! Total flow rate from network to tissue
+	scalar_type TFR;
+	//! Total flow rate of the lymphatic system
+	scalar_type FRlymph;
+	//! Total flow rate from the cube
+	scalar_type FRCube;
+
+	flow_rates(void) : TFR(0.0), FRlymph(0.0), FRCube(0.0) {}
+};
+
+//! Gradient of a global output with respect to per-branch factors
+/*!
+	Derivatives with respect to a factor multiplying the coefficient on
+	one branch, at factor 1 (i.e. @f$ L_{p,i}\,\partial J/\partial L_{p,i} @f$).
+ */
+struct branch_gradient {
+	//! Value of the output
+	scalar_type J;
+	//! Derivatives with respect to the vessel wall permeability of each branch
+	vector_type Lp;
+	//! Derivatives with respect to the reflection coefficient of each branch
+	vector_type sigma;
+	//! Derivatives with respect to the vessel bed conductivity of each branch
+	vector_type kv;
+
+	branch_gradient(void) : J(0.0) {}
+};
+
 //!	Main class defining the coupled 3D/1D fluid problem.
 class problem3d1d {
 
@@ -72,7 +112,8 @@ public:
 	problem3d1d(void) : 
 		mimt(mesht),  mimv(meshv),
 		mf_Pt(mesht), mf_coeft(mesht), mf_Ut(mesht),
-		mf_Pv(meshv), mf_coefv(meshv)
+		mf_Pv(meshv), mf_coefv(meshv), mf_Ut_P1(mesht), inner_iterations(0),
+		initial_guess(false), factorized(false), network_only(false), assembly_time(0.0)
 	{} 
 	//! Initialize the problem
 	/*!
@@ -83,8 +124,22 @@ public:
 		5. Build problem parameters
 		6. Build the list of tissue boundary data
 		7. Build the list of vessel boundary (and junction) data
+
+		Steps 3-7 are a task graph (see tasks3d1d.hpp) run on SETUP_THREADS OpenMP
+		threads: the tissue and the network meshes are imported concurrently,
+		the other steps visit mesh regions and run serially. The graph and
+		the time of each task are printed. With SETUP_CHECK = 1 the result
+		is compared with a sequential setup.
 	 */
 	void init (int argc, char *argv[]);
+	//! Initialize the venous problem of merge_and_solve on the tissue of another problem
+	/*!
+		As init(), but the tissue mesh, its IMs and FEMs are taken from
+		the (initialized) problem tissue instead of being imported and set
+		up again: only the network is read. The tissue dofs are the same
+		as those of tissue.
+	 */
+	void init_network_only (int argc, char *argv[], const problem3d1d & tissue);
 	//! Assemble the problem
 	/*!
 		1. Initialize problem matrices and vectors
@@ -92,18 +147,173 @@ public:
 		3. Build the monolithic rhs FM
 	 */
 	void assembly (void);
+	//! Assemble the network and exchange blocks only (venous problem of merge_and_solve)
+	/*!
+		The tissue Darcy, lymphatic and boundary terms are skipped: they
+		are assembled once, by the arterial problem.
+	 */
+	void assembly_network (void);
 	void assembly_fixpoint (void);
+	//! Assemble the problem and its affine decomposition in the sweep factors
+	/*!
+		See sweep3d1d.hpp. Only the linear problem (LINEAR_LYMPHATIC_DRAINAGE = 1)
+		on a single process is supported.
+	 */
+	void assembly_sweep (void);
+	//! Assemble the transient problem: steady system, inflow term and storage matrix
+	/*!
+		See transient3d1d.hpp. Reads TIME_STEP, T_END, TIME_SCHEME,
+		STORAGE_T, STORAGE_V, INFLOW_PROFILE and TRANSIENT_EXPORT_EVERY.
+		Only the linear problem (LINEAR_LYMPHATIC_DRAINAGE = 1) on a single
+		process is supported.
+	 */
+	void assembly_transient (void);
 	//! Solve the problem
 	/*!
 		Solve the monolithic system AM*UM=FM (direct or iterative)
 	 */
 	bool solve (void);
+	//! Solve the transient problem (after assembly_transient)
+	/*!
+		The initial condition is the steady state of the inflow pressures
+		at t = 0 (BDF2 takes it for the two previous levels). The time
+		matrix is factorized once (SuperLU) or the preconditioner of GMRES
+		is built once, for all the steps; each step is a triangular
+		solve or a GMRES warm-started from the previous step. The final
+		time is rounded up to a multiple of TIME_STEP. The flow rates and
+		the pressure snapshots are streamed (see transient_writer); UM
+		holds the solution at the final time.
+	 */
+	bool solve_transient (void);
+	//! Solve the tissue coupled with the reduced network (NETWORK_SOLVER = 'GRAPH')
+	/*!
+		The vessel unknowns are replaced by one pressure per junction and
+		boundary node (see network_graph), the tissue is unchanged. The
+		vessel pressure is prolonged linearly along the branches and the
+		velocity is constant on each branch.
+	 */
+	bool solve_graph (void);
 	bool solve_samg (void);
+	//! Solve the problem with the tissue distributed among the MPI processes (DISTRIBUTED = 1)
+	/*!
+		GMRES on the row-distributed monolithic matrix, preconditioned by
+		the restricted additive Schwarz method (one subdomain per process).
+		The solution UM is replicated on all processes. The process 0
+		prints (and logs) the scaling report.
+	 */
+	void solve_distributed (void);
+	//! Solve the problem for a block of right hand sides (same AM)
+	/*!
+		@param F      Right hand sides, one per scenario (see scenario_rhs)
+		@param U      Solutions, one per scenario
+		@param rates  Flow rates of each scenario
+
+		SuperLU: AM is factorized once and the triangular solves are
+		repeated on each right hand side. Iterative methods: GMRES with the
+		monolithic preconditioner built once, each scenario starting from
+		the solution of the previous one. UM is not modified.
+	 */
+	void solve_multi_rhs (const std::vector<vector_type> & F,
+		std::vector<vector_type> & U, std::vector<flow_rates> & rates);
+	//! Right hand side of a boundary-data scenario
+	/*!
+		@param BCt_s  Tissue boundary data (same labels as tissue_bc())
+		@param BCv_s  Network boundary data (same labels as vessel_bc(),
+		              same values on the MIX nodes, which enter AM)
+		@param F      Monolithic rhs of the scenario
+
+		The boundary terms of FM are replaced by the ones of the scenario.
+	 */
+	void scenario_rhs (const vector<node> & BCt_s, const vector<node> & BCv_s,
+		vector_type & F);
+	//! List of BC nodes on the tissue
+	inline const vector<node> & tissue_bc (void) const { return BCt; }
+	//! List of BC nodes of the network (values of the outflow extrema with flipped sign)
+	inline const vector<node> & vessel_bc (void) const { return BCv; }
+	//! Solve the parameter sets of a sweep (after assembly_sweep)
+	/*!
+		Each parameter set rescales the blocks of the decomposition and is
+		solved with SOLVE_METHOD. With nb_workers > 1 the sets are split
+		among forked worker processes, which share the meshes, the FEMs and
+		the decomposition (copy on write): at most nb_workers systems and
+		factorizations are in memory at a time. The problem is left with
+		the system of the .param values.
+	 */
+	void solve_sweep (const std::vector<sweep_point> & points, size_type nb_workers,
+		std::vector<sweep_result> & results);
+	//! Build the reduced-order surrogate from full solves (after assembly_sweep)
+	/*!
+		@param train    Training parameter sets (one snapshot each)
+		@param pod_tol  Relative energy discarded by the POD of each field
+
+		See rom3d1d.hpp. The problem is left with the system of the .param values.
+	 */
+	void rom_offline (const std::vector<sweep_point> & train, scalar_type pod_tol);
+	//! Answer the parameter sets with the reduced-order surrogate (after rom_offline)
+	/*!
+		A parameter set whose error estimate exceeds tol is solved with the
+		full model (SOLVE_METHOD) instead; results[k].reduced tells which.
+	 */
+	void rom_query (const std::vector<sweep_point> & points, scalar_type tol,
+		std::vector<sweep_result> & results);
+	//! Adjoint gradient of a global output with respect to the per-branch coefficients
+	/*!
+		@param output  "TFR" or "FRLYMPH"
+		@param grad    Value and per-branch derivatives of the output
+
+		To be called after solve() (LINEAR_LYMPHATIC_DRAINAGE = 1). One
+		solve with the transposed AM (SuperLU: the factorization of solve()
+		is reused) gives the derivatives with respect to all the branches.
+		The oncotic term of TFR is differentiated with the reflection
+		coefficients of the assembly (per branch if IMPORT_SIGMA = 1).
+	 */
+	void adjoint_gradient (const std::string & output, branch_gradient & grad);
+	//! Adjoint gradient of a linear functional of the solution, J = w^T UM
+	/*!
+		w is any weight of the monolithic unknowns (e.g. a flux through a
+		set of boundary faces or vessel extrema), without explicit
+		dependence on the coefficients.
+	 */
+	void adjoint_gradient (const vector_type & w, branch_gradient & grad);
+	//! Output of the adjoint gradient after the solve ("" = none)
+	inline const std::string & ADJOINT_OUTPUT (void) const { return descr.ADJOINT_OUTPUT; }
+	//! Points file of the venous network of merge_and_solve ("" = arterial network only)
+	inline const std::string & MESH_FILEV_VENOUS (void) const { return descr.MESH_FILEV_VENOUS; }
+	//! Export the per-branch gradient (OUTPUT/adjoint_gradient_<name>.txt)
+	void export_gradient (const branch_gradient & grad, const std::string & name);
 	bool solve_fixpoint (void);
+	//! True if the fixed point starts from a coarse level (NESTED_COARSENING > 1)
+	inline bool NESTED_ITERATION (void) const { return descr.NESTED_COARSENING > 1; }
+	//! Command line overrides (-d...) of the coarse level of the nested iteration
+	/*!
+		The tissue mesh is coarsened by NESTED_COARSENING (regular mesh:
+		NSUBDIV_T divided by the factor; imported mesh: MESH_FILET_COARSE),
+		the network is unchanged. The coarse level is not nested again and
+		logs to METRICS_FILE.coarse.
+	 */
+	std::vector<std::string> coarse_level_args (void);
+	//! Use the (converged) solution of the coarse level as initial guess of the fixed point
+	/*!
+		To be called after assembly(). The tissue pressure and velocity are
+		interpolated from the coarse tissue mesh (a non-Lagrangian velocity,
+		e.g. RT0, is interpolated on a discontinuous P1 field and projected
+		in L2 on mf_Ut), the network solution is copied. solve_fixpoint
+		then skips the initial solve.
+	 */
+	void set_initial_guess (problem3d1d & coarse);
 	//! Solve the problem with arterial-venous network
 	/*!
-		Merge arterial and venous networks
-		Solve the monolithic system AM*UM=FM (direct or iterative)
+		Merge the arterial problem Pa (assembly) and the venous problem Pv
+		(assembly_network) sharing the tissue: the unknowns are
+		[Ut, Pt, Uva, Pva, Uvv, Pvv], the networks may have any size.
+		Pv holds a copy of the tissue mesh and FEMs of Pa (they are
+		members of each problem, used by its exchange operators), see
+		init_network_only: they must be identical to those of Pa, which
+		is checked on the FEM types and on the position of every tissue dof.
+		Solve the merged system (SuperLU, or GMRES with the block diagonal
+		preconditioner darcy_precond_av). Pa.UM and Pv.UM get the shared
+		tissue solution and their network; Pa.AM, Pa.FM, Pv.AM and Pv.FM
+		are kept.
 	 */
 	friend bool merge_and_solve (problem3d1d & Pa, problem3d1d & Pv);
 	//! Export results into vtk files
@@ -179,6 +389,8 @@ protected:
 	vector<mesh_fem> mf_coefvi;
 	//! Finite Element Method for PDE coefficients defined on the network
 	mesh_fem mf_coefv;
+	//! Lagrangian P1 Finite Element Method used to export a non-Lagrangian @f$\mathbf{u}_t@f$
+	mesh_fem mf_Ut_P1;
 
 	////////////////////////////////////////////////////////////////////
 	
@@ -190,6 +402,32 @@ protected:
 	c_descr3d1d c_descr;
 	//! Physical parameters (dimensionless)
 	param3d1d param;
+	//! On-disk cache of preprocessed geometry and coupling operators
+	cache3d1d cache;
+	//! Machine-readable run log (JSON lines)
+	metrics3d1d metrics;
+	//! Reduced model of the network (fast mode and coarse level of the preconditioner)
+	network_graph graph;
+	//! Number of inner iterations of the last linear solve (0 for direct solvers)
+	size_type inner_iterations;
+	//! Partition of the tissue domain among the MPI processes (DISTRIBUTED = 1)
+	tissue_partition partition;
+	//! True if UM holds the initial guess of the fixed point (nested iteration)
+	bool initial_guess;
+	//! Factorization of AM of the last SuperLU solve (reused by the adjoint)
+	gmm::SuperLU_factor<scalar_type> SLU_AM;
+	//! True if SLU_AM is the factorization of the current AM
+	bool factorized;
+	//! True if AM holds no tissue block (assembly_network)
+	bool network_only;
+	//! Wall time of the last assembly (for the scaling report)
+	scalar_type assembly_time;
+	//! Affine decomposition of the system in the sweep factors (assembly_sweep)
+	sweep_system sweep;
+	//! Reduced-order surrogate built on the sweep decomposition (rom_offline)
+	reduced_model rom;
+	//! Settings and storage matrix of the transient problem (assembly_transient)
+	transient_system trans;
 	//! Dimension of the tissue domain (3)
 	size_type DIMT;
 	//! Number of vertices per branch in the vessel network
@@ -227,6 +465,12 @@ protected:
 	vector_type        UM;		
 	//! Monolithic right hand side for the coupled problem
 	vector_type        FM;	
+	//! Overlap rows of the monolithic matrix (DISTRIBUTED = 1, Schwarz preconditioner)
+	sparse_matrix_type AH;
+	//! Mixed mass matrix (mf_Ut_P1, mf_Ut) of the export projection
+	sparse_matrix_type M_Ut_P1;
+	//! Factorization of the P1 mass matrix of the export projection
+	gmm::SuperLU_factor<scalar_type> SLU_Ut_P1;
 
 	////////////////////////////////////////////////////////////////////
 	
@@ -235,8 +479,20 @@ protected:
 	void import_data(void);
 	//! Import mesh for tissue (3D) and vessel (1D)  
 	void build_mesh(void); 
+	//! Import mesh for tissue (3D)
+	void build_tissue_mesh(void);
+	//! Import mesh for vessel (1D), with the boundary nodes and the branches
+	void build_network_mesh(void);
 	//! Set finite elements methods and integration methods 
 	void set_im_and_fem(void);
+	//! Set finite elements methods and integration methods of the tissue
+	void set_im_and_fem_tissue(void);
+	//! Copy the tissue mesh, its IMs and FEMs from another problem
+	void set_im_and_fem_tissue(const problem3d1d & tissue);
+	//! Set finite elements methods and integration methods of the vessel branches
+	void set_im_and_fem_network(void);
+	//! Set the FEM dimensions (after both set_im_and_fem_*)
+	void set_dof(void);
 	//! Build problem parameters
 	void build_param(void);
 	//! Build the list of tissue boundary data 
@@ -251,11 +507,55 @@ protected:
 	void build_tissue_boundary(void);
 	//! Build the list of vessel boundary (and junctions) data 
 	void build_vessel_boundary(void);
+	//! Compare the setup with a sequential one of the same problem (SETUP_CHECK = 1)
+	/*!
+		The mesh regions, the dof counts and the boundary and junction
+		lists must be the same.
+	 */
+	void check_setup(int argc, char *argv[]);
 	// Aux methods for assembly
 	//! Build the monolithic matrix AM by blocks
 	void assembly_mat(void);
 	//! Build the monolithic rhs FM by blocks
 	void assembly_rhs(void);
+	//! Elements where the tissue terms are assembled (local elements if DISTRIBUTED = 1)
+	mesh_region tissue_region(void) const;
+	//! True if the process assembles the network rows (all but the process 0 skip them if DISTRIBUTED = 1)
+	inline bool network_rows(void) const { return !descr.DISTRIBUTED || partition.root(); }
+	//! Keep the owned rows of AM (the overlap rows go to AH) and sum FM over the processes
+	void distribute_system(void);
+	//! Oncotic pressure jump on the vessel pressure dofs and branch of each dof
+	/*!
+		@f$\sigma_i(\pi_v-\pi_t)@f$, with the reflection coefficient of the
+		branch i if IMPORT_SIGMA = 1. A dof shared by several branches
+		(junction) takes the last one.
+	 */
+	void oncotic_jump(vector_type & DeltaPi, vector_size_type & branch);
+	//! Per-branch adjoint gradient of an output J with dJ/dUM = dJdU
+	/*!
+		tfr = true adds the explicit dependence of TFR on Lp and sigma.
+	 */
+	void adjoint_branch_gradient(const vector_type & dJdU, bool tfr, branch_gradient & grad);
+	//! Flow rates of the solution U (network-to-tissue, lymphatic, from the cube)
+	void compute_flow_rates(const vector_type & U,
+		scalar_type & tfr, scalar_type & frlymph, scalar_type & frcube);
+	//! Network-to-tissue flow rate of the solution U
+	scalar_type network_flow_rate(const vector_type & U);
+	//! Set AM, FM and the parameters of a parameter set of the sweep
+	void set_sweep_point(const sweep_point & p);
+	//! Solve a parameter set of the sweep and collect the flow rates
+	void solve_sweep_point(const sweep_point & p, sweep_result & r);
+	//! Build, assemble and factorize the reduced network graph (from the current AM)
+	void build_graph(void);
+	//! Build the aux exchange matrices Mbar and Mlin (loaded from the cache if available)
+	void build_exchange_aux_mat(sparse_matrix_type & Mbar, sparse_matrix_type & Mlin);
+	//! L2 projection of the interstitial velocity on mf_Ut_P1 (for export)
+	/*!
+		The mass matrices are assembled and the P1 mass matrix is factorized
+		at the first call only; later calls just do a product and two 
+		triangular solves.
+	 */
+	void project_Ut_P1(const vector_type & Ut, vector_type & Ut_P1);
 	//! Assemble RHS source term for stand-alone tissue problem
 	void assembly_tissue_test_rhs(void);
 	//!Modify the mass matrix with the contribution of lymphatic system
@@ -263,7 +563,7 @@ protected:
 	//! Solve the Fixed Point
 	vector_type iteration_solve(vector_type,vector_type);
 	//! Compute Residuals of Fixed Point Iteration
-	scalar_type calcolo_Rk(vector_type , vector_type);
+	scalar_type calcolo_Rk(const vector_type &, const vector_type &);
 	//! Compute Lymphatic Contribution
 	vector_type compute_lymphatics(vector_type);
 
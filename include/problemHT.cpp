@@ -16,6 +16,9 @@
 
 #include <problemHT.hpp>
 #include <cmath>
+#include <cstring>
+#include <queue>
+#include <sstream>
 
 namespace getfem {
 
@@ -27,14 +30,21 @@ problemHT::init(int argc, char *argv[])
 	PARAM.read_command_line(argc, argv);
 	//2. Import data (algorithm specifications, boundary conditions, ...)
 	import_data();*/ // DONE IN problemHT::HEMATOCRIT_TRANSPORT
+	// 3-6. as a task graph (see tasks3d1d.hpp): the import of meshh (file
+	// parsing) runs with the parameters; the other tasks visit the regions
+	// of meshv and are serial
+	task_graph setup;
 	//3. Import mesh vessel network (1D)
-	build_mesh();
-	//4. Set finite elements and integration methods
-	set_im_and_fem();
+	size_type mesh_h = setup.add("ht_mesh_import", [this]{ build_mesh(); });
 	//5. Build problem parameters
-	build_param();
+	size_type par = setup.add_serial("ht_build_param", [this]{ build_param(); });
+	//4. Set finite elements and integration methods
+	size_type fem_h = setup.add_serial("ht_fem_setup", [this]{ set_im_and_fem(); }, {mesh_h, par});
 	//6. Build the list of vessel boundary (and junction) data
-	build_vessel_boundary();
+	setup.add_serial("ht_build_vessel_boundary", [this]{ build_vessel_boundary(); }, {fem_h});
+	setup.run(descr.SETUP_THREADS);
+	if (mpi_rank() == 0) setup.print(cout);
+	setup.write(metrics);
 }
 bool
 problemHT::HEMATOCRIT_TRANSPORT(int argc, char *argv[])
@@ -51,9 +61,56 @@ problemHT::import_data(void)
 	cout << "Importing descriptors for hematocrit problems ..." << endl;
 	#endif
 	descrHT.import(PARAM);
+	adapt_par.import(PARAM);
+	if(descrHT.CHECKPOINT_FILE == "") descrHT.CHECKPOINT_FILE = descr.OUTPUT + "checkpoint.bin";
 	#ifdef M3D1D_VERBOSE_
 	cout << descrHT;
+	if(adapt_par.CYCLES) cout << adapt_par;
+	#endif
+}
+
+bool
+problemHT::solve_initial(void)
+{
+	if(initial_guess)
+		return true;
+	if(!RESTART())
+		return problem3d1d::solve();
+
+	cout << "Restarting from checkpoint " << descrHT.RESTART_FILE << " ..." << endl;
+	// Read once: the hematocrit state is used by solve_fixpoint
+	restart_state.load(descrHT.RESTART_FILE);
+	#ifdef M3D1D_VERBOSE_
+	cout << restart_state;
+	#endif
+	GMM_ASSERT1(restart_state.UM.size() == dof.tot(), 
+		"checkpoint " << descrHT.RESTART_FILE << " has " << restart_state.UM.size() 
+		<< " fluid dofs, expected " << dof.tot());
+	gmm::resize(UM, dof.tot());
+	gmm::copy(restart_state.UM, UM);
+	return true;
+}
+
+void
+problemHT::save_checkpoint(size_type iteration,
+	const vector_type & RES_SOL, const vector_type & RES_CM, const vector_type & RES_H)
+{
+	#ifdef M3D1D_VERBOSE_
+	cout << "Saving checkpoint to " << descrHT.CHECKPOINT_FILE << " ..." << endl;
 	#endif
+	checkpoint1dHT ckp;
+	ckp.iteration = iteration;
+	ckp.UM = UM;
+	ckp.UM_HT = UM_HT;
+	ckp.MU = MU;
+	ckp.R = param.R();
+	ckp.CSarea = param.CSarea();
+	ckp.CSper = param.CSper();
+	size_type nres = std::min(iteration, (size_type) RES_SOL.size());
+	ckp.RES_SOL.assign(RES_SOL.begin(), RES_SOL.begin() + nres);
+	ckp.RES_CM.assign(RES_CM.begin(), RES_CM.begin() + nres);
+	ckp.RES_H.assign(RES_H.begin(), RES_H.begin() + nres);
+	ckp.save(descrHT.CHECKPOINT_FILE);
 }
 
 
@@ -65,9 +122,7 @@ problemHT::build_mesh(void)
 	#endif
 	std::ifstream ifs(descrHT.MESH_FILEH);
 	GMM_ASSERT1(ifs.good(), "impossible to read from file " << descrHT.MESH_FILEH);
- 	vector_type Uv( dof.Uv()); gmm::clear(Uv);
-	gmm::copy(gmm::sub_vector(UM, gmm::sub_interval(dof.Ut()+dof.Pt(), dof.Uv())),  Uv);
-	import_pts_file_HT(ifs, meshh, BCv_HT, nb_vertices, Uv, descr.MESH_TYPEV, mimv, mf_Uvi);
+	import_pts_file_HT(ifs, meshh, BCv_HT, nb_vertices, descr.MESH_TYPEV);
 	nb_branches = nb_vertices.size();
 	ifs.close();
 }
@@ -399,11 +454,39 @@ try {
 	cout << "---------------------------------------- "   << endl;
 	#endif
 
+	// Oriented topology of the network (BC labels from the current velocity)
+	topology.build(meshh, mf_Uvi, mf_Hi, Jv_HT, BCv_HT);
+	update_topology();
+	#ifdef M3D1D_VERBOSE_
+	cout << topology;
+	#endif
+
 } 
 GMM_STANDARD_CATCH_ERROR; // catches standard errors
 
 } /* end of build_vessel_boundary */
 
+void
+problemHT::update_topology(void)
+{
+	vector_type Uv(dof.Uv());
+	gmm::copy(gmm::sub_vector(UM, gmm::sub_interval(dof.Ut()+dof.Pt(), dof.Uv())), Uv);
+	vector_type area(nb_branches);
+	for(size_type i=0; i<nb_branches; ++i){
+		scalar_type Ri = param.R(mimv, i);
+		area[i] = pi*Ri*Ri;
+	}
+	bool first = !topology.oriented();
+	size_type flips = topology.update(Uv, area);
+	// Only the branches whose velocity sign has changed are moved
+	if(first || flips>0) topology.label_boundary(BCv_HT);
+	#ifdef M3D1D_VERBOSE_
+	if(!first && flips>0)
+		cout << "  Flow direction changed in " << flips << " branches ("
+			 << topology.reversed().size() << " with flow reversal)" << endl;
+	#endif
+}
+
 //////// Assemble the problem ////////////////////////////////////////// 
 void
 problemHT::assembly(void)
@@ -433,7 +516,8 @@ problemHT::assembly_mat(void)
 	#endif
 	// Junction compatibility matrix for the hematocrit problem
 	sparse_matrix_type Jh(dofHT.H(), dofHT.H());
-	sparse_matrix_type Jvv(dof.Pv(), dofHT.H());
+	// Inflow/outflow roles of the branches from the current velocity
+	update_topology();
 
 	
 	#ifdef M3D1D_VERBOSE_
@@ -448,33 +532,40 @@ problemHT::assembly_mat(void)
 	vector_type Uv( dof.Uv()); gmm::clear(Uv);
 	gmm::copy(gmm::sub_vector(UM, gmm::sub_interval(dof.Ut()+dof.Pt(), dof.Uv())) ,  Uv);
 
-	scalar_type Theta = PARAM.real_value("THETA", "Theta Number");
-	vector_type element_size(dofHT.H());
-	scalar_type max_size=0;
-	scalar_type temp;
+	bool SUPG = (descrHT.HT_STABILIZATION == "SUPG");
+	scalar_type Diffusivity=0;
+	if(!SUPG){
+		scalar_type Theta = PARAM.real_value("THETA", "Theta Number");
+		scalar_type max_size=0;
+		scalar_type temp;
 	
-	for(dal::bv_visitor k(meshv.convex_index()); !k.finished();++k){
-		temp=meshv.convex_area_estimate(k,2);
-		if(temp>max_size) max_size=temp;
-		}
-	scalar_type max_U;
-	scalar_type max_U_positive=*max_element(Uv.begin(), Uv.end());
-	scalar_type max_U_negative=*min_element(Uv.begin(), Uv.end());
-		if(max_U_positive > fabs(max_U_negative))
-			max_U=max_U_positive;
-		else
-			max_U=fabs(max_U_negative);
+		for(dal::bv_visitor k(meshv.convex_index()); !k.finished();++k){
+			temp=meshv.convex_area_estimate(k,2);
+			if(temp>max_size) max_size=temp;
+			}
+		scalar_type max_U;
+		scalar_type max_U_positive=*max_element(Uv.begin(), Uv.end());
+		scalar_type max_U_negative=*min_element(Uv.begin(), Uv.end());
+			if(max_U_positive > fabs(max_U_negative))
+				max_U=max_U_positive;
+			else
+				max_U=fabs(max_U_negative);
 	
-	scalar_type Diffusivity=max_size*max_U*Theta;
+		Diffusivity=max_size*max_U*Theta;
 
-			#ifdef M3D1D_VERBOSE_
-		cout << "Max Element Size	  : " << max_size << endl;
-		cout << "Max Velocity    	  : " << max_U << endl;
-		cout << "Artificial Diffusivity   : " << Diffusivity << endl;
-			#endif
+				#ifdef M3D1D_VERBOSE_
+			cout << "Max Element Size	  : " << max_size << endl;
+			cout << "Max Velocity    	  : " << max_U << endl;
+			cout << "Artificial Diffusivity   : " << Diffusivity << endl;
+				#endif
+	}
 
 
 	
+	scalar_type dim = PARAM.real_value("d", "characteristic length of the problem [m]");
+	dim=dim*1E6; // unit of measure in Pries formula is micrometers
+	vector_type diameter(nb_branches);
+
 	// Local matrices
 	size_type shift_U = 0;
 	size_type shift_H = 0;
@@ -491,6 +582,7 @@ problemHT::assembly_mat(void)
 		//Obtain the radius of branch i
 		scalar_type Ri = param.R(mimv, i);
 //scalar_type Ri = param.Ri(i);
+		diameter[i] = 2.0*Ri*dim;
 		vector_type R_veci(mf_coefvi[i].nb_dof(),Ri);
 		//Obtain the flow in the branch i
 		gmm::scale(Uvi,pi*Ri*Ri);
@@ -512,6 +604,12 @@ problemHT::assembly_mat(void)
 		// Build Dhi
 
 		vector_type diff(mf_coefvi[i].nb_dof(),Diffusivity);
+		if(SUPG){
+			// Uvi is already scaled by the area: the velocity is recovered
+			vector_type Ui(Uvi); gmm::scale(Ui, 1.0/(pi*Ri*Ri));
+			asm_hematocrit_supg_coef(diff, mf_coefvi[i], mf_Uvi[i], Ui, pi*Ri*Ri, descrHT.HT_DIFFUSIVITY, i);
+		}
+		else
 		gmm::scale(diff,pi*Ri*Ri);
 		asm_network_artificial_diffusion (Dhi, mimv, mf_Hi[i], mf_coefvi[i], diff, meshv.region(i));
 		// Copy Bhi and Dhi
@@ -533,15 +631,12 @@ problemHT::assembly_mat(void)
 
 	} /* end of branches loop */
 
-		asm_HT_out(AM_HT, mimv, mf_Hi, Uv, param.R(), mf_Uvi, mf_coefv);
+		asm_HT_out(AM_HT, topology);
 
 			#ifdef M3D1D_VERBOSE_
 		cout << "Assembling Hematocrit Junctions..."<< endl;
 			#endif
-		scalar_type dim = PARAM.real_value("d", "characteristic length of the problem [m]");
-		dim=dim*1E6; // unit of measure in Pries formula is micrometers
-
-		asm_hematocrit_junctions(Jvv, Jh,Uv, mimv,mf_Hi, mf_Pv, mf_Uvi,mf_coefv, Jv_HT, param.R(),UM_HT,dim, AM_HT);
+		asm_hematocrit_junctions(Jh, topology, diameter, UM_HT);
  
 		// Copy Jh
 		gmm::add(Jh,AM_HT);
@@ -611,38 +706,162 @@ problemHT::iteration_solve(vector_type U_O,vector_type F_N){
 
 }
 
-scalar_type
-problemHT::calcolo_Rk(vector_type U_N, vector_type U_O){
-
-// The residual is computed as ||V(k)-V(k-1)||/||V(k-1)|| with ||V(k)|| Eucledian norm
-
-	vector_type Sol_old(dofHT.H()); // H(k-1) 
-	vector_type Sol_new(dofHT.H());
-	scalar_type R_H, N_H;
-	scalar_type residual;
-	//obtain H(k-1)
-	gmm::copy(U_O,Sol_old);
-	//obtain H(k)
-	gmm::copy(U_N,Sol_new);
+vector_type
+problemHT::solve_hematocrit(vector_type H_O)
+{
+	if(descrHT.HEMATOCRIT_SOLVER == "SWEEP"){
+		vector_type H_new;
+		if(hematocrit_sweep(H_new)){
+			//UNDER-RELAXATION
+			scalar_type alfa=descrHT.underH;
+			if(alfa!=1){
+			gmm::scale(H_new,alfa);
+			gmm::add(gmm::scaled(H_O,1-alfa),H_new);}
+			return H_new;
+		}
+		cout << "  Upwind sweep not applicable (flow cycle): solving the hematocrit FEM system" << endl;
+	}
+	assembly();
+	return iteration_solve(H_O, FM_HT);
+}
 
-	gmm::scale(Sol_old, -1.0);
+bool
+problemHT::hematocrit_sweep(vector_type & H)
+{
+	#ifdef M3D1D_VERBOSE_
+	cout << "Solving the hematocrit problem by upwind sweep ... " << endl;
+	#endif
+	gmm::resize(H, dofHT.H()); gmm::clear(H);
 
-	gmm::add(Sol_old, Sol_new);
+	scalar_type dim = PARAM.real_value("d", "characteristic length of the problem [m]");
+	dim=dim*1E6; // unit of measure in Pries formula is micrometers
 
-	R_H=gmm::vect_norm2(Sol_new);
+	// 1. Flow rate at the hematocrit dofs of each branch
+	vector<vector_type> Qi(nb_branches);
+	vector_type Di(nb_branches);
+	size_type shift_U = 0;
+	scalar_type max_Q = 0.0;
+	for(size_type i=0; i<nb_branches; ++i){
+		if(i>0) shift_U += mf_Uvi[i-1].nb_dof();
+		vector_type Uvi(mf_Uvi[i].nb_dof());
+		gmm::copy(gmm::sub_vector(UM, 
+			gmm::sub_interval(dof.Ut()+dof.Pt()+shift_U, mf_Uvi[i].nb_dof())), Uvi);
+		scalar_type Ri = param.R(mimv, i);
+		Di[i] = 2.0*Ri*dim;
+		gmm::resize(Qi[i], mf_Hi[i].nb_dof());
+		getfem::interpolation(mf_Uvi[i], mf_Hi[i], Uvi, Qi[i]);
+		gmm::scale(Qi[i], pi*Ri*Ri);
+		// The flow must not reverse inside a branch
+		scalar_type Qmin = *std::min_element(Qi[i].begin(), Qi[i].end());
+		scalar_type Qmax = *std::max_element(Qi[i].begin(), Qi[i].end());
+		if(Qmin < 0 && Qmax > 0) return false;
+		max_Q = std::max(max_Q, std::max(Qmax, -Qmin));
+	}
+	scalar_type eps_Q = 1.0E-12*max_Q; // stagnant flow threshold
+
+	// 2. Oriented graph from the network topology
+	update_topology();
+	if(!topology.reversed().empty()) return false;
+	size_type nb_jun = topology.nb_junctions();
+	size_type nb_nodes = topology.nb_nodes();
+	for(size_type i=0; i<nb_branches; ++i)
+		if(topology.node_of(i,0)==network_topology::none || 
+		   topology.node_of(i,1)==network_topology::none) return false;
+	vector_size_type nb_in(nb_nodes);
+	for(size_type n=0; n<nb_nodes; ++n) nb_in[n] = topology.nb_in(n);
+
+	// 3. Sweep in topological order (Kahn's algorithm)
+	// Flow rate at the upstream and downstream end of branch i
+	auto h_up   = [&](size_type i){ return topology.h_dof(i, topology.forward(i) ? 0 : 1) - topology.h_shift(i); };
+	auto h_down = [&](size_type i){ return topology.h_dof(i, topology.forward(i) ? 1 : 0) - topology.h_shift(i); };
+	auto Q_up   = [&](size_type i){ return fabs(Qi[i][h_up(i)]); };
+	auto Q_down = [&](size_type i){ return fabs(Qi[i][h_down(i)]); };
+	vector_type F(nb_branches, 0.0); // RBC flux of each branch
+	std::queue<size_type> ready;
+	for(size_type n=0; n<nb_nodes; ++n)
+		if(nb_in[n]==0) ready.push(n);
+	size_type nb_done = 0;
+	while(!ready.empty()){
+		size_type n = ready.front(); ready.pop();
+		size_type nb_out = topology.nb_out(n);
+		if(nb_out==0) continue;
+		// Inflow hematocrit and RBC flux of the node
+		scalar_type H_f = 0.0, F_in = 0.0, Q_in = 0.0;
+		if(topology.is_boundary(n)){ 
+			const node & bc = BCv_HT[topology.boundary_index(n)];
+			if(bc.label!="DIR" && bc.label!="MIX") return false;
+			H_f = bc.value;
+			for(size_type k=0; k<nb_out; ++k) F_in += H_f*Q_up(topology.out_branch(n,k));
+		}
+		else {
+			for(size_type k=0; k<topology.nb_in(n); ++k){
+				F_in += F[topology.in_branch(n,k)];
+				Q_in += Q_down(topology.in_branch(n,k));
+			}
+			H_f = (Q_in > eps_Q) ? F_in/Q_in : 0.0;
+		}
+		// Split the RBC flux among the outflow branches
+		scalar_type Q_out = 0.0;
+		for(size_type k=0; k<nb_out; ++k) Q_out += Q_up(topology.out_branch(n,k));
+		if(n < nb_jun && nb_out==2 && topology.nb_in(n)==1 && Q_in > eps_Q){
+			// Bifurcation: phase separation (Pries et al 2005)
+			size_type father = topology.in_branch(n,0);
+			size_type d0 = topology.out_branch(n,0), d1 = topology.out_branch(n,1);
+			scalar_type FQB = Q_up(d0)/Q_in;
+			scalar_type FQE = fractional_Erythrocytes(FQB, Di[father], Di[d0], Di[d1], H_f);
+			F[d0] = FQE*F_in;
+			F[d1] = F_in - F[d0]; // RBCs are conserved
+		}
+		else
+			for(size_type k=0; k<nb_out; ++k){
+				size_type b = topology.out_branch(n,k);
+				F[b] = (Q_out > eps_Q) ? F_in*Q_up(b)/Q_out : 0.0;
+			}
+		// The RBC flux is constant along the branch
+		for(size_type k=0; k<nb_out; ++k){
+			size_type b = topology.out_branch(n,k);
+			for(size_type d=0; d<mf_Hi[b].nb_dof(); ++d){
+				scalar_type Q = fabs(Qi[b][d]);
+				H[topology.h_shift(b)+d] = (Q > eps_Q) ? F[b]/Q : H_f;
+			}
+			nb_done++;
+			if(--nb_in[topology.downstream(b)] == 0) ready.push(topology.downstream(b));
+		}
+	}
+	// Some branches were not reached: the oriented network has a cycle
+	return nb_done == nb_branches;
+}
 
-	N_H=gmm::vect_norm2(Sol_old);
-	
-	residual=R_H/N_H;
+scalar_type
+problemHT::calcolo_Rk(const vector_type & U_N, const vector_type & U_O){
 
+// The residual is computed as ||V(k)-V(k-1)||/||V(k-1)|| with ||V(k)|| Eucledian norm
 
-	return residual; // gives if residual is bigger than the max value given in input 
+	residual_norms res({dofHT.H()});
+	accumulate_residual(U_N, U_O, res);
 
+	return res.relative(0); // gives if residual is bigger than the max value given in input 
 
 }
+void
+problemHT::set_initial_guess(problemHT & coarse)
+{
+	problem3d1d::set_initial_guess(coarse);
+	coarse_state = checkpoint1dHT();
+	coarse_state.UM = UM;
+	coarse_state.UM_HT = coarse.UM_HT;
+	coarse_state.MU = coarse.MU;
+	if(COMPLIANT_VESSELS()){
+		coarse_state.R = coarse.param.R();
+		coarse_state.CSarea = coarse.param.CSarea();
+		coarse_state.CSper = coarse.param.CSper();
+	}
+}
+
 bool
 problemHT::solve_fixpoint(void)
 {
+	GMM_ASSERT1(!descr.DISTRIBUTED, "the fixed point method is not available with DISTRIBUTED = 1");
 /*solver 
 1- Declaration of variables
 2- Save the constant matrices (that don't change during the iterative process)
@@ -688,8 +907,10 @@ problemHT::solve_fixpoint(void)
 	int iteration_save=descr.Save_it;
 	int iteration=0;
 	bool RK=1;
-	clock_t t;
-	clock_t time_G;
+	scalar_type t;      // wall time of the fluid solve [s]
+	scalar_type t_it;   // wall time of the whole outer iteration [s]
+	scalar_type t_H;    // wall time of the hematocrit assembly and solve [s]
+	scalar_type time_G; // wall time of the whole fixed point [s]
 	vector_type F_LF; gmm::resize(F_LF, dof.Pt());
 	vector_type Uphi(dof.Pv()); 
 	//sparse_matrix_type Bvt(dof.Pv(), dof.Pt());
@@ -712,7 +933,6 @@ problemHT::solve_fixpoint(void)
 	gmm::resize(DeltaPi, dof.Pv()); gmm::clear(DeltaPi);
         vector_type auxOSt(dof.Pt());
         vector_type auxOSv(dof.Pv());
-        vector_type auxCM(dof.Pt()); gmm::clear(auxCM);
 	//Gnuplot gp;
 	vector_type RES_SOL(max_iteration), RES_CM(max_iteration);
 
@@ -724,7 +944,38 @@ problemHT::solve_fixpoint(void)
 	scalar_type mu_plasma=paramHT.visco_plasma();
 	int visco_v=paramHT.visco_type();
 	scalar_type mu_start = PARAM.real_value("mu_v", "blood viscosity [kg/ms]"); 
+	if(descrHT.RHEOLOGY_TABLE && !rheo_table.built()){
+		scalar_type t0 = metrics3d1d::wall_time();
+		// Diameter range of the network, with a margin for compliant vessels
+		scalar_type Rmin = *std::min_element(param.R().begin(), param.R().end());
+		scalar_type Rmax = *std::max_element(param.R().begin(), param.R().end());
+		rheo_table.build(visco_v==0, Rmin*dim, 4.0*Rmax*dim, 
+			descrHT.RHEOLOGY_TABLE_TOL, descrHT.RHEOLOGY_TABLE_SIZE);
+		metrics.phase("rheology_tables", t0);
+		cout << rheo_table;
+		if(descrHT.RHEOLOGY_TABLE_VALIDATE)
+			rheo_table.validate(cout);
+	}
+	set_rheology_table(descrHT.RHEOLOGY_TABLE ? &rheo_table : nullptr);
 	vector_type RES_H(max_iteration);
+	// Offsets of the branches in H and in Uv
+	vector_size_type shift_Hi(nb_branches, 0), shift_Uvi(nb_branches, 0);
+	for(size_type i=1; i<nb_branches; ++i){
+		shift_Hi[i]  = shift_Hi[i-1]  + mf_Hi[i-1].nb_dof();
+		shift_Uvi[i] = shift_Uvi[i-1] + mf_Uvi[i-1].nb_dof();
+	}
+	// Coefficient dofs of the elements of each branch, on mf_coefv (el_coef)
+	// and on mf_coefvi[i] (el_coefi), in the order of the region: the
+	// regions are visited once, not at each iteration
+	vector_size_type shift_el(nb_branches+1, 0), el_coef, el_coefi;
+	for(size_type i=0; i<nb_branches; ++i){
+		for (getfem::mr_visitor mrv(mf_coefv.linked_mesh().region(i)); !mrv.finished(); ++mrv)
+			for (auto j : mf_coefv.ind_basic_dof_of_element(mrv.cv())){
+				el_coef.push_back(j);
+				el_coefi.push_back(mf_coefvi[i].ind_basic_dof_of_element(mrv.cv())[0]);
+			}
+		shift_el[i+1] = el_coef.size();
+	}
 	scalar_type epsH=descrHT.epsH;
 	scalar_type resH=epsH*100;
 // 2 - Saving the constant matrices
@@ -759,7 +1010,7 @@ problemHT::solve_fixpoint(void)
 	*/
 	sparse_matrix_type Mbar(dof.Pv(), dof.Pt());
 	sparse_matrix_type Mlin(dof.Pv(), dof.Pt());
-	asm_exchange_aux_mat(Mbar, Mlin, mimv, mf_Pt, mf_Pv, param.R(), descr.NInt);
+	build_exchange_aux_mat(Mbar, Mlin);
 	//Extracting Mvv_kv
 	#ifdef M3D1D_VERBOSE_
 	cout << "  Assembling Mvv0 in FixPoint Hematocrit..." << endl;
@@ -826,19 +1077,63 @@ problemHT::solve_fixpoint(void)
 	std::ofstream SaveResidual;
 	SaveResidual.open(descr.OUTPUT+"Residuals.txt");
 	SaveResidual << "Iteration" << "\t" << "Solution Residual" << "\t" << "Mass Conservation Residual" << "\t" << "Hematocrit Residual" << endl;
+	std::ofstream SaveBalance;
+	SaveBalance.open(descr.OUTPUT+"JunctionBalance.txt");
+	SaveBalance << "Iteration" << "\t" << "RBC Imbalance" << "\t" << "Plasma Imbalance" << "\t" 
+		<< "RBC Inflow" << "\t" << "RBC Outflow" << "\t" << "Worst Junctions (index:relative RBC imbalance)" << endl;
+	flux_balance balance;
 	gmm::copy(UM,U_old);
 
-	time_G=clock();
-
+	time_G=metrics3d1d::wall_time();
+
+	if(RESTART() || initial_guess){
+// 3 - Get the initial guess H0 from the checkpoint or from the coarse level
+//     (UM has been restored by solve_initial or set by set_initial_guess)
+	GMM_ASSERT1(initial_guess || restart_state.UM.size() == dof.tot(),
+		"solve_fixpoint: call solve_initial first to read the checkpoint " << descrHT.RESTART_FILE);
+	const checkpoint1dHT & ckp = initial_guess ? coarse_state : restart_state;
+	GMM_ASSERT1(ckp.UM_HT.size() == dofHT.H() && ckp.MU.size() == mf_coefv.nb_dof(),
+		"checkpoint " << (initial_guess ? "of the coarse level" : descrHT.RESTART_FILE) 
+		<< " does not match the hematocrit problem size");
+	gmm::resize(UM_HT, dofHT.H());
+	gmm::copy(ckp.UM_HT, UM_HT);
+	MU = ckp.MU;
+	if(COMPLIANT_VESSELS()){
+		// Radii are part of the state only for compliant vessels
+		GMM_ASSERT1(ckp.R.size() == param.R().size(), 
+			"checkpoint " << descrHT.RESTART_FILE << " does not match the network size");
+		gmm::copy(ckp.R, param.R());
+		param.replace_area(ckp.CSarea);
+		param.replace_per(ckp.CSper);
+	}
+	iteration = ckp.iteration;
+	for(size_type k=0; k<ckp.RES_SOL.size() && k<max_iteration; ++k){
+		RES_SOL[k] = ckp.RES_SOL[k];
+		RES_CM[k]  = ckp.RES_CM[k];
+		RES_H[k]   = ckp.RES_H[k];
+		SaveResidual << k+1 << "\t" << RES_SOL[k] << "\t" << RES_CM[k] << "\t" << RES_H[k] << endl;
+	}
+	if(initial_guess)
+		cout << "Fixed point method started from the coarse level" << endl;
+	else
+		cout << "Fixed point method restarted at iteration " << iteration << endl;
+	initial_guess = false;
+	restart_state = checkpoint1dHT();
+	}
+	else {
 	scalar_type H_start = PARAM.real_value("H_START", "hematocrit start");
 	gmm::resize(UM_HT,dofHT.H()); gmm::clear(UM_HT);
 	vector_type ones_H(dofHT.H(),1.00);
 	gmm::add(ones_H, UM_HT);
 	gmm::scale(UM_HT,H_start);	
 
+// 3 - Get the initial guess H0
+	vector_type H_sweep;
+	if(descrHT.HEMATOCRIT_SOLVER == "SWEEP" && hematocrit_sweep(H_sweep))
+		gmm::copy(H_sweep, UM_HT);
+	else {
 		assembly(); // qui fa Jvv e Jh con assemply_mat ma Jvv non la tiene
 
-// 3 - Get the initial guess H0
 	#ifdef M3D1D_VERBOSE_
 	cout << "Solving the hematocrit system ... " << endl;
 	#endif
@@ -849,15 +1144,18 @@ problemHT::solve_fixpoint(void)
 	scalar_type cond;
 	//Solving with SuperLU method
 	gmm::SuperLU_solve(A_HT, UM_HT, FM_HT, cond);
+	}
 
 	#ifdef M3D1D_VERBOSE_
 	cout << "Solved the initial guess for hematocrit" << endl;
 	#endif
+	}
 
 	gmm::copy(UM_HT,H_old);
 //4- Iterative Process
 while(RK && iteration < max_iteration)
 	{	
+	t_it=metrics3d1d::wall_time();
 	// Pulizia della matrice AM
 	/*
 	gmm::clear(gmm::sub_matrix(AM,     //COSì TOLGO SIA Dvv	CHE Jvv
@@ -880,122 +1178,57 @@ while(RK && iteration < max_iteration)
 	#ifdef M3D1D_VERBOSE_
 	cout << "Computing Viscosity - Iteration "<< iteration << "..." << endl;
 	#endif
-		shift = 0;
-		size_type shift_h=0;
-		scalar_type shift_coef=0;
-		gmm::clear(MU); gmm::resize(MU, mf_coefv.nb_dof());
-	for(size_type i=0; i<nb_branches; ++i){
-
-		vector_type Hi(mf_Hi[i].nb_dof());
-		vector_type H_const(mf_coefvi[i].nb_dof());
-		scalar_type Ri = param.R(mimv, i);
-		vector_type mui; gmm::clear(mui);
-
-
-		if(i>0) shift_h += mf_Hi[i-1].nb_dof();
-		if(i>0) shift_coef += mf_coefvi[i-1].nb_dof();
-		if(i>0) shift += mf_Uvi[i-1].nb_dof();
-
-
-		gmm::copy(gmm::sub_vector(H_old, 
-			gmm::sub_interval(shift_h, mf_Hi[i].nb_dof())), Hi);
-
-// cout << "-------- inizia interpolation" << endl;
-		getfem::interpolation(mf_Hi[i], mf_coefvi[i], Hi, H_const, 0);
-
-
-		switch(visco_v)
-				{
-				 case(0):{ //cout << "-------- case 0 " << endl;
-					for (auto h : H_const)
-						{
-							if(h==0)
-							{mui.emplace_back(mu_plasma);
-				// cout << "-------- case 0  ---- h==0 " << endl;
-							}
-							else
-							{mui.emplace_back(viscosity_vivo(h, Ri*dim, mu_plasma));
-				// cout << "-------- case 0  ---- h!=0 " << endl;
-				// cout << "-------- mui  ---- h!=0 "<< mui << endl; 
-							}
-						}
-					}break;
-				 case(1):{ //cout << "-------- case 1 " << endl;
-
-					for (auto h : H_const)
-						{
-							if(h==0)
-							mui.emplace_back(mu_plasma);
-							else
-							mui.emplace_back(viscosity_vitro(h, Ri*dim, mu_plasma));
-						}
-						}break;
-				default:
-					cerr << "Invalid value for Visco_v " << visco_v << endl;
-				}
-// cout << "-------- end switch " << endl;
-			size_type pos=0;
-			for (getfem::mr_visitor mrv(mf_coefv.linked_mesh().region(i)); !mrv.finished(); ++mrv)
-				for (auto muu : mf_coefv.ind_basic_dof_of_element(mrv.cv()))
-					{
-					MU[muu] = mui[pos];
-					pos++;}
+	{
+		// Hematocrit and diameter [um] on the coefficient dofs
+		vector_type H_coef(mf_coefv.nb_dof()), D_coef(mf_coefv.nb_dof());
+		for(size_type i=0; i<nb_branches; ++i){
+			vector_type Hi(mf_Hi[i].nb_dof());
+			vector_type H_const(mf_coefvi[i].nb_dof());
+			scalar_type Ri = param.R(mimv, i);
+			gmm::copy(gmm::sub_vector(H_old, 
+				gmm::sub_interval(shift_Hi[i], mf_Hi[i].nb_dof())), Hi);
+			getfem::interpolation(mf_Hi[i], mf_coefvi[i], Hi, H_const, 0);
+			for(size_type k=shift_el[i]; k<shift_el[i+1]; ++k){
+				H_coef[el_coef[k]] = H_const[k-shift_el[i]];
+				D_coef[el_coef[k]] = 2.0*Ri*dim;
+			}
+		}
+		GMM_ASSERT1(visco_v==0 || visco_v==1, "Invalid value for Visco_v " << visco_v);
+		// The diameter-only terms change only with the radius (compliant vessels)
+		if(visco_terms.D != D_coef || visco_terms.in_vivo != (visco_v==0))
+			visco_terms.build(D_coef, visco_v==0);
+		viscosity_batch(visco_terms, H_coef, mu_plasma, MU);
+	}
 
 //b-modify the mass matrix for fluid dynamic problem
 	#ifdef M3D1D_VERBOSE_
 	cout << "Modify Mvvk - Iteration "<< iteration << "..." << endl;
 	#endif
-                scalar_type kvi = param.kv(mimv, i);
-                scalar_type Lpi=Lp;
-                if(IMPORT_LP)  Lpi = param.Lp(mimv, i);
-                std::cout << Lpi << std::endl;
-//                 scalar_type kvi = param.kv(mimv, i);
+	// Branch means of the radius and of the conductivities
+	vector_type R_br(nb_branches), kv_br(nb_branches), Lp_br(nb_branches, Lp);
+	for(size_type i=0; i<nb_branches; ++i){
+		R_br[i]  = param.R(mimv, i);
+		kv_br[i] = param.kv(mimv, i);
+		if(IMPORT_LP) Lp_br[i] = param.Lp(mimv, i);
+	}
+	// Assembly of each branch and scatter in the monolithic matrix
+	for(size_type i=0; i<nb_branches; ++i){
+		size_type shift = shift_Uvi[i];
 		// Coefficient \pi^2*Ri'^4/\kappa_v
-		vector_type ciM(mf_coefvi[i].nb_dof()); //gmm::clear(ci);
+		// works only for P0 coefficients
+		vector_type ciM(mf_coefvi[i].nb_dof());
 		vector_type ciD(mf_coefvi[i].nb_dof());
-		for (getfem::mr_visitor mrv(mf_coefv.linked_mesh().region(i)); !mrv.finished(); ++mrv){
-			for (auto j : mf_coefv.ind_basic_dof_of_element(mrv.cv())){
+		for(size_type k=shift_el[i]; k<shift_el[i+1]; ++k){
+			size_type j = el_coef[k], ji = el_coefi[k];
 			scalar_type area_el = param.CSarea(j);
-			scalar_type per_el = param.CSper(j);
-			// works only for P0 coefficients
-			ciM[mf_coefvi[i].ind_basic_dof_of_element(mrv.cv())[0]] = area_el * area_el / kvi * (1.0 + param.Curv(i, j)*param.Curv(i, j)*Ri*Ri) / mu_start * mui[j];
-			ciD[mf_coefvi[i].ind_basic_dof_of_element(mrv.cv())[0]] = area_el;
-			Q_rvar[j] = per_el * Lpi *P_ /U_;
-			//cout << "area_el   "<< area_el << "    ramo  " << i << endl;
-			//cout << " Q_rvar["<<j<<"] = "<< Q_rvar[j]<<endl;
-			}
-		}
-
-
-		/*
-		for(size_type j=0; j<mf_coefvi[i].nb_dof();j++)
-			{
-			scalar_type area_el = param.CSarea(shift_coef + j);
-			ciM[j] = area_el * area_el / kvi * (1.0 + param.Curv(i, j)*param.Curv(i, j)*Ri*Ri) / mu_start * mui[j];
-			//cout << "area_el   "<< area_el << "ramo  " << i << endl;
-			ciD[j] = area_el;
-			// già che ci sono mi creo il vettore le matrici B, che usano il perimetro
-			scalar_type per_el = param.CSarea(shift_coef +j);
-			Q_rvar[shift_coef + j]=per_el * Lp;
-			//cout << " Q_rvar["<<shift_coef+j<<"] = "<< Q_rvar[shift_coef+j]<<endl;
-			//ci[j]=pi*pi*Ri*Ri*Ri*Ri/kvi*(1.0+param.Curv(i,j)*param.Curv(i,j)*Ri*Ri)/mu_start*mui[j];
-// cout << "-------- ci  "<<ci[j]<< " ";
-// 			cout<<" Ri"<<Ri;
-// 			cout<<" kvi"<<kvi;
-// 			cout<<" curv"<<param.Curv(i,j)<<endl;
-// 	cout << "mu_start" << mu_start << endl;
-// cout << "mui[j]" <<mui[j] << endl;
+			ciM[ji] = area_el * area_el / kv_br[i] * (1.0 + param.Curv(i, ji)*param.Curv(i, ji)*R_br[i]*R_br[i]) / mu_start * MU[j];
+			ciD[ji] = area_el;
+			Q_rvar[j] = param.CSper(j) * Lp_br[i] *P_ /U_;
 		}
-		*/
-// 		cout<<"\n\n\n ci="<<ci[0]<<"    u="<<3.5/ci[0]*pi*Ri*Ri<<"\n\n\n";
-		// Allocate temp local matrices
-// cout << "-------- entra Mvv_mui "<< endl;
 		sparse_matrix_type Mvv_mui(mf_Uvi[i].nb_dof(), mf_Uvi[i].nb_dof());
 		sparse_matrix_type Dvvi(dof.Pv(), mf_Uvi[i].nb_dof());
 		// Build Mvv_mui
-// cout << "-------- entra netw_pois "<< endl;		
 		asm_network_poiseuille_rvar(Mvv_mui, Dvvi, mimv, mf_Uvi[i], mf_Pv, mf_coefvi[i], ciM, ciD, param.lambdax(i), param.lambday(i), param.lambdaz(i), meshv.region(i));
-		//asm_network_poiseuilleHT(Mvv_mui, mimv, mf_Uvi[i], mf_coefvi[i], ci, meshv.region(i));
 		// Copy Mvv_mui in Mvv_mu
 		gmm::add(Mvv_mui, 
 			gmm::sub_matrix(Mvv_mu, 
@@ -1099,11 +1332,11 @@ while(RK && iteration < max_iteration)
 	cout << "Solving the fluid dynamic problem - Iteration "<< iteration << "..." << endl;
 	#endif
 
-	t=clock();
+	t=metrics3d1d::wall_time();
 
 	U_new=problem3d1d::iteration_solve(U_old,F_new);
 	gmm::copy(U_new,UM);
-	t=clock()-t;
+	t=metrics3d1d::wall_time()-t;
 	cout << " errore 3 "<< endl;
 
 //e-1 find the new solution for hematocrit as AM_HT *H(k+1) = F(k)
@@ -1111,8 +1344,9 @@ while(RK && iteration < max_iteration)
 	#ifdef M3D1D_VERBOSE_
 	cout << "Solving the hematocrit problem - Iteration "<< iteration << "..." << endl;
 	#endif
-		assembly();
-		H_new=iteration_solve(H_old, FM_HT);
+		t_H=metrics3d1d::wall_time();
+		H_new=solve_hematocrit(H_old);
+		t_H=metrics3d1d::wall_time()-t_H;
 	cout << " errore 4 "<< endl;
 //f-compute TFR
 //g-compute lymphatic total flow rate
@@ -1180,24 +1414,22 @@ while(RK && iteration < max_iteration)
 	cout << "Checking Residuals - Iteration "<< iteration << "..." << endl;
 	#endif
 
-	//Solution residual
-			resSol=problem3d1d::calcolo_Rk(U_new, U_old);
+	//Solution and conservation of mass residuals: one pass over U_new, U_old
+	//and the tissue rows of AM (sum of AM(Pt,:)*U_new + auxOSt)
+			residual_norms resU({dof.Ut(), dof.Pt(), dof.Uv(), dof.Pv()});
+			accumulate_residual(U_new, U_old, AM, dof.Ut(), dof.Pt(), auxOSt, resU);
+			resSol=resU.sum_relative();
+	//RBC and plasma flux balance at the junctions (topology updated with U_new)
+			network_balance(topology, H_new, balance);
 	//Hematocrit residual
+			if(descrHT.HEMATOCRIT_CONVERGENCE == "BALANCE")
+			resH=balance.global_rbc;
+			else
 			resH=calcolo_Rk(H_new,H_old);
-	//Conservation of mass residual
-			gmm::mult(gmm::sub_matrix(AM, 
-						gmm::sub_interval(dof.Ut(), dof.Pt()),
-						gmm::sub_interval(0, dof.tot())),
-						U_new,
-							auxCM);
-			gmm::add(auxOSt,auxCM);
-
-			if(!LINEAR_LYMPH())
-			gmm::add(F_LF,auxCM);
-
+	//Conservation of mass residual (the lymphatic flow rate is FRlymph)
 			scalar_type resCM=0;	
 			if(TFR!=0)	
-			resCM=std::accumulate(auxCM.begin(), auxCM.end(), 0.0)/TFR;
+			resCM=(resU.mass + (LINEAR_LYMPH() ? 0.0 : FRlymph))/TFR;
 
 	RK=resSol>epsSol || fabs(resCM) > epsCM || resH > epsH; // all the residual must reach convergence to exit the "while"
 
@@ -1205,10 +1437,26 @@ while(RK && iteration < max_iteration)
 
 	//Saving residual values in an output file
 	SaveResidual << iteration << "\t" << resSol << "\t" << resCM << "\t" << resH << endl;
+	vector_size_type worst = balance.worst(descrHT.BALANCE_WORST);
+	SaveBalance << iteration << "\t" << balance.global_rbc << "\t" << balance.global_plasma << "\t"
+		<< balance.rbc_in << "\t" << balance.rbc_out;
+	for(auto n : worst) SaveBalance << "\t" << n << ":" << balance.rel_rbc[n];
+	SaveBalance << endl;
+	if (metrics.enabled()) {
+		metrics_record rec("iteration");
+		rec.add("iteration", iteration).add("res_sol", resSol).add("res_cm", resCM)
+		   .add("res_h", resH).add("TFR", TFR).add("FRlymph", FRlymph).add("FRCube", FRCube)
+		   .add("fluid_solve_s", t).add("inner_iterations", problem3d1d::inner_iterations)
+		   .add("hematocrit_s", t_H).add("iteration_s", metrics3d1d::wall_time()-t_it)
+		   .add("rbc_imbalance", balance.global_rbc).add("plasma_imbalance", balance.global_plasma);
+		if(!worst.empty())
+			rec.add("worst_junction", worst[0]).add("worst_rbc_imbalance", balance.rel_rbc[worst[0]]);
+		metrics.write(rec);
+	}
 
 			if(print_res)  {
 			cout << "\nStep n°:" << iteration << "\nSolution Residual = " << resSol << "\nMass Residual = " << fabs(resCM) << "\nHematocrit Residual "<< resH << endl;
-			cout << "\t\t\t\tTime: " <<  ((float)t)/CLOCKS_PER_SEC << " s "<< endl;
+			cout << "\t\t\t\tTime: " <<  t << " s "<< endl;
 					}
 			cout << "********************************************************" << endl;
 
@@ -1226,6 +1474,10 @@ while(RK && iteration < max_iteration)
 	RES_SOL[iteration-1]=fabs(resSol);
 	RES_CM[iteration-1]=fabs(resCM);
 	RES_H[iteration-1]=fabs(resH);
+
+	//Saving the state of the method every CHECKPOINT_ITERATION iterations
+	if(descrHT.CHECKPOINT_IT > 0 && (iteration % descrHT.CHECKPOINT_IT) == 0)
+		save_checkpoint(iteration, RES_SOL, RES_CM, RES_H);
 	/*gp << "set logscale y; set xlabel 'iteration';set ylabel 'residual'; plot '-' w lines title 'Solution Residual', '-' w lines title 'Mass Conservation Residual','-' w lines title 'Hematocrit Residual'\n";
 
 	gp.send1d(RES_SOL);
@@ -1235,14 +1487,18 @@ while(RK && iteration < max_iteration)
 
 	//De-allocate memory
 	gmm::clear(F_LF);
-	gmm::clear(U_new); gmm::clear(auxCM); gmm::clear(F_new); gmm::clear(H_new);
+	gmm::clear(U_new); gmm::clear(F_new); gmm::clear(H_new);
 	} //Exit the while
 	
 	gmm::copy(U_old,UM);
+	//Saving the final state (e.g. to warm-start a new simulation)
+	if(descrHT.CHECKPOINT_IT > 0)
+		save_checkpoint(iteration, RES_SOL, RES_CM, RES_H);
 
-	time_G=clock()-time_G;
-	cout<< "Iterative Process Time = " << ((float)time_G)/CLOCKS_PER_SEC << " s"<< endl;
+	time_G=metrics.phase("fixpoint", time_G);
+	cout<< "Iterative Process Time = " << time_G << " s"<< endl;
 	SaveResidual.close();
+	SaveBalance.close();
 	if(RK)
 		cout << "The method has NOT reached convergence for minimum residual" << endl;
 
@@ -1274,6 +1530,9 @@ while(RK && iteration < max_iteration)
 	gmm::clear(auxOSt);
 	gmm::clear(auxOSv);
 
+	if(descrHT.EXPORT_SEGMENTS)
+		export_segments();
+
 return true;
 }
 
@@ -1286,6 +1545,7 @@ problemHT::export_vtk(const string & suff) //ODIFCA
 	#ifdef M3D1D_VERBOSE_
 	cout << "Exporting the solution (vtk format) to " << descr.OUTPUT << " ..." << endl;
 	#endif
+	scalar_type t0 = metrics3d1d::wall_time();
 	 
 	#ifdef M3D1D_VERBOSE_
 	cout << "  Exporting Ht ..." << endl;
@@ -1308,6 +1568,7 @@ problemHT::export_vtk(const string & suff) //ODIFCA
 	expMU.exporting(mf_coefv);
 	expMU.write_mesh();
 	expMU.write_point_data(mf_coefv, MU, "mu");
+	metrics.phase("ht_export", t0);
 
 	#ifdef M3D1D_VERBOSE_
 	cout << "... export done, visualize the data file with (for example) Paraview " << endl; 
@@ -1316,6 +1577,160 @@ problemHT::export_vtk(const string & suff) //ODIFCA
   }
 } /* end of export_vtk */
 
+////////// Export network results as a columnar table //////////////////
+void
+problemHT::export_segments(const string & suff)
+{
+	#ifdef M3D1D_VERBOSE_
+	cout << "Exporting the network results (columnar binary) to " << descr.OUTPUT << " ..." << endl;
+	#endif
+	// Extracting solutions Pt, Uv, Pv
+	vector_type Pt(dof.Pt()), Uv(dof.Uv()), Pv(dof.Pv());
+	gmm::copy(gmm::sub_vector(UM, gmm::sub_interval(dof.Ut(), dof.Pt())), Pt);
+	gmm::copy(gmm::sub_vector(UM, gmm::sub_interval(dof.Ut()+dof.Pt(), dof.Uv())), Uv);
+	gmm::copy(gmm::sub_vector(UM, gmm::sub_interval(dof.Ut()+dof.Pt()+dof.Uv(), dof.Pv())), Pv);
+
+	// Exchange flux on the vessel pressure dofs: Bvv*(Pv+DeltaPi) - Bvt*Pt (as for TFR)
+	vector_type Uphi(dof.Pv()), Pv_onc(Pv);
+	bool IMPORT_SIGMA = PARAM.int_value("IMPORT_SIGMA");
+	for(size_type i=0; i<nb_branches; ++i){
+		scalar_type sigmai = IMPORT_SIGMA ? param.sigma(mimv, i) : param.sigma();
+		for (dal::bv_visitor idof(mf_Pv.dof_on_region(i)); !idof.finished(); ++idof)
+			Pv_onc[idof] = Pv[idof] - sigmai*(param.pi_v()-param.pi_t());
+	}
+	gmm::mult(gmm::sub_matrix(AM,
+			gmm::sub_interval(dof.Ut()+dof.Pt()+dof.Uv(), dof.Pv()),
+			gmm::sub_interval(dof.Ut(), dof.Pt())), Pt, Uphi);
+	gmm::mult_add(gmm::sub_matrix(AM,
+			gmm::sub_interval(dof.Ut()+dof.Pt()+dof.Uv(), dof.Pv()),
+			gmm::sub_interval(dof.Ut()+dof.Pt()+dof.Uv(), dof.Pv())), Pv_onc, Uphi);
+	// Length of the elements sharing each pressure dof (to split nodal fluxes)
+	vector_type len_dof(dof.Pv(), 0.0);
+	for (dal::bv_visitor cv(meshv.convex_index()); !cv.finished(); ++cv){
+		scalar_type len = estimate_h(meshv, cv);
+		for (auto idof : mf_Pv.ind_basic_dof_of_element(cv)) len_dof[idof] += len;
+	}
+	// Vessel pressure at the segment midpoints
+	vector_type Pv_coef(mf_coefv.nb_dof());
+	getfem::interpolation(mf_Pv, mf_coefv, Pv, Pv_coef);
+
+	const size_type nb_cols = 12;
+	const char * names[nb_cols] = {"branch", "segment", "x", "y", "z", "R", 
+		"Uv", "Pv", "flow_rate", "Ht", "mu", "wall_flux"};
+	vector<vector_type> cols(nb_cols);
+	for (auto & c : cols) c.reserve(meshv.convex_index().card());
+
+	size_type shift = 0, shift_h = 0;
+	for(size_type i=0; i<nb_branches; ++i){
+		if(i>0) shift += mf_Uvi[i-1].nb_dof();
+		if(i>0) shift_h += mf_Hi[i-1].nb_dof();
+		// Velocity and hematocrit of the branch at the segment midpoints
+		vector_type Uvi(mf_coefvi[i].nb_dof()), Hi(mf_coefvi[i].nb_dof());
+		getfem::interpolation(mf_Uvi[i], mf_coefvi[i], 
+			gmm::sub_vector(Uv, gmm::sub_interval(shift, mf_Uvi[i].nb_dof())), Uvi);
+		getfem::interpolation(mf_Hi[i], mf_coefvi[i], 
+			gmm::sub_vector(UM_HT, gmm::sub_interval(shift_h, mf_Hi[i].nb_dof())), Hi);
+
+		size_type seg = 0;
+		for (getfem::mr_visitor mrv(meshv.region(i)); !mrv.finished(); ++mrv, ++seg){
+			// works only for P0 coefficients
+			size_type j  = mf_coefv.ind_basic_dof_of_element(mrv.cv())[0];
+			size_type jj = mf_coefvi[i].ind_basic_dof_of_element(mrv.cv())[0];
+			base_node mid = mf_coefv.point_of_basic_dof(j);
+			scalar_type len = estimate_h(meshv, mrv.cv());
+			scalar_type flux = 0.0;
+			for (auto idof : mf_Pv.ind_basic_dof_of_element(mrv.cv()))
+				flux += Uphi[idof]*len/len_dof[idof];
+			cols[0].emplace_back(i);
+			cols[1].emplace_back(seg);
+			cols[2].emplace_back(mid[0]);
+			cols[3].emplace_back(mid[1]);
+			cols[4].emplace_back(mid[2]);
+			cols[5].emplace_back(param.R(j));
+			cols[6].emplace_back(Uvi[jj]);
+			cols[7].emplace_back(Pv_coef[j]);
+			cols[8].emplace_back(param.CSarea().size() ? param.CSarea(j)*Uvi[jj] : pi*param.R(j)*param.R(j)*Uvi[jj]);
+			cols[9].emplace_back(Hi[jj]);
+			cols[10].emplace_back(MU.size() ? MU[j] : 0.0);
+			cols[11].emplace_back(flux);
+		}
+	}
+
+	std::ofstream ofs(descr.OUTPUT+"segments"+suff+".bin", std::ios::binary | std::ios::trunc);
+	GMM_ASSERT1(ofs.good(), "impossible to write " << descr.OUTPUT+"segments"+suff+".bin");
+	const char magic[] = "M3D1DSEG";
+	ofs.write(magic, sizeof(magic)-1);
+	std::uint32_t version = 1, ncols = nb_cols;
+	ofs.write(reinterpret_cast<const char *>(&version), sizeof(version));
+	ofs.write(reinterpret_cast<const char *>(&ncols), sizeof(ncols));
+	for (size_type c = 0; c < nb_cols; ++c){
+		std::uint64_t len = std::strlen(names[c]);
+		ofs.write(reinterpret_cast<const char *>(&len), sizeof(len));
+		ofs.write(names[c], len);
+	}
+	for (size_type c = 0; c < nb_cols; ++c)
+		write_binary_vector(ofs, cols[c]);
+	GMM_ASSERT1(ofs.good(), "error while writing " << descr.OUTPUT+"segments"+suff+".bin");
+	ofs.close();
+
+	#ifdef M3D1D_VERBOSE_
+	cout << "  " << cols[0].size() << " segments exported" << endl;
+	#endif
+} /* end of export_segments */
+
+////////// Adaptation of the network mesh //////////////////////////////
+size_type
+problemHT::adapt_network(size_type cycle)
+{
+	GMM_ASSERT1(!PARAM.int_value("CURVE_PROBLEM"),
+		"the adaptation of the 1D mesh is not available with CURVE_PROBLEM=1");
+	#ifdef M3D1D_VERBOSE_
+	cout << "Adapting the 1D mesh (cycle " << cycle << ") ..." << endl;
+	#endif
+	// Vessel pressure and hematocrit, with their range over the network
+	vector_type Pv(dof.Pv());
+	gmm::copy(gmm::sub_vector(UM, gmm::sub_interval(dof.Ut()+dof.Pt()+dof.Uv(), dof.Pv())), Pv);
+	scalar_type scale_p = 0.0, scale_h = 0.0;
+	if (Pv.size())
+		scale_p = *std::max_element(Pv.begin(), Pv.end()) - *std::min_element(Pv.begin(), Pv.end());
+	if (UM_HT.size())
+		scale_h = *std::max_element(UM_HT.begin(), UM_HT.end()) - *std::min_element(UM_HT.begin(), UM_HT.end());
+
+	std::vector< std::vector<base_node> > lines, newlines(nb_branches);
+	branch_polylines(meshv, nb_branches, lines);
+	size_type changes = 0, nb_old = 0, nb_new = 0, shift_h = 0;
+	for(size_type i=0; i<nb_branches; ++i){
+		if(i>0) shift_h += mf_Hi[i-1].nb_dof();
+		vector_type eta(lines[i].size()-1, 0.0), V;
+		branch_vertex_values(mf_Pv, Pv, i, V);
+		interpolation_indicator(lines[i], V, scale_p, eta);
+		vector_type Hi(mf_Hi[i].nb_dof());
+		gmm::copy(gmm::sub_vector(UM_HT, gmm::sub_interval(shift_h, mf_Hi[i].nb_dof())), Hi);
+		branch_vertex_values(mf_Hi[i], Hi, i, V);
+		interpolation_indicator(lines[i], V, scale_h, eta);
+		changes += adapt_polyline(lines[i], eta, adapt_par, newlines[i]);
+		nb_old += lines[i].size()-1;
+		nb_new += newlines[i].size()-1;
+	}
+	cout << "  1D mesh adaptation: " << nb_old << " -> " << nb_new 
+		 << " elements (" << changes << " changes)" << endl;
+	if (changes == 0) return 0;
+
+	// Same arcs and boundary conditions, new points
+	std::ostringstream sfx; sfx << "adapt" << cycle;
+	adapt_filev = descr.OUTPUT + sfx.str() + ".pts";
+	adapt_fileh = descr.OUTPUT + sfx.str() + "_HT.pts";
+	std::ifstream ifv(descr.MESH_FILEV), ifh(descrHT.MESH_FILEH);
+	GMM_ASSERT1(ifv.good(), "impossible to read from file " << descr.MESH_FILEV);
+	GMM_ASSERT1(ifh.good(), "impossible to read from file " << descrHT.MESH_FILEH);
+	std::ofstream ofv(adapt_filev), ofh(adapt_fileh);
+	GMM_ASSERT1(ofv.good(), "impossible to write " << adapt_filev);
+	GMM_ASSERT1(ofh.good(), "impossible to write " << adapt_fileh);
+	rewrite_pts_file(ifv, ofv, newlines);
+	rewrite_pts_file(ifh, ofh, newlines);
+	return changes;
+} /* end of adapt_network */
+
 
 
 } /* end of namespace */
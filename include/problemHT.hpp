@@ -25,6 +25,11 @@
 #include <param1dHT.hpp>
 #include <mesh1dHT.hpp>
 #include <Fahraeus.hpp>
+#include <checkpoint1dHT.hpp>
+#include <rheology_table.hpp>
+#include <compliance1dHT.hpp>
+#include <topology1dHT.hpp>
+#include <adapt1d.hpp>
 
 
 namespace getfem {
@@ -65,16 +70,65 @@ public:
 		Solve the monolithic system AM*UM=FM (direct or iterative)
 	 */
 	bool solve_fixpoint (void);
+	//! Solve the fluid problem giving the initial guess of the fixed point method
+	/*!
+		If RESTART_FILE is given the fluid solution is read from the checkpoint
+		(read once, the hematocrit state is kept for solve_fixpoint),
+		if set_initial_guess was called it is already in UM,
+		otherwise problem3d1d::solve() is called
+	 */
+	bool solve_initial (void);
+	//! Use the (converged) state of the coarse level as initial guess of the fixed point
+	/*!
+		Fluid solution as in problem3d1d::set_initial_guess; hematocrit,
+		viscosity (and compliant radii) are copied, the network being the
+		same on both levels. solve_initial and the initial hematocrit solve
+		are then skipped.
+	 */
+	void set_initial_guess (problemHT & coarse);
 
 	//! Export results into vtk files
 	/*!
 		Export solutions Ut, Pt, Uv, Pv, Ht from the monolithic array UM and HT
 	 */
 	void export_vtk (const string & suff = "");
+	//! Export the network results as a columnar binary table
+	/*!
+		One row per segment (element of the 1D mesh) and one column per field:
+		branch, segment, x, y, z, R, Uv, Pv, flow rate, Ht, mu, wall flux.
+		Fields are evaluated at the segment midpoint, the wall flux is
+		integrated over the segment (its sum is the network-to-tissue TFR).
+
+		File layout (little endian, as written by write_binary_vector):
+		- magic string "M3D1DSEG" and uint32 version,
+		- uint32 number of columns,
+		- for each column: uint64 name length, name,
+		- for each column: uint64 number of rows, rows as float64.
+	 */
+	void export_segments (const string & suff = "");
 	//! Flag to linear or sigmoid lymphatic
 	bool HEMATOCRIT_TRANSPORT(int argc, char *argv[]);
 	//! Flag to have compliant vessels
 	bool COMPLIANT_VESSELS() {return descrHT.COMPLIANT_VESSELS;};
+	//! Flag to restart the fixed point method from a checkpoint
+	bool RESTART() {return descrHT.RESTART_FILE != "";};
+	//! Number of adaptation cycles of the 1D mesh
+	size_type ADAPT_CYCLES() {return adapt_par.CYCLES;};
+	//! Adapt the 1D mesh to the current pressure and hematocrit
+	/*!
+		The vertices of each branch are refined/coarsened as described in 
+		adapt1d.hpp and written in OUTPUT/adapt<cycle>.pts and 
+		OUTPUT/adapt<cycle>_HT.pts (copies of MESH_FILEV and MESH_FILEH).
+		The problem has then to be solved again on the new files, which 
+		rebuilds the vessel FEMs and the coupling matrices.
+		
+		It returns the number of split and removed elements (0 = no new files).
+	 */
+	size_type adapt_network(size_type cycle);
+	//! Adapted file of points of the vessel problem (MESH_FILEV)
+	const string & adapted_filev() const {return adapt_filev;};
+	//! Adapted file of points of the hematocrit problem (MESH_FILEH)
+	const string & adapted_fileh() const {return adapt_fileh;};
 
 protected:
 	//! Mesh for the hematocrit in network @f$\Lambda@f$ (1D)
@@ -100,6 +154,8 @@ protected:
 	vector< node > BCv_HT;
 	//! List of junction nodes of the network
 	vector< node > Jv_HT; //?
+	//! Oriented topology of the network (inflow/outflow branches of each node)
+	network_topology topology;
 	
 	////////////////////////////////////////////////////////////////////
 
@@ -111,6 +167,22 @@ protected:
 	vector_type        FM_HT;
 	//! Monolithic viscosity vector
 	vector_type	   MU;
+	//! State of the coarse level of the nested iteration (see set_initial_guess)
+	checkpoint1dHT coarse_state;
+	//! Checkpoint of RESTART_FILE, read by solve_initial and consumed by solve_fixpoint
+	checkpoint1dHT restart_state;
+	//! Diameter-only terms of the viscosity law on the coefficient dofs
+	viscosity_terms visco_terms;
+	//! Lookup tables of the viscosity and phase separation laws
+	rheology_table rheo_table;
+	//! Constants of the compliant vessel model
+	compliance_param compliance_par;
+	//! Per-dof data of the compliant vessel model (built at the first radius update)
+	compliance_soa compliance;
+	//! Parameters of the adaptation of the 1D mesh
+	adapt1d_param adapt_par;
+	//! Files of points written by the last adaptation
+	string adapt_filev, adapt_fileh;
 
 	////////////////////////////////////////////////////////////////////
 	
@@ -125,6 +197,8 @@ protected:
 	void build_param(void);
 	//! Build the list of vessel boundary (and junctions) data 
 	void build_vessel_boundary(void);
+	//! Update the topology with the current velocity (and the labels of the boundary nodes)
+	void update_topology(void);
 	// Aux methods for assembly
 	//! Build the monolithic matrix AM by blocks
 	void assembly_mat(void);
@@ -132,17 +206,38 @@ protected:
 	void assembly_rhs(void);
 	//! Solve the iterative system of hematocrit problem
 	vector_type iteration_solve(vector_type,vector_type);
-	scalar_type calcolo_Rk(vector_type, vector_type);
+	//! Solve the hematocrit problem with the method chosen by HEMATOCRIT_SOLVER (under-relaxed)
+	vector_type solve_hematocrit(vector_type H_O);
+	//! Compute the hematocrit by an upwind sweep of the network
+	/*!
+		The network oriented by the flow is visited in topological order:
+		the RBC flux @f$Q H@f$ of each branch is constant, the inflow RBC 
+		flux of a junction is split among the daughters with 
+		fractional_Erythrocytes (bifurcations) or proportionally to the 
+		flow rate (other junctions). No linear system and no artificial 
+		diffusion are needed.
+		
+		It returns false (and H is meaningless) if the oriented network 
+		has a cycle, if the flow reverses inside a branch or if the flow 
+		enters the network through a node without inlet hematocrit: 
+		in these cases the FEM system has to be solved.
+	 */
+	bool hematocrit_sweep(vector_type & H);
+	scalar_type calcolo_Rk(const vector_type &, const vector_type &);
+	//! Save the current state of the fixed point method in descrHT.CHECKPOINT_FILE
+	void save_checkpoint(size_type iteration,
+		const vector_type & RES_SOL, const vector_type & RES_CM, const vector_type & RES_H);
 
 	
+	//! Update radius, area and perimeter of compliant vessels and compute their conductivity
 	void vessel_conductivity_vec(
 		const mesh_fem & ,
 		const std::vector<mesh_fem> & ,
 		vector_type & ,
-		vector_type ,
-		vector_type ,
-		vector_type ,
-		vector_type );
+		const vector_type & ,
+		const vector_type & ,
+		const vector_type & ,
+		const vector_type & );
 
 }; /* end of class problem3d1d_HT */
 
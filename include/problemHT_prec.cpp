@@ -65,9 +65,7 @@ problemHT::build_mesh(void)
 	#endif
 	std::ifstream ifs(descrHT.MESH_FILEH);
 	GMM_ASSERT1(ifs.good(), "impossible to read from file " << descrHT.MESH_FILEH);
- 	vector_type Uv( dof.Uv()); gmm::clear(Uv);
-	gmm::copy(gmm::sub_vector(UM, gmm::sub_interval(dof.Ut()+dof.Pt(), dof.Uv())),  Uv);
-	import_pts_file_HT(ifs, meshh, BCv_HT, nb_vertices, Uv, descr.MESH_TYPEV, mimv, mf_Uvi);
+	import_pts_file_HT(ifs, meshh, BCv_HT, nb_vertices, descr.MESH_TYPEV);
 	nb_branches = nb_vertices.size();
 	ifs.close();
 }
@@ -399,6 +397,15 @@ try {
         cout << "---------------------------------------- "   << endl;*/
 	#endif
 
+	// Label the outflow boundary nodes from the current velocity
+	vector_type Uv(dof.Uv());
+	gmm::copy(gmm::sub_vector(UM, gmm::sub_interval(dof.Ut()+dof.Pt(), dof.Uv())), Uv);
+	vector_type area(nb_branches);
+	for(size_type i=0; i<nb_branches; ++i) area[i] = param.CSarea(mimv, i);
+	topology.build(meshh, mf_Uvi, mf_Hi, Jv_HT, BCv_HT);
+	topology.update(Uv, area);
+	topology.label_boundary(BCv_HT);
+
 } 
 GMM_STANDARD_CATCH_ERROR; // catches standard errors
 
@@ -572,7 +579,8 @@ problemHT::assembly_mat(void)
 		for (size_type k=0; k < mf_Hi[i].nb_dof(); k++){
 			diff[k] *= areaip1[k];
 		}
-		asm_network_artificial_diffusion (Dhi, mimv, mf_Hi[i], mf_coefvi[i], diff, meshv.region(i));
+		// diff is nodal (area at the dofs of H)
+		asm_network_artificial_diffusion (Dhi, mimv, mf_Hi[i], mf_Hi[i], diff, meshv.region(i));
 		// Copy Bhi and Dhi
 		gmm::scale(Dhi,1.0);
 		gmm::scale(Bhi,-1.0);
@@ -671,32 +679,14 @@ problemHT::iteration_solve(vector_type U_O,vector_type F_N){
 }
 
 scalar_type
-problemHT::calcolo_Rk(vector_type U_N, vector_type U_O){
+problemHT::calcolo_Rk(const vector_type & U_N, const vector_type & U_O){
 
 // The residual is computed as ||V(k)-V(k-1)||/||V(k-1)|| with ||V(k)|| Eucledian norm
 
-	vector_type Sol_old(dofHT.H()); // H(k-1) 
-	vector_type Sol_new(dofHT.H());
-	scalar_type R_H, N_H;
-	scalar_type residual;
-	//obtain H(k-1)
-	gmm::copy(U_O,Sol_old);
-	//obtain H(k)
-	gmm::copy(U_N,Sol_new);
-
-	gmm::scale(Sol_old, -1.0);
-
-	gmm::add(Sol_old, Sol_new);
-
-	R_H=gmm::vect_norm2(Sol_new);
-
-	N_H=gmm::vect_norm2(Sol_old);
-	
-	residual=R_H/N_H;
-
-
-	return residual; // gives if residual is bigger than the max value given in input 
+	residual_norms res({dofHT.H()});
+	accumulate_residual(U_N, U_O, res);
 
+	return res.relative(0); // gives if residual is bigger than the max value given in input 
 
 }
 bool
@@ -747,8 +737,8 @@ problemHT::solve_fixpoint(void)
 	int iteration_save=descr.Save_it;
 	int iteration=0;
 	bool RK=1;
-	clock_t t;
-	clock_t time_G;
+	scalar_type t;      // wall time of the fluid solve [s]
+	scalar_type time_G; // wall time of the whole fixed point [s]
 	vector_type F_LF; gmm::resize(F_LF, dof.Pt());
 	vector_type Uphi(dof.Pv()); 
 	//sparse_matrix_type Bvt(dof.Pv(), dof.Pt());
@@ -806,7 +796,7 @@ problemHT::solve_fixpoint(void)
 	sparse_matrix_type Mbar(dof.Pv(), dof.Pt());
 	sparse_matrix_type Mlin(dof.Pv(), dof.Pt());
     std::cout<<"exchangeauxmat"<< std::endl;
-	asm_exchange_aux_mat(Mbar, Mlin, mimv, mf_Pt, mf_Pv, param.R(), descr.NInt);
+	build_exchange_aux_mat(Mbar, Mlin);
 
     std::cout<<"end exchangeauxmat"<< std::endl;	
 	/*
@@ -902,7 +892,7 @@ problemHT::solve_fixpoint(void)
 	SaveResidual << "Iteration" << "\t" << "Solution Residual" << "\t" << "Mass Conservation Residual" << "\t" << "Hematocrit Residual" << endl;
 	gmm::copy(UM,U_old);
 
-	time_G=clock();
+	time_G=metrics3d1d::wall_time();
 
 	scalar_type H_start = PARAM.real_value("H_START", "hematocrit start");
 	gmm::resize(UM_HT,dofHT.H()); gmm::clear(UM_HT);
@@ -970,11 +960,8 @@ problemHT::solve_fixpoint(void)
 		
 		
 		if (COMPLIANT_VESSELS()){
-            std::cout <<"start vessel conductivity";
 			vessel_conductivity_vec(mf_coefv, mf_coefvi, resistance_rvar, r_und, param.thick(), p_int, p_ext);
-		    std::cout << "...end"<<std::endl;
-            
-        }
+		}
 		//cout << " radius after  " << endl;
 		/*for(size_type k=0; k<mf_coefv.nb_dof(); k++){
 			//cout << " p_int " << p_int[k] << "  p_ext "<< p_ext[k] << " R " << param.R(k) << "  h  " << param.thick(k) << endl;
@@ -1185,7 +1172,7 @@ problemHT::solve_fixpoint(void)
 		cout << "Solving the fluid dynamic problem - Iteration "<< iteration << "..." << endl;
 		#endif
 
-		t=clock();
+		t=metrics3d1d::wall_time();
 		U_new=problem3d1d::iteration_solve(U_old,F_new); // solve fluid dynamic problem
 		gmm::copy(U_new,UM);
 		// gmm::clear(UM);
@@ -1193,7 +1180,7 @@ problemHT::solve_fixpoint(void)
 		// gmm::copy(UM,U_new);
 	
 
-		t=clock()-t;
+		t=metrics3d1d::wall_time()-t;
 		//e-1 find the new solution for hematocrit as AM_HT *H(k+1) = F(k)
 		//e-2 under-relaxation process H(k+1)= alfa*H(k+1) + (1-alfa)H(k)
 		#ifdef M3D1D_VERBOSE_
@@ -1289,7 +1276,7 @@ problemHT::solve_fixpoint(void)
 
 			if(print_res)  {
 				cout << "\nStep n°:" << iteration << "\nSolution Residual = " << resSol << "\nMass Residual = " << fabs(resCM) << "\nHematocrit Residual "<< resH << endl;
-				cout << "\t\t\t\tTime: " <<  ((float)t)/CLOCKS_PER_SEC << " s "<< endl;
+				cout << "\t\t\t\tTime: " <<  t << " s "<< endl;
 					}
 				cout << "********************************************************" << endl;
 
@@ -1338,8 +1325,8 @@ problemHT::solve_fixpoint(void)
 
 	gmm::copy(U_old,UM);
 
-	time_G=clock()-time_G;
-	cout<< "Iterative Process Time = " << ((float)time_G)/CLOCKS_PER_SEC << " s"<< endl;
+	time_G=metrics.phase("fixpoint", time_G);
+	cout<< "Iterative Process Time = " << time_G << " s"<< endl;
 	SaveResidual.close();
 	if(RK)
 		cout << "The method has NOT reached convergence for minimum residual" << endl;
@@ -1432,101 +1419,44 @@ problemHT::vessel_conductivity_vec(
 	const mesh_fem & mf_coefv,
 	const std::vector<mesh_fem> & mf_coefvi,
 	vector_type & cond,
-    vector_type Ru,
-    vector_type hu,
-    vector_type p_int,
-    vector_type p_ext)
-{	
-// leggere nu (modulo di poisson) e E (modulo di young) da file input.param
-scalar_type U_  = PARAM.real_value("U", "characteristic flow speed in the capillary bed [m/s]");
-scalar_type E = PARAM.real_value("E", "Young modulus of the vessel wall");
-scalar_type nu = PARAM.real_value("nu", "Poisson modulus of the vessel wall");
-scalar_type P_ = PARAM.real_value("P", "average interstitial pressure [Pa]");
-scalar_type d = PARAM.real_value("d", "Characteristic length of the problem [m]");
-scalar_type Gamma_= PARAM.real_value("Gamma", "Order of velocity profile in the vessels");
-bool IMPORT_E = PARAM.int_value("IMPORT_E");
-scalar_type e = 2.7182818284;
-
-scalar_type E_ = E/P_; cout<< "E_ " << E_ << endl; // dimensionless E 
-scalar_type Ei = E_;
-scalar_type R, area, per;
-
-for ( size_type i = 0; i < mf_coefvi.size(); i++ ){  // branches loop
-    if (IMPORT_E) Ei=param.E(mimv, i)/P_;
-	for (getfem::mr_visitor mrv(mf_coefv.linked_mesh().region(i)); !mrv.finished(); ++mrv){
-		for (auto j : mf_coefv.ind_basic_dof_of_element(mrv.cv())){    // j global index, indcv_loc is the local index in the branch
-			scalar_type deltap = p_ext[j] - p_int[j]; 
-			scalar_type ratio = hu[j]/Ru[j];
-			size_type indcv_loc = mf_coefvi[i].ind_basic_dof_of_element(mrv.cv())[0];
-			if ( 1) {//i!= 0){
-			if (ratio >= 0.1){ // arteriole case: the cross section remains circular
-				//cout << " arteriola  "<< endl;
-				scalar_type den = (Ru[j]+hu[j])*(Ru[j]+hu[j]) - Ru[j]*Ru[j];  //cout<< "den " << den << endl;
-				scalar_type B1 = (p_int[j] *Ru[j]*Ru[j] - p_ext[j]*(Ru[j]+hu[j])*(Ru[j]+hu[j]))/den; //cout<< "B1 " << B1 << endl;
-				scalar_type B2 = deltap * Ru[j]*Ru[j]*(Ru[j]+hu[j])*(Ru[j]+hu[j]) /den; //cout<< "B2 " << B2 << endl;
-				R = Ru[j]*(1+ (1-nu)/Ei *B1 - (1+nu)/Ei *B2 /Ru[j] /Ru[j]);   // adimensionalized
-				area = pi*R*R;
-				per = 2.0*pi*R;
-				//cout << "Ru   " << Ru[j] << " R  "<< R << endl;
-				//cout << " R   " << R << "   "<< U_/P_ /d << "   "<< area *area <<"  "<<2.0*(Gamma_ +2.0) /pi /R /R /R /R << "   "<< param.Curv(i,indcv_loc) << endl;
-				cond[j] = U_ /P_ /d *area *area *2.0*(Gamma_ +2.0) /pi /R /R /R /R * (1.0 + param.Curv(i, indcv_loc)*param.Curv(i, indcv_loc)*R*R);
-				//cout << U_ /P_ /d *area *area *2.0*(Gamma_ +2.0) /pi /R /R /R /R * (1.0 + param.Curv(i, indcv_loc)*param.Curv(i, indcv_loc)*R*R)<<endl;
-				}
-			else {  // venule case
-				scalar_type threshold;
-				threshold = 3 *Ei *ratio*ratio*ratio /12.0 /(1-nu*nu);
-				//cout << " threshold  " << threshold <<  "   ==== deltap   "<< deltap << endl;
-				scalar_type Rtmp;
-				if(deltap <= threshold){   // venule remains circular
-					Rtmp = Ru[j] *(1 - (1-nu*nu) /ratio /Ei *deltap);
-					//cout << " venula circolare  " << endl;
-					R = Rtmp;
-					area = pi*R*R;
-					per = 2*pi*R;
-					cond[j] = U_ /P_ /d *area *area *2.0*(Gamma_ +2.0) /pi /R /R /R /R * (1.0 + param.Curv(i, indcv_loc)*param.Curv(i, indcv_loc)*R*R);
-					//cout << " cond per venula circolare   " << cond[j] << endl;
-				}
-				else{   // venule: buckling case (negletting curvature)
-					Rtmp = Ru[j]; //*(1 - (1-nu*nu) /ratio /E_ *threshold);
-					//cout << " venula collassata  "<<endl;
-					//scalar_type h_new = hu[j] * Ru[j] /Rtmp;
-					//ratio = h_new/Rtmp; // update ratio
-					scalar_type p_adim = deltap *P_ *12 *(1-nu*nu) /(Ei*P_) /ratio /ratio /ratio; // p_adim èis the equivalent pressure of the paper of Tadj
-					// define limit configuration for the cross section: for p_adim = 5 we define the venule collapsed
-					// before the limit configuration, we use the actual u_star and area.
-					// after the limit configuration, we use the actual area to calculate the hydraulic radius, 
-					// but then we save only the area and u_star of the limit case				
-					area = 15.95 * pow(e, -0.545 * p_adim) * Rtmp *Rtmp;
-					per = 2* pi * Rtmp;
-					R = area /per;  //hydraulic radius
-					if (p_adim < 5 ) {
-						scalar_type int_u_star = 69.56 * pow(e, -1.74 * p_adim);
-						cond[j] = area * area /Rtmp /Rtmp /Rtmp /Rtmp /int_u_star;
-					}
-					else {
-						p_adim = 5;
-						scalar_type int_u_starfake = 69.56 * pow(e, -1.74 * p_adim);
-						area = 15.95 * pow(e, -0.545 * p_adim) * Rtmp *Rtmp;
-						cond[j] = area * area /Rtmp /Rtmp /Rtmp /Rtmp /int_u_starfake;
-					}
-					//cout << " p_adim    " << p_adim <<"==============     area = "<< area << " =======    cond per venula collassata " << cond[j] << endl;
-
+	const vector_type & Ru,
+	const vector_type & hu,
+	const vector_type & p_int,
+	const vector_type & p_ext)
+{
+	size_type n = mf_coefv.nb_dof();
+	if (compliance.size() != n) {
+		// Resolve the constants and gather the per-dof data only once:
+		// Ru, hu, E and curvature do not change along the fixed point iterations
+		compliance_par.import(PARAM);
+		bool IMPORT_E = PARAM.int_value("IMPORT_E");
+		scalar_type P_ = PARAM.real_value("P", "average interstitial pressure [Pa]");
+		scalar_type E_ = PARAM.real_value("E", "Young modulus of the vessel wall")/P_;
+		compliance.resize(n);
+		gmm::copy(Ru, compliance.Ru);
+		gmm::copy(hu, compliance.hu);
+		for (size_type i = 0; i < mf_coefvi.size(); i++) {
+			scalar_type Ei = IMPORT_E ? param.E(mimv, i)/P_ : E_;
+			for (getfem::mr_visitor mrv(mf_coefv.linked_mesh().region(i)); !mrv.finished(); ++mrv) {
+				size_type indcv_loc = mf_coefvi[i].ind_basic_dof_of_element(mrv.cv())[0];
+				for (auto j : mf_coefv.ind_basic_dof_of_element(mrv.cv())) {
+					compliance.E[j]    = Ei;
+					compliance.curv[j] = param.Curv(i, indcv_loc);
 				}
 			}
-
-			// update the values
-			param.replace_r ( R, j);
-			param.replace_area (area, j);
-			param.replace_per (per, j);
-			//cout << " posizione  j  "<<j << "   nuovo R  "<< R << "   coeff  " << cond[j] << endl;
-			}
-			else {
-				cond[j] = U_ /P_ /d *param.CSarea(j) *param.CSarea(j) *2.0*(Gamma_ +2.0) /pi /param.R(j) /param.R(j) /param.R(j) /param.R(j) * (1.0 + param.Curv(i, indcv_loc)*param.Curv(i, indcv_loc)*param.R(j)*param.R(j));
-			}
+		}
 	}
-}
+	gmm::copy(p_int, compliance.p_int);
+	gmm::copy(p_ext, compliance.p_ext);
+
+	compliant_radius_update(compliance_par, compliance);
 
-} // end branches loop
+	// update the values
+	gmm::resize(cond, n);
+	gmm::copy(compliance.cond, cond);
+	gmm::copy(compliance.R, param.R());
+	param.replace_area(compliance.area);
+	param.replace_per(compliance.per);
 
 } // end of vessel_conductivity_vec
 
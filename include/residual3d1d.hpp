@@ -0,0 +1,145 @@
+/* -*- c++ -*- (enables emacs c++ mode) */
+/*======================================================================
+    "Mixed Finite Element Methods for Coupled 3D/1D Fluid Problems"
+
+              Copyright (C) 2026 M3D1D contributors
+======================================================================*/
+/*!
+  @file   residual3d1d.hpp
+  @author M3D1D contributors
+  @date   October 2026.
+  @brief  Fused residual kernel of the fixed point iterations.
+  @details
+	The solution is split in consecutive fields (e.g. [Ut, Pt, Uv, Pv]).
+	In a single pass over @f$ U^k @f$, @f$ U^{k-1} @f$ (and over the
+	rows of the tissue mass balance) the kernel accumulates, without
+	temporary vectors,
+	@f[ \|U^k_f-U^{k-1}_f\|^2, \quad \|U^{k-1}_f\|^2 \quad \mbox{for each field } f @f]
+	and, optionally,
+	@f[ \sum_{i \in rows} \left( (A\,U^k)_i + s_i \right) @f]
+	that is the mass balance of the tissue.
+ */
+#ifndef M3D1D_RESIDUAL3D1D_HPP_
+#define M3D1D_RESIDUAL3D1D_HPP_
+
+#include <initializer_list>
+#include <cmath>
+#include <gmm/gmm.h>
+#include <defines.hpp>
+
+namespace getfem {
+
+//! Accumulators of the fused residual (no dynamic allocation)
+struct residual_norms {
+
+	//! Maximum number of fields
+	static const size_type MAX_FIELDS = 4;
+
+	//! Number of fields
+	size_type nb_fields;
+	//! Field f is the interval [bound[f], bound[f+1]) of the solution
+	size_type bound[MAX_FIELDS+1];
+	//! Squared norm of the increment and of the old value of each field
+	scalar_type dif2[MAX_FIELDS], old2[MAX_FIELDS];
+	//! Mass balance (sum of the selected rows of A U plus the source)
+	scalar_type mass;
+
+	//! Build from the sizes of the fields
+	residual_norms(std::initializer_list<size_type> sizes)
+	: nb_fields(0), mass(0.0)
+	{
+		GMM_ASSERT1(sizes.size() > 0 && sizes.size() <= MAX_FIELDS,
+			"residual: wrong number of fields " << sizes.size());
+		bound[0] = 0;
+		for (size_type s : sizes) {
+			bound[nb_fields+1] = bound[nb_fields] + s;
+			++nb_fields;
+		}
+		clear();
+	}
+
+	//! Reset the accumulators
+	void clear(void)
+	{
+		for (size_type f = 0; f < MAX_FIELDS; ++f) dif2[f] = old2[f] = 0.0;
+		mass = 0.0;
+	}
+
+	//! Relative increment ||U_f(k)-U_f(k-1)||/||U_f(k-1)|| of field f
+	/*!
+		The absolute increment if U_f(k-1) = 0 (e.g. an initial guess
+		without the field).
+	 */
+	scalar_type relative(size_type f) const
+	{ return (old2[f] > 0.0) ? std::sqrt(dif2[f])/std::sqrt(old2[f]) : std::sqrt(dif2[f]); }
+
+	//! Sum of the relative increments of the fields
+	scalar_type sum_relative(void) const
+	{
+		scalar_type r = 0.0;
+		for (size_type f = 0; f < nb_fields; ++f) r += relative(f);
+		return r;
+	}
+};
+
+//! Accumulate the increments of the fields in one pass over U_N and U_O
+template<typename V1, typename V2>
+void
+accumulate_residual(const V1 & U_N, const V2 & U_O, residual_norms & r)
+{
+	GMM_ASSERT1(gmm::vect_size(U_N) >= r.bound[r.nb_fields]
+		&& gmm::vect_size(U_O) >= r.bound[r.nb_fields],
+		"residual: the solution is smaller than the fields");
+	for (size_type f = 0; f < r.nb_fields; ++f) {
+		scalar_type d2 = 0.0, o2 = 0.0;
+		for (size_type i = r.bound[f]; i < r.bound[f+1]; ++i) {
+			scalar_type o = U_O[i], d = U_N[i] - o;
+			d2 += d*d; o2 += o*o;
+		}
+		r.dif2[f] += d2; r.old2[f] += o2;
+	}
+}
+
+//! Accumulate the increments of the fields and the mass balance in one pass
+/*!
+	@param A     Matrix of the problem (row major), only the rows
+	             [row0, row0+nrows) are read
+	@param s     Source of the mass balance, of size nrows
+
+	The rows of the mass balance are visited together with the entries
+	of the same index of the solution.
+ */
+template<typename MAT, typename V1, typename V2, typename V3>
+void
+accumulate_residual(const V1 & U_N, const V2 & U_O,
+	const MAT & A, size_type row0, size_type nrows, const V3 & s,
+	residual_norms & r)
+{
+	GMM_ASSERT1(gmm::vect_size(U_N) >= r.bound[r.nb_fields]
+		&& gmm::vect_size(U_O) >= r.bound[r.nb_fields],
+		"residual: the solution is smaller than the fields");
+	GMM_ASSERT1(row0 + nrows <= gmm::mat_nrows(A) && gmm::vect_size(s) == nrows
+		&& gmm::mat_ncols(A) <= gmm::vect_size(U_N)
+		&& row0 + nrows <= r.bound[r.nb_fields],
+		"residual: wrong size of the mass balance rows");
+	scalar_type m = 0.0;
+	for (size_type f = 0; f < r.nb_fields; ++f) {
+		scalar_type d2 = 0.0, o2 = 0.0;
+		for (size_type i = r.bound[f]; i < r.bound[f+1]; ++i) {
+			scalar_type o = U_O[i], d = U_N[i] - o;
+			d2 += d*d; o2 += o*o;
+			if (i >= row0 && i < row0 + nrows) {
+				auto row = gmm::mat_const_row(A, i);
+				auto it = gmm::vect_const_begin(row), ite = gmm::vect_const_end(row);
+				for (; it != ite; ++it) m += (*it)*U_N[it.index()];
+				m += s[i-row0];
+			}
+		}
+		r.dif2[f] += d2; r.old2[f] += o2;
+	}
+	r.mass += m;
+}
+
+} /* end of namespace */
+
+#endif
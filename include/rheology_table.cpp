@@ -0,0 +1,228 @@
+/* -*- c++ -*- (enables emacs c++ mode) */
+/*======================================================================
+    "Mixed Finite Element Methods for Coupled 3D/1D Fluid Problems"
+
+              Copyright (C) 2026 M3D1D contributors
+======================================================================*/
+/*!
+  @file   	rheology_table.cpp
+  @authors 	M3D1D contributors
+  @date   	October 2026.
+  @brief  	Definition of the lookup tables for the Fahraeus effects routines.
+ */
+
+#include <rheology_table.hpp>
+#include <Fahraeus.hpp>
+#include <algorithm>
+#include <random>
+
+namespace getfem {
+
+// Maximum number of intervals per variable
+static const size_type max_intervals_2d = 1024;
+static const size_type max_intervals_3d = 128;
+
+// Analytic relative viscosity (same formulas of viscosity_vivo/viscosity_vitro)
+scalar_type
+relative_viscosity_exact(scalar_type H, scalar_type D, bool vivo)
+{
+	scalar_type e = 2.7182818284;
+	if (vivo && D < 6) D=6;
+	scalar_type visco_ast_45 = vivo ?
+		6*pow(e,-0.085*D)+3.2-2.44*pow(e,-0.06*pow(D,0.645)) :
+		220*pow(e,-1.3*D)+3.2-2.44*pow(e,-0.06*pow(D,0.645));
+	scalar_type C = (0.8+pow(e,-0.075*D))*(-1+1/(1+10*pow(D/10,12)))+1/(1+10*pow(D/10,12));
+	scalar_type w = vivo ? pow(D/(D-1.1),2) : 1.0;
+	return (1 + ( visco_ast_45 - 1 ) * (pow((1-H),C)-1) / (pow((1-0.45),C)-1)*w)*w;
+}
+
+// Analytic fractional RBC flow in the reduced variables
+scalar_type
+fractional_Erythrocytes_reduced(scalar_type FQB, scalar_type s, scalar_type r)
+{
+	scalar_type X0 = 0.964*s;
+	if (FQB <= X0) return 0.0;
+	if (FQB >= 1-X0) return 1.0;
+	scalar_type A = -13.29*r*s;
+	scalar_type B = 1+6.98*s;
+	scalar_type aux = (FQB-X0)/(1-2*X0);
+	scalar_type logitFQE = A+B*logit(aux);
+	// same as e^L/(1+e^L) of fractional_Erythrocytes, without overflow
+	if (logitFQE > 0) return 1.0/(1.0+pow(2.71828,-logitFQE));
+	return pow(2.71828,logitFQE)/(1+pow(2.71828,logitFQE));
+}
+
+void
+rheology_table::build(bool vivo, scalar_type Dmin, scalar_type Dmax,
+	scalar_type tol, size_type n0)
+{
+	GMM_ASSERT1(Dmin > 0 && Dmax > Dmin,
+		"invalid diameter range [" << Dmin << ", " << Dmax << "] for rheology tables");
+	GMM_ASSERT1(tol > 0, "invalid tolerance " << tol << " for rheology tables");
+	vivo_ = vivo;
+	// In vivo, D<6 is evaluated as D=6
+	Dmin_ = vivo ? std::max(Dmin, 6.0) : Dmin;
+	Dmax_ = std::max(Dmax, Dmin_*1.01);
+	smax_ = 1.0/Dmin;
+	n0 = std::max(n0, size_type(2));
+
+	// Viscosity: refine both directions until the midpoint error is below tol
+	size_type n = n0;
+	tabulate_viscosity(n, n);
+	err_visco_ = midpoint_error_viscosity();
+	while (err_visco_ > tol && 2*n <= max_intervals_2d) {
+		n *= 2;
+		tabulate_viscosity(n, n);
+		err_visco_ = midpoint_error_viscosity();
+	}
+	// Phase separation
+	n = n0;
+	tabulate_fqe(n, n, n);
+	err_fqe_ = midpoint_error_fqe();
+	while (err_fqe_ > tol && 2*n <= max_intervals_3d) {
+		n *= 2;
+		tabulate_fqe(n, n, n);
+		err_fqe_ = midpoint_error_fqe();
+	}
+	built_ = true;
+	if (err_visco_ > tol || err_fqe_ > tol)
+		cerr << "WARNING! Rheology tables do not reach the tolerance " << tol
+			 << " (viscosity " << err_visco_ << ", phase separation " << err_fqe_ << ")" << endl;
+}
+
+void
+rheology_table::tabulate_viscosity(size_type nH, size_type nD)
+{
+	nH_ = nH; nD_ = nD;
+	visco_.assign((nH+1)*(nD+1), 0.0);
+	scalar_type lr = log(Dmax_/Dmin_);
+	for (size_type j=0; j<=nD; ++j) {
+		scalar_type D = Dmin_*exp(lr*j/nD);
+		for (size_type i=0; i<=nH; ++i)
+			visco_[j*(nH+1)+i] = relative_viscosity_exact(Hmax_*i/nH, D, vivo_);
+	}
+}
+
+void
+rheology_table::tabulate_fqe(size_type nF, size_type nS, size_type nR)
+{
+	nF_ = nF; nS_ = nS; nR_ = nR;
+	fqe_.assign((nF+1)*(nS+1)*(nR+1), 0.0);
+	for (size_type k=0; k<=nR; ++k)
+		for (size_type j=0; j<=nS; ++j)
+			for (size_type i=0; i<=nF; ++i)
+				fqe_[(k*(nS+1)+j)*(nF+1)+i] = fractional_Erythrocytes_reduced(
+					scalar_type(i)/nF, smax_*j/nS, -1.0+2.0*k/nR);
+}
+
+scalar_type
+rheology_table::interp_viscosity(scalar_type x, scalar_type y) const
+{
+	size_type i = std::min(size_type(x), nH_-1);
+	size_type j = std::min(size_type(y), nD_-1);
+	scalar_type a = x-i, b = y-j;
+	const scalar_type * v0 = &visco_[j*(nH_+1)+i];
+	const scalar_type * v1 = v0 + (nH_+1);
+	return (1-b)*((1-a)*v0[0]+a*v0[1]) + b*((1-a)*v1[0]+a*v1[1]);
+}
+
+scalar_type
+rheology_table::interp_fqe(scalar_type x, scalar_type y, scalar_type z) const
+{
+	size_type i = std::min(size_type(x), nF_-1);
+	size_type j = std::min(size_type(y), nS_-1);
+	size_type k = std::min(size_type(z), nR_-1);
+	scalar_type a = x-i, b = y-j, c = z-k;
+	size_type sy = nF_+1, sz = (nF_+1)*(nS_+1);
+	const scalar_type * v = &fqe_[k*sz+j*sy+i];
+	scalar_type v00 = (1-a)*v[0]     + a*v[1];
+	scalar_type v10 = (1-a)*v[sy]    + a*v[sy+1];
+	scalar_type v01 = (1-a)*v[sz]    + a*v[sz+1];
+	scalar_type v11 = (1-a)*v[sz+sy] + a*v[sz+sy+1];
+	return (1-c)*((1-b)*v00+b*v10) + c*((1-b)*v01+b*v11);
+}
+
+scalar_type
+rheology_table::midpoint_error_viscosity(void) const
+{
+	scalar_type err = 0.0;
+	scalar_type lr = log(Dmax_/Dmin_);
+	for (size_type j=0; j<nD_; ++j) {
+		scalar_type D = Dmin_*exp(lr*(j+0.5)/nD_);
+		for (size_type i=0; i<nH_; ++i) {
+			scalar_type H = Hmax_*(i+0.5)/nH_;
+			err = std::max(err, fabs(interp_viscosity(i+0.5, j+0.5) - relative_viscosity_exact(H, D, vivo_)));
+		}
+	}
+	return err;
+}
+
+scalar_type
+rheology_table::midpoint_error_fqe(void) const
+{
+	scalar_type err = 0.0;
+	for (size_type k=0; k<nR_; ++k)
+		for (size_type j=0; j<nS_; ++j)
+			for (size_type i=0; i<nF_; ++i) {
+				scalar_type exact = fractional_Erythrocytes_reduced(
+					(i+0.5)/nF_, smax_*(j+0.5)/nS_, -1.0+2.0*(k+0.5)/nR_);
+				err = std::max(err, fabs(interp_fqe(i+0.5, j+0.5, k+0.5) - exact));
+			}
+	return err;
+}
+
+scalar_type
+rheology_table::relative_viscosity(scalar_type H, scalar_type D) const
+{
+	if (vivo_ && D < 6) D=6;
+	if (!built_ || H < 0 || H > Hmax_ || D < Dmin_ || D > Dmax_)
+		return relative_viscosity_exact(H, D, vivo_);
+	return interp_viscosity(H/Hmax_*nH_, log(D/Dmin_)/log(Dmax_/Dmin_)*nD_);
+}
+
+scalar_type
+rheology_table::fractional_Erythrocytes(scalar_type FQB, scalar_type D_f,
+	scalar_type D, scalar_type D_2, scalar_type H_f) const
+{
+	scalar_type s = (1-H_f)/D_f;
+	scalar_type q = (D/D_2)*(D/D_2);
+	scalar_type r = (q-1)/(q+1);
+	if (!built_ || FQB < 0 || FQB > 1 || s < 0 || s > smax_)
+		return fractional_Erythrocytes_reduced(FQB, s, r);
+	return interp_fqe(FQB*nF_, s/smax_*nS_, (r+1)/2*nR_);
+}
+
+void
+rheology_table::validate(std::ostream & out, size_type nsamples) const
+{
+	GMM_ASSERT1(built_, "rheology tables have not been built");
+	std::mt19937 gen(5489u); // fixed seed: reproducible reports
+	std::uniform_real_distribution<scalar_type> unif(0.0, 1.0);
+	scalar_type lr = log(Dmax_/Dmin_);
+	// Viscosity
+	scalar_type err_abs = 0.0, err_rel = 0.0;
+	for (size_type k=0; k<nsamples; ++k) {
+		scalar_type H = Hmax_*unif(gen);
+		scalar_type D = Dmin_*exp(lr*unif(gen));
+		scalar_type exact = relative_viscosity_exact(H, D, vivo_);
+		scalar_type diff = fabs(relative_viscosity(H, D) - exact);
+		err_abs = std::max(err_abs, diff);
+		err_rel = std::max(err_rel, diff/fabs(exact));
+	}
+	out << "  Relative viscosity : max abs error " << err_abs
+		<< ", max rel error " << err_rel << endl;
+	// Phase separation against the analytic law
+	err_abs = 0.0;
+	for (size_type k=0; k<nsamples; ++k) {
+		scalar_type H_f = 0.9*unif(gen);
+		scalar_type D_f = Dmin_*exp(lr*unif(gen));
+		scalar_type D   = Dmin_*exp(lr*unif(gen));
+		scalar_type D_2 = Dmin_*exp(lr*unif(gen));
+		scalar_type FQB = unif(gen);
+		scalar_type exact = fractional_Erythrocytes_exact(FQB, D_f, D, D_2, H_f);
+		err_abs = std::max(err_abs, fabs(fractional_Erythrocytes(FQB, D_f, D, D_2, H_f) - exact));
+	}
+	out << "  Fractional RBC flow: max abs error " << err_abs << endl;
+}
+
+} /* end of namespace */
@@ -0,0 +1,119 @@
+/* -*- c++ -*- (enables emacs c++ mode) */
+/*======================================================================
+    "Mixed Finite Element Methods for Coupled 3D/1D Fluid Problems"
+
+              Copyright (C) 2026 M3D1D contributors
+======================================================================*/
+/*!
+  @file   	rheology_table.hpp
+  @authors 	M3D1D contributors
+  @date   	October 2026.
+  @brief  	Declaration of the lookup tables for the Fahraeus effects routines.
+  @details
+	Optional backend for the Pries laws, built once at startup:
+	- relative viscosity @f$\eta_{rel}(H, D)@f$: bilinear interpolation on a
+	  grid uniform in @f$H@f$ and in @f$\log D@f$;
+	- fractional RBC flow of a bifurcation: trilinear interpolation in the
+	  reduced variables @f$(FQ_B, s, r)@f$ with @f$s=(1-H_f)/D_f@f$ and
+	  @f$r=((D_\alpha/D_\beta)^2-1)/((D_\alpha/D_\beta)^2+1)@f$, since
+	  @f$A=-13.29\,r\,s@f$, @f$B=1+6.98\,s@f$, @f$X_0=0.964\,s@f$.
+
+	The grids are refined until the interpolation error (estimated at the
+	cell midpoints) is below the required tolerance. Inputs out of the
+	tabulated range are evaluated with the analytic laws.
+ */
+
+#ifndef M3D1D_RHEOLOGY_TABLE_HPP_
+#define M3D1D_RHEOLOGY_TABLE_HPP_
+
+#include <getfem/getfem_assembling.h>
+#include <iostream>
+#include <defines.hpp>
+
+namespace getfem {
+
+//! Class to handle the lookup tables of the Pries laws
+class rheology_table {
+
+public:
+	rheology_table(void) :
+		built_(false), vivo_(true), Dmin_(0), Dmax_(0), Hmax_(0.95), smax_(0),
+		nH_(0), nD_(0), nF_(0), nS_(0), nR_(0), err_visco_(0), err_fqe_(0)
+	{}
+
+	//! Build the tables for diameters in [Dmin, Dmax] [um]
+	/*!
+		@param vivo  true for the in vivo viscosity law (Pries 1994), false for in vitro (Pries 1992)
+		@param Dmin  Minimum diameter [um]
+		@param Dmax  Maximum diameter [um]
+		@param tol   Required maximum absolute error (relative viscosity and fractional RBC flow)
+		@param n0    Initial number of intervals per variable
+	 */
+	void build(bool vivo, scalar_type Dmin, scalar_type Dmax,
+		scalar_type tol, size_type n0 = 16);
+	//! True if the tables have been built
+	inline bool built(void) const { return built_; }
+
+	//! Relative viscosity @f$\eta_{rel}(H, D)@f$ (D [um])
+	scalar_type relative_viscosity(scalar_type H, scalar_type D) const;
+	//! Fractional RBC flow of a bifurcation (same arguments of fractional_Erythrocytes)
+	scalar_type fractional_Erythrocytes(scalar_type FQB, scalar_type D_f,
+		scalar_type D, scalar_type D_2, scalar_type H_f) const;
+
+	//! Report the maximum deviation from the analytic laws on nsamples random inputs
+	void validate(std::ostream & out, size_type nsamples = 100000) const;
+
+	//! Overloading of the output operator
+	friend std::ostream & operator << (
+		std::ostream & out, const rheology_table & T
+		)
+	{
+		out << "--- RHEOLOGY TABLES ---------------" << endl;
+		out << "  law               : " << (T.vivo_ ? "vivo" : "vitro") << endl;
+		out << "  diameter range    : [" << T.Dmin_ << ", " << T.Dmax_ << "] um" << endl;
+		out << "  viscosity grid    : " << T.nH_ << " x " << T.nD_
+			<< " (max error " << T.err_visco_ << ")" << endl;
+		out << "  phase sep. grid   : " << T.nF_ << " x " << T.nS_ << " x " << T.nR_
+			<< " (max error " << T.err_fqe_ << ")" << endl;
+		out << "-----------------------------------" << endl;
+		return out;
+	}
+
+private:
+	bool built_;
+	bool vivo_;
+	// Range of the tables
+	scalar_type Dmin_, Dmax_, Hmax_, smax_;
+	// Number of intervals
+	size_type nH_, nD_, nF_, nS_, nR_;
+	// Estimated interpolation errors
+	scalar_type err_visco_, err_fqe_;
+	// Tabulated values
+	vector_type visco_, fqe_;
+
+	//! Tabulate the relative viscosity on a nH x nD grid
+	void tabulate_viscosity(size_type nH, size_type nD);
+	//! Tabulate the fractional RBC flow on a nF x nS x nR grid
+	void tabulate_fqe(size_type nF, size_type nS, size_type nR);
+	//! Bilinear interpolation of the relative viscosity (grid coordinates)
+	scalar_type interp_viscosity(scalar_type x, scalar_type y) const;
+	//! Trilinear interpolation of the fractional RBC flow (grid coordinates)
+	scalar_type interp_fqe(scalar_type x, scalar_type y, scalar_type z) const;
+	//! Max error at the cell midpoints of the viscosity grid
+	scalar_type midpoint_error_viscosity(void) const;
+	//! Max error at the cell midpoints of the phase separation grid
+	scalar_type midpoint_error_fqe(void) const;
+
+}; /* end of class */
+
+//! Analytic relative viscosity of the Pries laws (D [um])
+scalar_type
+relative_viscosity_exact(scalar_type H, scalar_type D, bool vivo);
+
+//! Analytic fractional RBC flow in the reduced variables (FQB, s, r)
+scalar_type
+fractional_Erythrocytes_reduced(scalar_type FQB, scalar_type s, scalar_type r);
+
+} /* end of namespace */
+
+#endif
@@ -0,0 +1,159 @@
+/* -*- c++ -*- (enables emacs c++ mode) */
+/*======================================================================
+    "Mixed Finite Element Methods for Coupled 3D/1D Fluid Problems"
+
+              Copyright (C) 2026 M3D1D contributors
+======================================================================*/
+/*!
+  @file   rom3d1d.cpp
+  @author M3D1D contributors
+  @date   October 2026.
+  @brief  Definition of the reduced-order (POD) surrogate of the coupled 3D/1D problem.
+ */
+
+#include <rom3d1d.hpp>
+#include <algorithm>
+#include <numeric>
+
+namespace getfem {
+
+size_type
+pod_basis(const std::vector<vector_type> & S, size_type first, size_type n,
+	scalar_type tol, std::vector<vector_type> & basis)
+{
+	const size_type m = S.size();
+	if (m == 0 || n == 0) return 0;
+	const size_type ntot = S[0].size();
+	gmm::sub_interval I(first, n);
+	// Correlation matrix of the block
+	gmm::dense_matrix<scalar_type> C(m, m), W(m, m);
+	for (size_type i = 0; i < m; ++i)
+		for (size_type j = 0; j <= i; ++j)
+			C(i, j) = C(j, i) = gmm::vect_sp(gmm::sub_vector(S[i], I), gmm::sub_vector(S[j], I));
+	vector_type lambda(m);
+	gmm::symmetric_qr_algorithm(C, lambda, W);
+	std::vector<size_type> order(m);
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(),
+		[&lambda](size_type i, size_type j) { return lambda[i] > lambda[j]; });
+	scalar_type total = 0.0;
+	for (size_type k = 0; k < m; ++k) total += std::max(lambda[k], 0.0);
+	if (total <= 0.0) return 0; // the block vanishes on all the snapshots
+
+	// Smallest basis whose discarded energy is below tol^2
+	size_type N = 0;
+	scalar_type tail = total;
+	while (N < m && tail > tol*tol*total) tail -= std::max(lambda[order[N++]], 0.0);
+
+	const size_type first_mode = basis.size();
+	vector_type phi(n);
+	for (size_type k = 0; k < N; ++k) {
+		scalar_type lk = lambda[order[k]];
+		if (lk <= 1E-14*lambda[order[0]]) break;
+		gmm::clear(phi);
+		for (size_type j = 0; j < m; ++j)
+			gmm::add(gmm::scaled(gmm::sub_vector(S[j], I), W(j, order[k])), phi);
+		gmm::scale(phi, 1.0/std::sqrt(lk));
+		// Modified Gram-Schmidt against the previous modes of the block
+		for (size_type b = first_mode; b < basis.size(); ++b)
+			gmm::add(gmm::scaled(gmm::sub_vector(basis[b], I),
+				-gmm::vect_sp(phi, gmm::sub_vector(basis[b], I))), phi);
+		scalar_type nrm = gmm::vect_norm2(phi);
+		if (nrm < 1E-8) continue;
+		gmm::scale(phi, 1.0/nrm);
+		basis.push_back(vector_type(ntot, 0.0));
+		gmm::copy(phi, gmm::sub_vector(basis.back(), I));
+	}
+	return basis.size() - first_mode;
+}
+
+void
+reduced_model::project(const sweep_system & sys)
+{
+	const size_type nA = sweep_system::nb_mat_terms();
+	const size_type nF = sweep_system::nb_rhs_terms();
+	const size_type N = size();
+	GMM_ASSERT1(N > 0, "reduced model: empty basis");
+	const size_type n = V[0].size();
+	// Products of the matrix terms by the basis
+	std::vector< std::vector<vector_type> > AV(nA, std::vector<vector_type>(N, vector_type(n)));
+	for (size_type q = 0; q < nA; ++q)
+		for (size_type i = 0; i < N; ++i)
+			gmm::mult(sys.mat_term(q), V[i], AV[q][i]);
+
+	G.assign(nA*nA, gmm::dense_matrix<scalar_type>(N, N));
+	for (size_type q = 0; q < nA; ++q)
+		for (size_type r = q; r < nA; ++r)
+			for (size_type i = 0; i < N; ++i)
+				for (size_type j = 0; j < N; ++j) {
+					scalar_type g = gmm::vect_sp(AV[q][i], AV[r][j]);
+					G[q*nA+r](i, j) = g;
+					G[r*nA+q](j, i) = g;
+				}
+	H.assign(nA*nF, vector_type(N));
+	for (size_type q = 0; q < nA; ++q)
+		for (size_type r = 0; r < nF; ++r)
+			for (size_type i = 0; i < N; ++i)
+				H[q*nF+r][i] = gmm::vect_sp(AV[q][i], sys.rhs_term(r));
+	gmm::resize(FF, nF, nF);
+	for (size_type q = 0; q < nF; ++q)
+		for (size_type r = 0; r < nF; ++r)
+			FF(q, r) = gmm::vect_sp(sys.rhs_term(q), sys.rhs_term(r));
+}
+
+scalar_type
+reduced_model::solve(const sweep_point & p, vector_type & a) const
+{
+	const size_type nA = sweep_system::nb_mat_terms();
+	const size_type nF = sweep_system::nb_rhs_terms();
+	const size_type N = size();
+	vector_type thA, thF;
+	sweep_system::theta_mat(p, thA);
+	sweep_system::theta_rhs(p, thF);
+	// A = sum theta_q A_q and F = sum theta_q F_q (theta_0 = 1)
+	gmm::dense_matrix<scalar_type> AN(N, N);
+	vector_type bN(N);
+	for (size_type q = 0; q < nA; ++q)
+		for (size_type r = 0; r < nA; ++r)
+			if (thA[q] != 0.0 && thA[r] != 0.0)
+				gmm::add(gmm::scaled(G[q*nA+r], thA[q]*thA[r]), AN);
+	for (size_type q = 0; q < nA; ++q)
+		for (size_type r = 0; r < nF; ++r)
+			if (thA[q] != 0.0 && thF[r] != 0.0)
+				gmm::add(gmm::scaled(H[q*nF+r], thA[q]*thF[r]), bN);
+	scalar_type ff = 0.0;
+	for (size_type q = 0; q < nF; ++q)
+		for (size_type r = 0; r < nF; ++r)
+			ff += thF[q]*thF[r]*FF(q, r);
+
+	a.assign(N, 0.0);
+	gmm::lu_solve(AN, a, bN);
+	// ||F - A V a||^2 = F^T F - 2 a^T (AV)^T F + a^T (AV)^T (AV) a
+	vector_type Aa(N);
+	gmm::mult(AN, a, Aa);
+	scalar_type res2 = ff - 2.0*gmm::vect_sp(a, bN) + gmm::vect_sp(a, Aa);
+	if (ff <= 0.0) return std::sqrt(std::max(res2, 0.0));
+	return std::sqrt(std::max(res2, 0.0)/ff);
+}
+
+void
+reduced_model::outputs(const sweep_point & p, const vector_type & a, sweep_result & r) const
+{
+	// TFR and FRlymph are linear in Lp and Q_LF, the oncotic term in Lp*sigma
+	r.TFR     = p.Lp*(gmm::vect_sp(l_tfr, a) + p.sigma*c_tfr);
+	r.FRlymph = p.Q_LF*(gmm::vect_sp(l_lymph, a) + c_lymph);
+	r.FRCube  = gmm::vect_sp(l_cube, a);
+	r.mean_pt = gmm::vect_sp(l_pt, a);
+	r.mean_pv = gmm::vect_sp(l_pv, a);
+}
+
+void
+reduced_model::expand(const vector_type & a, vector_type & U) const
+{
+	GMM_ASSERT1(a.size() == size(), "reduced model: wrong number of coefficients");
+	U.assign(V[0].size(), 0.0);
+	for (size_type i = 0; i < size(); ++i)
+		gmm::add(gmm::scaled(V[i], a[i]), U);
+}
+
+} /* end of namespace */
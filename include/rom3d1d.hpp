@@ -0,0 +1,102 @@
+/* -*- c++ -*- (enables emacs c++ mode) */
+/*======================================================================
+    "Mixed Finite Element Methods for Coupled 3D/1D Fluid Problems"
+
+              Copyright (C) 2026 M3D1D contributors
+======================================================================*/
+/*!
+  @file   rom3d1d.hpp
+  @author M3D1D contributors
+  @date   October 2026.
+  @brief  Declaration of the reduced-order (POD) surrogate of the coupled 3D/1D problem.
+  @details
+	Offline: the full problem is solved at the training parameter sets
+	(see sweep3d1d.hpp), and a POD basis @f$V@f$ is extracted from the
+	snapshots of each field (@f$\mathbf{u}_t@f$, @f$p_t@f$, @f$u_v@f$,
+	@f$p_v@f$ separately, so that the basis is block diagonal). The
+	affine terms of the system are projected once:
+	@f[ G_{qr} = (A_q V)^T (A_r V), \quad H_{qr} = (A_q V)^T F_r,
+	    \quad \Phi_{qr} = F_q^T F_r . @f]
+
+	Online: the reduced solution @f$a@f$ minimizes the residual
+	@f$\| F(f) - A(f) V a \|@f$ (least-squares Petrov-Galerkin; the plain
+	Galerkin projection of the saddle-point blocks is not inf-sup stable),
+	i.e. it solves the @f$N \times N@f$ system
+	@f[ \sum_{q,r} \theta_q \theta_r G_{qr}\, a = \sum_{q,r} \theta_q \phi_r H_{qr} . @f]
+	The same data give the residual norm, hence the error estimate
+	@f$\|F - A V a\| / \|F\|@f$, at a cost independent of the mesh. The
+	outputs (TFR, FRlymph, FRCube, mean pressures) are linear in the
+	solution, with coefficients affine in the factors, and are computed
+	from the outputs of the basis functions.
+
+	\ingroup input
+ */
+#ifndef M3D1D_ROM3D1D_HPP_
+#define M3D1D_ROM3D1D_HPP_
+
+#include <gmm/gmm.h>
+#include <vector>
+#include <defines.hpp>
+#include <sweep3d1d.hpp>
+
+namespace getfem {
+
+//! Reduced basis and projected affine terms of the surrogate
+struct reduced_model {
+
+	//! Basis functions (full length, each one supported on a single field)
+	std::vector<vector_type> V;
+	//! Number of basis functions of each field
+	size_type N_ut, N_pt, N_uv, N_pv;
+	//! Projected matrix terms, G[q*nb_mat_terms()+r] = (A_q V)^T (A_r V)
+	std::vector< gmm::dense_matrix<scalar_type> > G;
+	//! Projected rhs terms, H[q*nb_rhs_terms()+r] = (A_q V)^T F_r
+	std::vector<vector_type> H;
+	//! Products of the rhs terms, FF(q,r) = F_q^T F_r
+	gmm::dense_matrix<scalar_type> FF;
+	//! Outputs of the basis functions (linear parts, at the .param values)
+	vector_type l_tfr, l_lymph, l_cube, l_pt, l_pv;
+	//! Constant parts of TFR (oncotic term) and FRlymph (lymphatic pressure)
+	scalar_type c_tfr, c_lymph;
+
+	reduced_model(void) : N_ut(0), N_pt(0), N_uv(0), N_pv(0), c_tfr(0.0), c_lymph(0.0) {}
+
+	//! Size of the reduced basis
+	inline size_type size(void) const { return V.size(); }
+	//! True if the offline stage has been done
+	inline bool ready(void) const { return !V.empty(); }
+
+	//! Project the affine terms of sys on the basis (offline)
+	/*!
+		The products A_q V are kept in memory during the projection
+		(nb_mat_terms()*size() vectors of the size of the system).
+	 */
+	void project(const sweep_system & sys);
+	//! Solve the reduced problem of a parameter set
+	/*!
+		@param p  Parameter set
+		@param a  Coefficients of the reduced solution on the basis
+		@return   Error estimate, relative residual of the full system
+	 */
+	scalar_type solve(const sweep_point & p, vector_type & a) const;
+	//! Outputs of the reduced solution a of the parameter set p
+	void outputs(const sweep_point & p, const vector_type & a, sweep_result & r) const;
+	//! Reduced solution in the full space, U = V a
+	void expand(const vector_type & a, vector_type & U) const;
+};
+
+//! POD basis of the rows [first, first+n) of the snapshots
+/*!
+	Method of snapshots: eigen-decomposition of the correlation matrix of
+	the block. The modes are kept until the discarded energy is below
+	tol^2 times the total one; they are orthonormalized and appended to
+	basis as full-length vectors (zero outside the block).
+
+	@return the number of modes appended
+ */
+size_type pod_basis(const std::vector<vector_type> & S, size_type first, size_type n,
+	scalar_type tol, std::vector<vector_type> & basis);
+
+} /* end of namespace */
+
+#endif
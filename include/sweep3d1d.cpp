@@ -0,0 +1,165 @@
+/* -*- c++ -*- (enables emacs c++ mode) */
+/*======================================================================
+    "Mixed Finite Element Methods for Coupled 3D/1D Fluid Problems"
+
+              Copyright (C) 2026 M3D1D contributors
+======================================================================*/
+/*!
+  @file   sweep3d1d.cpp
+  @author M3D1D contributors
+  @date   October 2026.
+  @brief  Definition of the parameter sweep of the coupled 3D/1D problem.
+ */
+
+#include <sweep3d1d.hpp>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+namespace getfem {
+
+void
+sweep_system::init(size_type n)
+{
+	gmm::resize(Akt, n, n); gmm::clear(Akt);
+	gmm::resize(Aex, n, n); gmm::clear(Aex);
+	gmm::resize(Akv, n, n); gmm::clear(Akv);
+	gmm::resize(Alf, n, n); gmm::clear(Alf);
+	Fonc.assign(n, 0.0);
+	Flf.assign(n, 0.0);
+	Fin.assign(n, 0.0);
+}
+
+void
+sweep_system::build(const sweep_point & p, sparse_matrix_type & AM, vector_type & FM) const
+{
+	vector_type thA, thF;
+	theta_mat(p, thA);
+	theta_rhs(p, thF);
+	gmm::resize(AM, gmm::mat_nrows(AM0), gmm::mat_ncols(AM0));
+	gmm::copy(AM0, AM);
+	for (size_type q = 1; q < nb_mat_terms(); ++q)
+		if (thA[q] != 0.0) gmm::add(gmm::scaled(mat_term(q), thA[q]), AM);
+	gmm::resize(FM, FM0.size());
+	gmm::copy(FM0, FM);
+	for (size_type q = 1; q < nb_rhs_terms(); ++q)
+		gmm::add(gmm::scaled(rhs_term(q), thF[q]), FM);
+}
+
+void
+sweep_system::theta_mat(const sweep_point & p, vector_type & theta)
+{
+	GMM_ASSERT1(p.kt > 0 && p.kv > 0, "sweep: the factors on KT and KV must be positive");
+	theta.resize(nb_mat_terms());
+	theta[0] = 1.0;
+	theta[1] = 1.0/p.kt - 1.0;
+	theta[2] = p.Lp - 1.0;
+	theta[3] = 1.0/p.kv - 1.0;
+	theta[4] = p.Q_LF - 1.0;
+}
+
+void
+sweep_system::theta_rhs(const sweep_point & p, vector_type & theta)
+{
+	theta.resize(nb_rhs_terms());
+	theta[0] = 1.0;
+	theta[1] = p.Lp*p.sigma - 1.0;
+	theta[2] = p.Q_LF - 1.0;
+	theta[3] = p.P_in - 1.0;
+}
+
+const sparse_matrix_type &
+sweep_system::mat_term(size_type q) const
+{
+	GMM_ASSERT1(q < nb_mat_terms(), "sweep: wrong matrix term " << q);
+	switch (q) {
+		case 1:  return Akt;
+		case 2:  return Aex;
+		case 3:  return Akv;
+		case 4:  return Alf;
+		default: return AM0;
+	}
+}
+
+const vector_type &
+sweep_system::rhs_term(size_type q) const
+{
+	GMM_ASSERT1(q < nb_rhs_terms(), "sweep: wrong rhs term " << q);
+	switch (q) {
+		case 1:  return Fonc;
+		case 2:  return Flf;
+		case 3:  return Fin;
+		default: return FM0;
+	}
+}
+
+void
+read_sweep_file(const std::string & fname, std::vector<sweep_point> & points)
+{
+	std::ifstream ifs(fname);
+	GMM_ASSERT1(ifs.good(), "impossible to read sweep file " << fname);
+	points.clear();
+	std::vector<std::string> columns;
+	std::string line;
+	size_type nline = 0;
+	while (std::getline(ifs, line)) {
+		++nline;
+		std::istringstream iss(line);
+		std::vector<std::string> tokens;
+		std::string tok;
+		while (iss >> tok) tokens.push_back(tok);
+		if (tokens.empty() || tokens[0][0] == '%' || tokens[0][0] == '#') continue;
+		if (columns.empty()) {
+			// Header
+			for (const std::string & c : tokens) {
+				GMM_ASSERT1(c != "E", "sweep: E (Young modulus) only enters the "
+					"compliant network of the hematocrit problem, not the 3D/1D system");
+				GMM_ASSERT1(c == "NAME" || c == "LP" || c == "SIGMA" || c == "Q_LF" || c == "P_IN"
+					|| c == "KT" || c == "KV",
+					"sweep: unknown column " << c << " (NAME, LP, SIGMA, Q_LF, P_IN, KT or KV)");
+			}
+			columns = tokens;
+			continue;
+		}
+		GMM_ASSERT1(tokens.size() == columns.size(),
+			"sweep: wrong number of values at line " << nline << " of " << fname);
+		sweep_point p;
+		p.name = "p" + std::to_string(points.size());
+		for (size_type c = 0; c < columns.size(); ++c) {
+			if (columns[c] == "NAME") { p.name = tokens[c]; continue; }
+			scalar_type v = std::stod(tokens[c]);
+			if      (columns[c] == "LP")    p.Lp = v;
+			else if (columns[c] == "SIGMA") p.sigma = v;
+			else if (columns[c] == "Q_LF")  p.Q_LF = v;
+			else if (columns[c] == "P_IN")  p.P_in = v;
+			else if (columns[c] == "KT")    p.kt = v;
+			else if (columns[c] == "KV")    p.kv = v;
+		}
+		points.push_back(p);
+	}
+	GMM_ASSERT1(!points.empty(), "sweep: no parameter set in " << fname);
+}
+
+void
+write_sweep_table(const std::string & fname,
+	const std::vector<sweep_point> & points,
+	const std::vector<sweep_result> & results)
+{
+	GMM_ASSERT1(points.size() == results.size(), "sweep: wrong number of results");
+	std::ofstream ofs(fname);
+	GMM_ASSERT1(ofs.good(), "impossible to write sweep table " << fname);
+	ofs << "% NAME LP SIGMA Q_LF P_IN KT KV CONVERGED TFR FR_LYMPH FR_CUBE PT_MEAN PV_MEAN TIME_S"
+	       " REDUCED ERR_EST" << endl;
+	ofs << std::setprecision(10);
+	for (size_type k = 0; k < points.size(); ++k) {
+		const sweep_point & p = points[k];
+		const sweep_result & r = results[k];
+		ofs << p.name << " " << p.Lp << " " << p.sigma << " " << p.Q_LF << " " << p.P_in << " "
+			<< p.kt << " " << p.kv << " "
+			<< r.converged << " " << r.TFR << " " << r.FRlymph << " " << r.FRCube << " "
+			<< r.mean_pt << " " << r.mean_pv << " " << r.time << " "
+			<< r.reduced << " " << r.estimate << endl;
+	}
+}
+
+} /* end of namespace */
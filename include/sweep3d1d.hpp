@@ -0,0 +1,148 @@
+/* -*- c++ -*- (enables emacs c++ mode) */
+/*======================================================================
+    "Mixed Finite Element Methods for Coupled 3D/1D Fluid Problems"
+
+              Copyright (C) 2026 M3D1D contributors
+======================================================================*/
+/*!
+  @file   sweep3d1d.hpp
+  @author M3D1D contributors
+  @date   October 2026.
+  @brief  Declaration of the parameter sweep of the coupled 3D/1D problem.
+  @details
+	A parameter set is given by factors on the values of the .param file:
+	- LP    : vessel wall permeability (i.e. @f$Q@f$),
+	- SIGMA : reflection coefficient,
+	- Q_LF  : lymphatic permeability (linear drainage),
+	- P_IN  : pressures imposed at the inflow DIR nodes of the network,
+	- KT    : tissue conductivity,
+	- KV    : vessel bed conductivity.
+
+	The monolithic system is affine in these factors:
+	@f[ A(f) = A_0 + (f_{k_t}^{-1}-1)\,A_{kt} + (f_{L_p}-1)\,A_{ex} + (f_{k_v}^{-1}-1)\,A_{kv} + (f_{Q_{LF}}-1)\,A_{lf} @f]
+	@f[ F(f) = F_0 + (f_{L_p} f_{\sigma}-1)\,F_{onc} + (f_{Q_{LF}}-1)\,F_{lf} + (f_{P_{in}}-1)\,F_{in} @f]
+	where @f$A_{kt}@f$ and @f$A_{kv}@f$ are the tissue and vessel mass
+	matrices of the Darcy and Poiseuille problems (without the boundary
+	terms), @f$A_{ex}@f$ holds the exchange blocks, @f$A_{lf}@f$ the lymphatic
+	sink, @f$F_{onc}@f$ the oncotic term, @f$F_{lf}@f$ the lymphatic
+	pressure term and @f$F_{in}@f$ the inflow boundary term. Meshes, FEMs,
+	@f$\bar{\Pi}_{tv}@f$, @f$\Pi_{tv}@f$ and the boundary/junction lists
+	are built once, each parameter set only rescales the blocks.
+
+	\ingroup input
+ */
+#ifndef M3D1D_SWEEP3D1D_HPP_
+#define M3D1D_SWEEP3D1D_HPP_
+
+#include <gmm/gmm.h>
+#include <string>
+#include <vector>
+#include <defines.hpp>
+
+namespace getfem {
+
+//! Parameter set of the sweep (factors on the values of the .param file)
+struct sweep_point {
+
+	//! Name of the parameter set (first column of the summary table)
+	std::string name;
+	//! Factor on the vessel wall permeability
+	scalar_type Lp;
+	//! Factor on the reflection coefficient
+	scalar_type sigma;
+	//! Factor on the lymphatic permeability
+	scalar_type Q_LF;
+	//! Factor on the pressures imposed at the inflow DIR nodes
+	scalar_type P_in;
+	//! Factor on the tissue conductivity
+	scalar_type kt;
+	//! Factor on the vessel bed conductivity
+	scalar_type kv;
+
+	sweep_point(void) : name(""), Lp(1.0), sigma(1.0), Q_LF(1.0), P_in(1.0),
+		kt(1.0), kv(1.0) {}
+};
+
+//! Result of a parameter set (plain data, sent back by the worker processes)
+struct sweep_result {
+
+	//! Index of the parameter set
+	size_type point;
+	//! 1 if the solve succeeded
+	int converged;
+	//! Total flow rate from network to tissue
+	scalar_type TFR;
+	//! Total flow rate of the lymphatic system
+	scalar_type FRlymph;
+	//! Total flow rate from the cube
+	scalar_type FRCube;
+	//! Mean tissue pressure
+	scalar_type mean_pt;
+	//! Mean vessel pressure
+	scalar_type mean_pv;
+	//! Wall time of the solve [s]
+	scalar_type time;
+	//! 1 if answered by the reduced model (see rom3d1d.hpp)
+	int reduced;
+	//! Error estimate of the reduced model (relative residual, 0 without surrogate)
+	scalar_type estimate;
+
+	sweep_result(void) : point(0), converged(0), TFR(0.0), FRlymph(0.0),
+		FRCube(0.0), mean_pt(0.0), mean_pv(0.0), time(0.0), reduced(0),
+		estimate(0.0) {}
+};
+
+//! Affine decomposition of the monolithic system in the sweep factors
+struct sweep_system {
+
+	//! True if the assembly also builds the decomposition
+	bool enabled;
+	//! Monolithic matrix and rhs of the .param values
+	sparse_matrix_type AM0;
+	vector_type        FM0;
+	//! Tissue mass (linear in 1/kt), exchange blocks (linear in Lp),
+	//! vessel mass (linear in 1/kv) and lymphatic sink (linear in Q_LF)
+	sparse_matrix_type Akt, Aex, Akv, Alf;
+	//! Oncotic (Lp*sigma), lymphatic (Q_LF) and inflow (P_IN) rhs terms
+	vector_type Fonc, Flf, Fin;
+	//! Parameters of the .param file
+	vector_type Q0, sigma_vec0, Q_LF0, kt0, kv0;
+	scalar_type sigma0;
+
+	sweep_system(void) : enabled(false), sigma0(0.0) {}
+
+	//! Allocate the (empty) decomposition of a system of size n
+	void init(size_type n);
+	//! Build the system of a parameter set
+	void build(const sweep_point & p, sparse_matrix_type & AM, vector_type & FM) const;
+
+	//! Number of terms of the matrix (AM0, Akt, Aex, Akv, Alf)
+	static size_type nb_mat_terms(void) { return 5; }
+	//! Number of terms of the rhs (FM0, Fonc, Flf, Fin)
+	static size_type nb_rhs_terms(void) { return 4; }
+	//! Coefficients of the matrix terms for a parameter set (1 for AM0)
+	static void theta_mat(const sweep_point & p, vector_type & theta);
+	//! Coefficients of the rhs terms for a parameter set (1 for FM0)
+	static void theta_rhs(const sweep_point & p, vector_type & theta);
+	//! Matrix term q
+	const sparse_matrix_type & mat_term(size_type q) const;
+	//! Rhs term q
+	const vector_type & rhs_term(size_type q) const;
+};
+
+//! Read the parameter sets of the sweep
+/*!
+	The first line (after the comments '%' or '#') lists the columns among
+	NAME, LP, SIGMA, Q_LF, P_IN, KT, KV; each following line is a parameter set.
+	Missing columns are 1 (the value of the .param file).
+ */
+void read_sweep_file(const std::string & fname, std::vector<sweep_point> & points);
+
+//! Write the summary table of the sweep (one line per parameter set)
+void write_sweep_table(const std::string & fname,
+	const std::vector<sweep_point> & points,
+	const std::vector<sweep_result> & results);
+
+} /* end of namespace */
+
+#endif
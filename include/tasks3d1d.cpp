@@ -0,0 +1,180 @@
+/* -*- c++ -*- (enables emacs c++ mode) */
+/*======================================================================
+    "Mixed Finite Element Methods for Coupled 3D/1D Fluid Problems"
+
+              Copyright (C) 2026 M3D1D contributors
+======================================================================*/
+/*!
+  @file   tasks3d1d.cpp
+  @author M3D1D contributors
+  @date   October 2026.
+  @brief  Definition of the task graph of the setup phases.
+ */
+
+#include <tasks3d1d.hpp>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace getfem {
+
+size_type
+task_graph::add(const std::string & name, std::function<void(void)> fn,
+	const std::vector<size_type> & deps)
+{
+	const size_type id = tasks_.size();
+	for (size_type d : deps)
+		GMM_ASSERT1(d < id, "task " << name << ": unknown dependency " << d);
+	task t;
+	t.name = name;
+	t.fn = fn;
+	t.deps = deps;
+	t.start = t.time = 0.0;
+	t.worker = 0;
+	t.serial = false;
+	tasks_.push_back(t);
+	for (size_type d : deps) tasks_[d].succ.push_back(id);
+	return id;
+}
+
+size_type
+task_graph::add_serial(const std::string & name, std::function<void(void)> fn,
+	const std::vector<size_type> & deps)
+{
+	const size_type id = add(name, fn, deps);
+	tasks_[id].serial = true;
+	return id;
+}
+
+void
+task_graph::run(size_type nb_workers)
+{
+	const size_type n = tasks_.size();
+	nb_workers_ = std::max<size_type>(1, std::min(nb_workers, n));
+	#ifndef _OPENMP
+	nb_workers_ = 1;
+	#endif
+	if (n == 0) return;
+	const scalar_type t0 = metrics3d1d::wall_time();
+	if (nb_workers_ == 1) {
+		// The order of insertion is a topological order
+		for (task & t : tasks_) {
+			t.worker = 0;
+			t.start = metrics3d1d::wall_time() - t0;
+			t.fn();
+			t.time = metrics3d1d::wall_time() - t0 - t.start;
+		}
+		wall_ = metrics3d1d::wall_time() - t0;
+		return;
+	}
+
+	// Concurrent tasks spawned as OpenMP tasks once their dependencies are
+	// done, so that GetFEM sees the workers as OpenMP threads (its
+	// thread-safe storage is indexed by omp_get_thread_num). The serial
+	// tasks, and the tasks made ready by them, wait in ready
+	std::unique_ptr< std::atomic<size_type>[] > pending(new std::atomic<size_type>[n]);
+	std::atomic<bool> failed(false);
+	std::exception_ptr error;
+	std::mutex error_m, ready_m;
+	std::vector<size_type> ready;
+	for (size_type i = 0; i < n; ++i) {
+		pending[i] = tasks_[i].deps.size();
+		if (tasks_[i].deps.empty()) ready.push_back(i);
+	}
+
+	std::function<void(size_type, bool)> exec = [&](size_type id, bool parallel) {
+		task & t = tasks_[id];
+		t.worker = 0;
+		#ifdef _OPENMP
+		if (parallel) t.worker = size_type(omp_get_thread_num());
+		#endif
+		t.start = metrics3d1d::wall_time() - t0;
+		if (!failed) {
+			try { t.fn(); }
+			catch (...) {
+				std::lock_guard<std::mutex> lock(error_m);
+				if (!error) error = std::current_exception();
+				failed = true;
+			}
+		}
+		t.time = metrics3d1d::wall_time() - t0 - t.start;
+		for (size_type s : t.succ)
+			if (--pending[s] == 0) {
+				if (parallel && !tasks_[s].serial) {
+					#pragma omp task firstprivate(s) shared(exec)
+					exec(s, true);
+				}
+				else {
+					std::lock_guard<std::mutex> lock(ready_m);
+					ready.push_back(s);
+				}
+			}
+	};
+
+	while (!ready.empty()) {
+		std::vector<size_type> round;
+		round.swap(ready);
+		std::sort(round.begin(), round.end());
+		std::vector<size_type> roots;
+		for (size_type id : round) {
+			if (tasks_[id].serial) exec(id, false);
+			else roots.push_back(id);
+		}
+		if (roots.empty()) continue;
+		#pragma omp parallel num_threads(int(nb_workers_))
+		{
+			#pragma omp single
+			{
+				for (size_type id : roots) {
+					#pragma omp task firstprivate(id) shared(exec)
+					exec(id, true);
+				}
+			}
+		} // the implicit barrier waits for all the tasks
+	}
+	wall_ = metrics3d1d::wall_time() - t0;
+	if (error) std::rethrow_exception(error);
+}
+
+void
+task_graph::print(std::ostream & out) const
+{
+	scalar_type work = 0.0;
+	for (const task & t : tasks_) work += t.time;
+	std::ios::fmtflags flags = out.flags();
+	std::streamsize prec = out.precision();
+	out << "---- SETUP TASKS (" << nb_workers_ << " worker(s)) ---------------" << endl;
+	out << std::fixed << std::setprecision(3);
+	for (const task & t : tasks_) {
+		std::string deps;
+		for (size_type d : t.deps) deps += (deps.empty() ? "" : ", ") + tasks_[d].name;
+		out << "  " << std::left << std::setw(24) << t.name << std::right
+		    << " start " << std::setw(8) << t.start << " s, time " << std::setw(8) << t.time
+		    << " s, worker " << t.worker << (t.serial ? " (serial)" : "")
+		    << "  <- " << (deps.empty() ? "(none)" : deps) << endl;
+	}
+	out << "  total work " << work << " s, wall time " << wall_ << " s" << endl;
+	out << "--------------------------------------------------" << endl;
+	out.flags(flags);
+	out.precision(prec);
+}
+
+void
+task_graph::write(metrics3d1d & metrics) const
+{
+	if (!metrics.enabled()) return;
+	for (const task & t : tasks_) {
+		metrics_record rec("phase");
+		rec.add("name", t.name).add("wall_s", t.time)
+		   .add("start_s", t.start).add("worker", t.worker);
+		metrics.write(rec);
+	}
+}
+
+} /* end of namespace */
@@ -0,0 +1,97 @@
+/* -*- c++ -*- (enables emacs c++ mode) */
+/*======================================================================
+    "Mixed Finite Element Methods for Coupled 3D/1D Fluid Problems"
+
+              Copyright (C) 2026 M3D1D contributors
+======================================================================*/
+/*!
+  @file   tasks3d1d.hpp
+  @author M3D1D contributors
+  @date   October 2026.
+  @brief  Declaration of the task graph of the setup phases.
+  @details
+	The setup of a problem (mesh import, FEMs, parameters, boundary data)
+	is a small graph of tasks: a task starts when all its dependencies
+	are done. The graph runs in an OpenMP parallel region: a task is
+	spawned as an OpenMP task when its last dependency completes. GetFEM
+	keys its thread-safe storage on omp_get_thread_num, so the workers
+	must be OpenMP threads, not raw threads. With one worker, or without
+	OpenMP, the tasks run in the calling thread in the order of insertion.
+
+	Two tasks without a path between them may run at the same time: they
+	must not touch the same mesh (adding a region or a mesh_fem to a mesh
+	modifies it). Concurrent setup also needs a GetFEM library built with
+	OpenMP, whose global descriptor tables (FEMs, integration methods,
+	geometric transformations) are protected by locks.
+
+	In an OpenMP build GetFEM splits the mesh regions among the threads of
+	a parallel region: a region visited (mr_visitor, assembly, dof
+	enumeration) from a worker thread yields only the part of that
+	thread. The tasks that visit a region or assemble are added with
+	add_serial: they run alone, in the calling thread, outside the
+	parallel region.
+
+	\ingroup input
+ */
+#ifndef M3D1D_TASKS3D1D_HPP_
+#define M3D1D_TASKS3D1D_HPP_
+
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <defines.hpp>
+#include <metrics3d1d.hpp>
+
+namespace getfem {
+
+//! Graph of the setup tasks, executed as OpenMP tasks
+class task_graph {
+
+public:
+	task_graph(void) : nb_workers_(0), wall_(0.0) {}
+
+	//! Add a task depending on the tasks deps (already added); returns its index
+	size_type add(const std::string & name, std::function<void(void)> fn,
+		const std::vector<size_type> & deps = std::vector<size_type>());
+	//! Add a task run alone in the calling thread, outside the parallel region
+	size_type add_serial(const std::string & name, std::function<void(void)> fn,
+		const std::vector<size_type> & deps = std::vector<size_type>());
+	//! Run all the tasks on nb_workers OpenMP threads (the calling thread is one of them)
+	/*!
+		The ready serial tasks run first, one after the other; then the
+		ready concurrent tasks run in a parallel region, which ends when no
+		concurrent task is left. The serial tasks made ready meanwhile
+		start the next round. The first exception thrown by a task is
+		rethrown at the end; the tasks not yet started are skipped.
+	 */
+	void run(size_type nb_workers);
+	//! Number of tasks
+	inline size_type size(void) const { return tasks_.size(); }
+	//! Print the dependency graph and the timings of the last run
+	void print(std::ostream & out) const;
+	//! Write a "phase" record per task (with start time and worker)
+	void write(metrics3d1d & metrics) const;
+
+private:
+	struct task {
+		std::string name;
+		std::function<void(void)> fn;
+		std::vector<size_type> deps, succ;
+		//! Start time (since the start of the run) and wall time [s]
+		scalar_type start, time;
+		//! Worker that ran the task
+		size_type worker;
+		//! True if the task runs outside the parallel region
+		bool serial;
+	};
+	std::vector<task> tasks_;
+	//! Number of workers and wall time of the last run
+	size_type nb_workers_;
+	scalar_type wall_;
+
+}; /* end of class */
+
+} /* end of namespace */
+
+#endif
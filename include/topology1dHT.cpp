@@ -0,0 +1,215 @@
+/* -*- c++ -*- (enables emacs c++ mode) */
+/*======================================================================
+    "Mixed Finite Element Methods for Coupled 3D/1D Fluid Problems"
+
+              Copyright (C) 2026 M3D1D contributors
+======================================================================*/
+/*!
+  @file   topology1dHT.cpp
+  @author M3D1D contributors
+  @date   October 2026.
+  @brief  Definition of the oriented topology of the vessel network.
+ */
+
+#include <topology1dHT.hpp>
+#include <algorithm>
+
+namespace getfem {
+
+const size_type network_topology::none;
+
+void
+network_topology::build(const mesh & meshh,
+	const std::vector<mesh_fem> & mf_u,
+	const std::vector<mesh_fem> & mf_h,
+	const std::vector<node> & Jv,
+	const std::vector<node> & BCv)
+{
+	size_type nb_branches = mf_h.size();
+	GMM_ASSERT1(mf_u.size() == nb_branches, "network topology: velocity and hematocrit branches differ");
+	nb_jun_ = Jv.size();
+	size_type nb_nodes = nb_jun_ + BCv.size();
+
+	// End dofs of each branch (first and last dof of the branch region)
+	hshift_.assign(nb_branches, 0);
+	hdof_.assign(2*nb_branches, 0);
+	udof_.assign(2*nb_branches, 0);
+	size_type shift_u = 0;
+	for (size_type i = 0; i < nb_branches; ++i) {
+		if (i > 0) hshift_[i] = hshift_[i-1] + mf_h[i-1].nb_dof();
+		if (i > 0) shift_u += mf_u[i-1].nb_dof();
+		vector_size_type dof_enum, dofu_enum;
+		for (getfem::mr_visitor mrv(mf_h[i].linked_mesh().region(i)); !mrv.finished(); ++mrv)
+			for (auto b : mf_h[i].ind_basic_dof_of_element(mrv.cv()))
+				dof_enum.emplace_back(b);
+		for (getfem::mr_visitor mrv(mf_u[i].linked_mesh().region(i)); !mrv.finished(); ++mrv)
+			for (auto ub : mf_u[i].ind_basic_dof_of_element(mrv.cv()))
+				dofu_enum.emplace_back(ub);
+		GMM_ASSERT1(!dof_enum.empty() && !dofu_enum.empty(), "network topology: empty branch " << i);
+		hdof_[2*i]   = hshift_[i] + dof_enum.front();
+		hdof_[2*i+1] = hshift_[i] + dof_enum.back();
+		udof_[2*i]   = shift_u + dofu_enum.front();
+		udof_[2*i+1] = shift_u + dofu_enum.back();
+	}
+
+	// Nodes at the ends of each branch
+	start_.assign(nb_branches, none);
+	end_node_.assign(nb_branches, none);
+	for (size_type j = 0; j < nb_jun_; ++j)
+		for (auto b : Jv[j].branches) {
+			if (b < 0) start_[-b] = j;
+			else end_node_[b] = j;
+		}
+	bc_label_.resize(BCv.size());
+	for (size_type bc = 0; bc < BCv.size(); ++bc) {
+		bc_label_[bc] = BCv[bc].label;
+		if (BCv[bc].branches.empty()) continue;
+		size_type i = abs(BCv[bc].branches[0]);
+		// The single-face region tells which extremum of the branch is the node
+		for (getfem::mr_visitor mrv(meshh.region(BCv[bc].rg)); !mrv.finished(); ++mrv) {
+			if (mrv.f() == 1) start_[i] = nb_jun_ + bc;
+			else end_node_[i] = nb_jun_ + bc;
+		}
+	}
+
+	// CSR incidence (all the slots in the outflow partition until the first update)
+	ptr_.assign(nb_nodes+1, 0);
+	for (size_type i = 0; i < nb_branches; ++i) {
+		if (start_[i] != none) ptr_[start_[i]+1]++;
+		if (end_node_[i] != none) ptr_[end_node_[i]+1]++;
+	}
+	for (size_type n = 0; n < nb_nodes; ++n) ptr_[n+1] += ptr_[n];
+	split_.assign(ptr_.begin(), ptr_.end()-1);
+	adj_.assign(ptr_[nb_nodes], 0);
+	end_.assign(ptr_[nb_nodes], 0);
+	slot_.assign(2*nb_branches, none);
+	vector_size_type fill(split_);
+	for (size_type i = 0; i < nb_branches; ++i)
+		for (size_type e = 0; e < 2; ++e) {
+			size_type n = node_of(i, e);
+			if (n == none) continue;
+			slot_[2*i+e] = fill[n];
+			adj_[fill[n]] = i;
+			end_[fill[n]] = e;
+			fill[n]++;
+		}
+
+	Q_.assign(2*nb_branches, 0.0);
+	reversed_.clear();
+	is_reversed_.assign(nb_branches, false);
+	nb_flips_ = 0;
+	oriented_ = false;
+}
+
+void
+network_topology::move_slot(size_type i, size_type e)
+{
+	size_type n = node_of(i, e);
+	if (n == none) return;
+	size_type s = slot_[2*i+e];
+	bool is_in = (s < split_[n]);
+	if (inflow(i, e) == is_in) return;
+	// Swap with the slot at the boundary of the two partitions
+	size_type t = is_in ? split_[n]-1 : split_[n];
+	if (is_in) split_[n]--; else split_[n]++;
+	if (s == t) return;
+	std::swap(adj_[s], adj_[t]);
+	std::swap(end_[s], end_[t]);
+	slot_[2*adj_[s]+end_[s]] = s;
+	slot_[2*adj_[t]+end_[t]] = t;
+}
+
+size_type
+network_topology::update(const vector_type & Uv, const vector_type & area)
+{
+	size_type nb_branches = start_.size();
+	GMM_ASSERT1(area.size() == nb_branches, "network topology: one area per branch is required");
+	nb_flips_ = 0;
+	for (size_type i = 0; i < nb_branches; ++i) {
+		scalar_type Qs = area[i]*Uv[udof_[2*i]];
+		scalar_type Qe = area[i]*Uv[udof_[2*i+1]];
+		bool changed = !oriented_ || (Qs < 0) != (Q_[2*i] < 0) || (Qe < 0) != (Q_[2*i+1] < 0);
+		Q_[2*i] = Qs; Q_[2*i+1] = Qe;
+		if (!changed) continue;
+		nb_flips_++;
+		move_slot(i, 0);
+		move_slot(i, 1);
+		bool rev = ((Qs < 0) != (Qe < 0));
+		if (rev != is_reversed_[i]) {
+			is_reversed_[i] = rev;
+			auto it = std::lower_bound(reversed_.begin(), reversed_.end(), i);
+			if (rev) reversed_.insert(it, i);
+			else reversed_.erase(it);
+		}
+	}
+	oriented_ = true;
+	return nb_flips_;
+}
+
+void
+network_topology::label_boundary(std::vector<node> & BCv) const
+{
+	GMM_ASSERT1(BCv.size() == bc_label_.size(), "network topology: boundary list has changed");
+	for (size_type bc = 0; bc < BCv.size(); ++bc) {
+		size_type n = nb_jun_ + bc;
+		if (ptr_[n+1] == ptr_[n]) continue;
+		// Blood enters the network if the branch leaves the node
+		BCv[bc].label = (nb_out(n) > 0) ? bc_label_[bc] : "OUT";
+	}
+}
+
+
+vector_size_type
+flux_balance::worst(size_type nb) const
+{
+	vector_size_type idx;
+	for (size_type n = 0; n < rel_rbc.size(); ++n)
+		if (rel_rbc[n] > 0) idx.emplace_back(n);
+	nb = std::min(nb, idx.size());
+	std::partial_sort(idx.begin(), idx.begin()+nb, idx.end(),
+		[this](size_type a, size_type b){ return rel_rbc[a] > rel_rbc[b]; });
+	idx.resize(nb);
+	return idx;
+}
+
+void
+network_balance(const network_topology & T, const vector_type & H, flux_balance & B)
+{
+	GMM_ASSERT1(T.oriented(), "network topology not updated with the velocity");
+	size_type nb_nodes = T.nb_nodes();
+	B.plasma.assign(nb_nodes, 0.0);  B.rbc.assign(nb_nodes, 0.0);
+	B.rel_plasma.assign(nb_nodes, 0.0); B.rel_rbc.assign(nb_nodes, 0.0);
+	B.plasma_in = B.rbc_in = B.plasma_out = B.rbc_out = 0.0;
+	scalar_type sum_plasma = 0.0, sum_rbc = 0.0;
+
+	for (size_type n = 0; n < nb_nodes; ++n) {
+		scalar_type Q_in = 0.0, F_in = 0.0, Q_out = 0.0, F_out = 0.0;
+		for (size_type k = 0; k < T.nb_in(n); ++k) {
+			size_type i = T.in_branch(n,k), e = T.in_end(n,k);
+			scalar_type Q = fabs(T.Q(i,e));
+			Q_in += Q; F_in += Q*H[T.h_dof(i,e)];
+		}
+		for (size_type k = 0; k < T.nb_out(n); ++k) {
+			size_type i = T.out_branch(n,k), e = T.out_end(n,k);
+			scalar_type Q = fabs(T.Q(i,e));
+			Q_out += Q; F_out += Q*H[T.h_dof(i,e)];
+		}
+		if (T.is_boundary(n)) {
+			// The outflow of a boundary node enters the network
+			B.plasma_in += Q_out; B.rbc_in += F_out;
+			B.plasma_out += Q_in; B.rbc_out += F_in;
+			continue;
+		}
+		B.plasma[n] = Q_in - Q_out;
+		B.rbc[n]    = F_in - F_out;
+		scalar_type Q_ref = std::max(Q_in, Q_out), F_ref = std::max(F_in, F_out);
+		if (Q_ref > 0) B.rel_plasma[n] = fabs(B.plasma[n])/Q_ref;
+		if (F_ref > 0) B.rel_rbc[n]    = fabs(B.rbc[n])/F_ref;
+		sum_plasma += fabs(B.plasma[n]);
+		sum_rbc    += fabs(B.rbc[n]);
+	}
+	B.global_plasma = (B.plasma_in > 0) ? sum_plasma/B.plasma_in : sum_plasma;
+	B.global_rbc    = (B.rbc_in > 0) ? sum_rbc/B.rbc_in : sum_rbc;
+}
+
+} /* end of namespace */
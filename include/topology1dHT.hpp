@@ -0,0 +1,192 @@
+/* -*- c++ -*- (enables emacs c++ mode) */
+/*======================================================================
+    "Mixed Finite Element Methods for Coupled 3D/1D Fluid Problems"
+
+              Copyright (C) 2026 M3D1D contributors
+======================================================================*/
+/*!
+  @file   topology1dHT.hpp
+  @author M3D1D contributors
+  @date   October 2026.
+  @brief  Declaration of the oriented topology of the vessel network.
+  @details
+	The nodes of the network are the junctions (0..J-1, same order of the
+	junction list) followed by the boundary nodes (J..J+B-1, same order of
+	the boundary list). The incidence node-branch is stored in CSR form:
+	the slots of node n are [ptr[n], ptr[n+1]) and are partitioned into
+	inflow branches [ptr[n], split[n]) and outflow branches
+	[split[n], ptr[n+1]).
+
+	The geometry is built once; the flow roles are updated from the
+	velocity with update(): only the branches whose sign at an end has
+	changed are moved between the two partitions.
+ */
+
+#ifndef M3D1D_TOPOLOGY1DHT_HPP_
+#define M3D1D_TOPOLOGY1DHT_HPP_
+
+#include <getfem/getfem_mesh.h>
+#include <getfem/getfem_mesh_fem.h>
+#include <defines.hpp>
+#include <node.hpp>
+
+namespace getfem {
+
+//! Class to handle the oriented topology of the vessel network
+class network_topology {
+
+public:
+	//! Index of a missing node
+	static const size_type none = size_type(-1);
+
+	network_topology(void) : nb_jun_(0), nb_flips_(0), oriented_(false) {}
+
+	//! Build the incidence node-branch and the end dofs of each branch
+	/*!
+		@param meshh  Mesh of the hematocrit problem (single-face regions of the boundary nodes)
+		@param mf_u   The finite element methods for the velocity (one per branch)
+		@param mf_h   The finite element methods for the hematocrit (one per branch)
+		@param Jv     List of junction nodes
+		@param BCv    List of boundary nodes (the labels are the inlet conditions)
+	 */
+	void build(const mesh & meshh,
+		const std::vector<mesh_fem> & mf_u,
+		const std::vector<mesh_fem> & mf_h,
+		const std::vector<node> & Jv,
+		const std::vector<node> & BCv);
+
+	//! Update the flow roles from the velocity (returns the number of branches that changed)
+	/*!
+		@param Uv    Velocity of the network (all branches)
+		@param area  Cross section area of each branch
+	 */
+	size_type update(const vector_type & Uv, const vector_type & area);
+
+	//! Set the labels of the boundary nodes: outflow nodes are "OUT", inflow nodes keep their condition
+	void label_boundary(std::vector<node> & BCv) const;
+
+	//! Number of branches
+	inline size_type nb_branches(void) const { return start_.size(); }
+	//! Number of nodes (junctions and boundary nodes)
+	inline size_type nb_nodes(void) const { return ptr_.size()-1; }
+	//! Number of junctions
+	inline size_type nb_junctions(void) const { return nb_jun_; }
+	//! True if node n is a boundary node
+	inline bool is_boundary(size_type n) const { return n >= nb_jun_; }
+	//! Index of the boundary node n in the boundary list
+	inline size_type boundary_index(size_type n) const { return n - nb_jun_; }
+	//! True if the roles have been computed at least once
+	inline bool oriented(void) const { return oriented_; }
+
+	//! Number of inflow branches of node n
+	inline size_type nb_in(size_type n) const { return split_[n] - ptr_[n]; }
+	//! Number of outflow branches of node n
+	inline size_type nb_out(size_type n) const { return ptr_[n+1] - split_[n]; }
+	//! k-th inflow branch of node n
+	inline size_type in_branch(size_type n, size_type k) const { return adj_[ptr_[n]+k]; }
+	//! k-th outflow branch of node n
+	inline size_type out_branch(size_type n, size_type k) const { return adj_[split_[n]+k]; }
+	//! End (0 = start, 1 = end) of the k-th inflow branch of node n
+	inline size_type in_end(size_type n, size_type k) const { return end_[ptr_[n]+k]; }
+	//! End (0 = start, 1 = end) of the k-th outflow branch of node n
+	inline size_type out_end(size_type n, size_type k) const { return end_[split_[n]+k]; }
+
+	//! Node at the start (e=0) or at the end (e=1) of branch i
+	inline size_type node_of(size_type i, size_type e) const { return e ? end_node_[i] : start_[i]; }
+	//! True if the flow goes from the start to the end of branch i
+	inline bool forward(size_type i) const { return Q_[2*i+1] >= 0; }
+	//! Upstream node of branch i
+	inline size_type upstream(size_type i) const { return forward(i) ? start_[i] : end_node_[i]; }
+	//! Downstream node of branch i
+	inline size_type downstream(size_type i) const { return forward(i) ? end_node_[i] : start_[i]; }
+	//! Flow rate at the start (e=0) or at the end (e=1) of branch i
+	inline scalar_type Q(size_type i, size_type e) const { return Q_[2*i+e]; }
+	//! Global hematocrit dof at the start (e=0) or at the end (e=1) of branch i
+	inline size_type h_dof(size_type i, size_type e) const { return hdof_[2*i+e]; }
+	//! Global velocity dof at the start (e=0) or at the end (e=1) of branch i
+	inline size_type u_dof(size_type i, size_type e) const { return udof_[2*i+e]; }
+	//! First global hematocrit dof of branch i
+	inline size_type h_shift(size_type i) const { return hshift_[i]; }
+	//! Branches with flow reversal (opposite signs at the two ends)
+	inline const vector_size_type & reversed(void) const { return reversed_; }
+	//! Number of branches changed by the last update
+	inline size_type nb_flips(void) const { return nb_flips_; }
+
+	//! Overloading of the output operator
+	friend std::ostream & operator << (
+		std::ostream & out, const network_topology & T
+		)
+	{
+		out << "--- NETWORK TOPOLOGY -------------" << endl;
+		out << "  branches  : " << T.nb_branches() << endl;
+		out << "  junctions : " << T.nb_junctions() << endl;
+		out << "  boundary  : " << T.nb_nodes() - T.nb_junctions() << endl;
+		out << "  reversed  : " << T.reversed_.size() << endl;
+		out << "----------------------------------" << endl;
+		return out;
+	}
+
+private:
+	// Number of junctions
+	size_type nb_jun_;
+	// Nodes at the ends of each branch
+	vector_size_type start_, end_node_;
+	// CSR incidence: offsets, inflow/outflow partition, branch and end of each slot
+	vector_size_type ptr_, split_, adj_, end_;
+	// Slot of each branch end (2*i+e)
+	vector_size_type slot_;
+	// Flow rate, hematocrit and velocity dofs at each branch end (2*i+e)
+	vector_type Q_;
+	vector_size_type hdof_, udof_;
+	// First hematocrit dof of each branch
+	vector_size_type hshift_;
+	// Branches with flow reversal and their flag
+	vector_size_type reversed_;
+	std::vector<bool> is_reversed_;
+	// Inlet condition of each boundary node
+	std::vector<std::string> bc_label_;
+	size_type nb_flips_;
+	bool oriented_;
+
+	//! True if the flow enters node_of(i,e) through the end e of branch i
+	inline bool inflow(size_type i, size_type e) const
+	{ return e ? Q_[2*i+1] >= 0 : Q_[2*i] < 0; }
+	//! Move the slot of the end e of branch i to the right partition of its node
+	void move_slot(size_type i, size_type e);
+
+}; /* end of class */
+
+
+//! RBC and plasma flux balance of the nodes of the network
+/*!
+	The fluxes of each branch end are @f$ |Q| @f$ (plasma) and @f$ |Q| H @f$ 
+	(RBC), with @f$ H @f$ at the end dof of the branch. At a junction the
+	net inflow should vanish; the global imbalance is the sum of the 
+	absolute net inflows at the junctions over the inflow of the network.
+ */
+struct flux_balance {
+
+	//! Net plasma and RBC inflow at each node (junctions, then boundary nodes)
+	vector_type plasma, rbc;
+	//! Net inflow over the largest between inflow and outflow at each node
+	vector_type rel_plasma, rel_rbc;
+	//! Plasma and RBC flux entering the network through the boundary
+	scalar_type plasma_in, rbc_in;
+	//! Plasma and RBC flux leaving the network through the boundary
+	scalar_type plasma_out, rbc_out;
+	//! Global plasma and RBC imbalance at the junctions
+	scalar_type global_plasma, global_rbc;
+
+	flux_balance(void) : plasma_in(0), rbc_in(0), plasma_out(0), rbc_out(0),
+		global_plasma(0), global_rbc(0) {}
+
+	//! Junctions with the largest relative RBC imbalance (at most nb, decreasing order)
+	vector_size_type worst(size_type nb) const;
+};
+
+//! Compute the flux balance of every node from the topology and the hematocrit
+void network_balance(const network_topology & T, const vector_type & H, flux_balance & B);
+
+} /* end of namespace */
+
+#endif
@@ -0,0 +1,98 @@
+/* -*- c++ -*- (enables emacs c++ mode) */
+/*======================================================================
+    "Mixed Finite Element Methods for Coupled 3D/1D Fluid Problems"
+
+              Copyright (C) 2026 M3D1D contributors
+======================================================================*/
+/*!
+  @file   transient3d1d.cpp
+  @author M3D1D contributors
+  @date   October 2026.
+  @brief  Definition of the time integration of the coupled 3D/1D problem.
+ */
+
+#include <transient3d1d.hpp>
+#include <sstream>
+#include <iomanip>
+#include <cmath>
+
+namespace getfem {
+
+size_type
+transient_system::nb_steps(void) const
+{
+	GMM_ASSERT1(dt > 0.0 && t_end > 0.0, "transient: TIME_STEP and T_END must be positive");
+	return size_type(std::ceil(t_end/dt - 1E-9));
+}
+
+scalar_type
+transient_system::inflow_factor(scalar_type t) const
+{
+	if (profile_t.empty()) return 1.0;
+	if (t <= profile_t.front()) return profile_g.front();
+	if (t >= profile_t.back()) return profile_g.back();
+	size_type k = 1;
+	while (profile_t[k] < t) ++k;
+	scalar_type w = (t - profile_t[k-1])/(profile_t[k] - profile_t[k-1]);
+	return (1.0 - w)*profile_g[k-1] + w*profile_g[k];
+}
+
+void
+read_inflow_profile(const std::string & fname, transient_system & ts)
+{
+	std::ifstream ifs(fname);
+	GMM_ASSERT1(ifs.good(), "impossible to read inflow profile " << fname);
+	ts.profile_t.clear();
+	ts.profile_g.clear();
+	std::string line;
+	size_type nline = 0;
+	while (std::getline(ifs, line)) {
+		++nline;
+		std::istringstream iss(line);
+		std::string tok;
+		if (!(iss >> tok) || tok[0] == '%' || tok[0] == '#') continue;
+		scalar_type t = std::stod(tok), g;
+		GMM_ASSERT1(iss >> g, "inflow profile: missing factor at line " << nline << " of " << fname);
+		GMM_ASSERT1(ts.profile_t.empty() || t > ts.profile_t.back(),
+			"inflow profile: the times must be increasing (line " << nline << " of " << fname << ")");
+		ts.profile_t.push_back(t);
+		ts.profile_g.push_back(g);
+	}
+	GMM_ASSERT1(!ts.profile_t.empty(), "inflow profile: no value in " << fname);
+}
+
+void
+transient_writer::open(const std::string & out, bool fields)
+{
+	table_.open(out + "transient.txt");
+	GMM_ASSERT1(table_.good(), "impossible to write " << out << "transient.txt");
+	table_ << "% STEP TIME INFLOW TFR FR_LYMPH FR_CUBE PT_MEAN PV_MEAN ITERATIONS" << endl;
+	table_ << std::setprecision(10);
+	if (!fields) return;
+	pt_.open(out + "transient_Pt.bin", std::ios::binary);
+	pv_.open(out + "transient_Pv.bin", std::ios::binary);
+	GMM_ASSERT1(pt_.good() && pv_.good(), "impossible to write the transient fields in " << out);
+}
+
+void
+transient_writer::write_step(size_type step, scalar_type t, scalar_type g,
+	scalar_type tfr, scalar_type frlymph, scalar_type frcube,
+	scalar_type mean_pt, scalar_type mean_pv, size_type iterations)
+{
+	table_ << step << " " << t << " " << g << " " << tfr << " " << frlymph << " "
+	       << frcube << " " << mean_pt << " " << mean_pv << " " << iterations << std::endl;
+}
+
+void
+transient_writer::write_fields(scalar_type t, const vector_type & Pt, const vector_type & Pv)
+{
+	if (!pt_.is_open()) return;
+	pt_.write(reinterpret_cast<const char *>(&t), sizeof(scalar_type));
+	pt_.write(reinterpret_cast<const char *>(Pt.data()), std::streamsize(Pt.size()*sizeof(scalar_type)));
+	pt_.flush();
+	pv_.write(reinterpret_cast<const char *>(&t), sizeof(scalar_type));
+	pv_.write(reinterpret_cast<const char *>(Pv.data()), std::streamsize(Pv.size()*sizeof(scalar_type)));
+	pv_.flush();
+}
+
+} /* end of namespace */
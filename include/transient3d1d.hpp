@@ -0,0 +1,102 @@
+/* -*- c++ -*- (enables emacs c++ mode) */
+/*======================================================================
+    "Mixed Finite Element Methods for Coupled 3D/1D Fluid Problems"
+
+              Copyright (C) 2026 M3D1D contributors
+======================================================================*/
+/*!
+  @file   transient3d1d.hpp
+  @author M3D1D contributors
+  @date   October 2026.
+  @brief  Declaration of the time integration of the coupled 3D/1D problem.
+  @details
+	Storage terms are added to the tissue and vessel pressure equations:
+	@f[ S\,\frac{dU}{dt} + A\,U = F(t), \qquad
+	    S = \mathrm{diag}(0,\ c_t M_{p_t},\ 0,\ c_v M_{p_v}) , @f]
+	where @f$M_{p_t}@f$, @f$M_{p_v}@f$ are the pressure mass matrices and
+	@f$c_t@f$, @f$c_v@f$ the storage coefficients (STORAGE_T, STORAGE_V).
+	The pressures imposed at the inflow DIR nodes follow a time profile
+	g(t), @f$F(t) = F_0 + (g(t)-1)\,F_{in}@f$ (see sweep3d1d.hpp).
+
+	Backward Euler and BDF2 with a constant time step:
+	@f[ (A + \tfrac{\alpha}{\Delta t} S)\,U^{n+1} = F(t^{n+1}) + \tfrac{1}{\Delta t} S\,(\beta_0 U^n + \beta_1 U^{n-1}) @f]
+	with @f$\alpha = 1, \beta = (1, 0)@f$ (BE) or
+	@f$\alpha = 3/2, \beta = (2, -1/2)@f$ (BDF2). The matrix is the same at
+	each step: it is factorized once (SuperLU) or its preconditioner is
+	built once (GMRES). The initial condition is a steady state, so BDF2
+	starts with @f$U^{-1} = U^0@f$.
+
+	\ingroup input
+ */
+#ifndef M3D1D_TRANSIENT3D1D_HPP_
+#define M3D1D_TRANSIENT3D1D_HPP_
+
+#include <gmm/gmm.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <defines.hpp>
+
+namespace getfem {
+
+//! Time integration settings and storage matrix of the transient problem
+struct transient_system {
+
+	//! Time step and final time
+	scalar_type dt, t_end;
+	//! "BE" (backward Euler) or "BDF2"
+	std::string scheme;
+	//! Storage coefficients of the tissue and vessel pressures
+	scalar_type c_t, c_v;
+	//! Export the pressure fields every export_every steps (0 = never)
+	size_type export_every;
+	//! Time profile of the inflow pressures (piecewise linear, g = 1 if empty)
+	std::vector<scalar_type> profile_t, profile_g;
+	//! Storage matrix S of the monolithic system
+	sparse_matrix_type S;
+
+	transient_system(void) : dt(0.0), t_end(0.0), scheme("BE"), c_t(0.0), c_v(0.0),
+		export_every(0) {}
+
+	//! Number of time steps
+	size_type nb_steps(void) const;
+	//! Factor on the inflow pressures at time t (constant beyond the profile)
+	scalar_type inflow_factor(scalar_type t) const;
+};
+
+//! Read the time profile of the inflow pressures
+/*!
+	Two columns, time and factor on the pressures of the .param file;
+	comment lines start with '%' or '#'. The times must be increasing.
+ */
+void read_inflow_profile(const std::string & fname, transient_system & ts);
+
+//! Incremental output of the transient problem
+/*!
+	- OUTPUT/transient.txt: one line per time step (time, inflow factor,
+	  flow rates, mean pressures, iterations), flushed at each step;
+	- OUTPUT/transient_Pt.bin, transient_Pv.bin: pressure snapshots every
+	  export_every steps, appended as records (double time, then the dof
+	  values as doubles); the dof coordinates are written once to
+	  transient_Pt_dofs.txt and transient_Pv_dofs.txt.
+	The meshes are exported once (export_vtk), not at each step.
+ */
+class transient_writer {
+
+public:
+	//! Open the files in the directory out (fields only if export_every > 0)
+	void open(const std::string & out, bool fields);
+	//! Write the line of a time step
+	void write_step(size_type step, scalar_type t, scalar_type g,
+		scalar_type tfr, scalar_type frlymph, scalar_type frcube,
+		scalar_type mean_pt, scalar_type mean_pv, size_type iterations);
+	//! Append the pressure snapshots of time t
+	void write_fields(scalar_type t, const vector_type & Pt, const vector_type & Pv);
+
+private:
+	std::ofstream table_, pt_, pv_;
+};
+
+} /* end of namespace */
+
+#endif
@@ -20,6 +20,8 @@
 #include <getfem/getfem_mesh.h>
 #include <gmm/gmm.h>
 #include <defines.hpp>
+#include <cstdint>
+#include <iostream>
 
 namespace getfem {
 
@@ -194,6 +196,32 @@ write_col_vector(std::ostream &o, const L &l)
     }
 }
 
+//! Aux function to write a dense vector in binary form (size + raw values)
+template
+<typename VEC>
+void
+write_binary_vector(std::ostream &o, const VEC &V)
+{
+	std::uint64_t n = gmm::vect_size(V);
+	o.write(reinterpret_cast<const char *>(&n), sizeof(n));
+	if (n > 0) o.write(reinterpret_cast<const char *>(&V[0]), n*sizeof(scalar_type));
+}
+
+//! Aux function to read a dense vector written by write_binary_vector
+//! The vector is resized to the stored length
+template
+<typename VEC>
+void
+read_binary_vector(std::istream &i, VEC &V)
+{
+	std::uint64_t n = 0;
+	i.read(reinterpret_cast<char *>(&n), sizeof(n));
+	GMM_ASSERT1(i.good(), "corrupted binary stream: cannot read vector size");
+	gmm::resize(V, n);
+	if (n > 0) i.read(reinterpret_cast<char *>(&V[0]), n*sizeof(scalar_type));
+	GMM_ASSERT1(i.good(), "corrupted binary stream: truncated vector of size " << n);
+}
+
 } /* end of namespace */
 
 #endif
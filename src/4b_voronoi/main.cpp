@@ -54,7 +54,7 @@ int main(int argc, char *argv[])
 			// Solve the problem
 			  if(p.HEMATOCRIT_TRANSPORT(argc, argv))
 				if(1){
-				 if (!p.problem3d1d::solve()) GMM_ASSERT1(false, "solve procedure has failed");
+				 if (!p.solve_initial()) GMM_ASSERT1(false, "solve procedure has failed");
 				 p.init(argc, argv);
 				 if (!p.solve_fixpoint()) GMM_ASSERT1(false, "solve procedure has failed");			
 		// Save results in .vtk format
@@ -48,7 +48,7 @@ int main(int argc, char *argv[])
 			if(p.HEMATOCRIT_TRANSPORT(argc, argv))
 				{
 				//cout << "entro nell'if di hematocrtit transport " << endl;
-				if (!p.problem3d1d::solve()) GMM_ASSERT1(false, "solve procedure has failed");
+				if (!p.solve_initial()) GMM_ASSERT1(false, "solve procedure has failed");
 				p.init(argc, argv);
 				if (!p.solve_fixpoint()) GMM_ASSERT1(false, "solve procedure has failed");			
 
@@ -27,6 +27,9 @@
 #include <iostream>
 #include <getfem/bgeot_config.h> // for FE_ENABLE_EXCEPT
 #include <problemHT.hpp>
+#ifdef WITH_MPI
+#include <mpi.h>
+#endif
 
 using namespace getfem;
 
@@ -36,53 +39,116 @@ int main(int argc, char *argv[])
 
 	GMM_SET_EXCEPTION_DEBUG; // Exceptions make a memory fault, to debug.
 	FE_ENABLE_EXCEPT;        // Enable floating point exception for Nan.
+	#ifdef WITH_MPI
+	MPI_Init(&argc, &argv);
+	#endif
 
 	try {   
-		// Declare a new problem
-		problemHT p;
-		// Initialize the problem
-		p.problem3d1d::init(argc, argv);
-		// Build the monolithic system		
-		p.problem3d1d::assembly();
-			// Solve the problem
-			if(p.HEMATOCRIT_TRANSPORT(argc, argv))
-				{
-				cout << "entro nell'if di hematocrtit transport " << endl;
-				if (!p.problem3d1d::solve()) GMM_ASSERT1(false, "solve procedure has failed");
-                                cout << "init H " << endl;
-				p.init(argc, argv);
-				if (!p.solve_fixpoint()) GMM_ASSERT1(false, "solve procedure has failed");
-			// Save results in .vtk format
-			p.export_vtk();
+		// Command line of each adaptation cycle (-d overrides the files of points)
+		std::vector<std::string> adapt_args;
+		for (size_type cycle = 0; ; ++cycle) {
+			std::vector<char *> args(argv, argv+argc);
+			for (auto & a : adapt_args) args.push_back(&a[0]);
+			int nargs = int(args.size());
+			char ** pargs = args.data();
+			// Declare a new problem
+			problemHT p;
+			// Initialize the problem
+			p.problem3d1d::init(nargs, pargs);
+			// Build the monolithic system		
+			p.problem3d1d::assembly();
+			bool HT = p.HEMATOCRIT_TRANSPORT(nargs, pargs);
+			// Nested iteration: solve the nonlinear problem on the coarse tissue mesh first
+			if (p.problem3d1d::NESTED_ITERATION() && (HT || !p.problem3d1d::LINEAR_LYMPH())) {
+				std::vector<std::string> coarse_args = p.problem3d1d::coarse_level_args();
+				std::vector<char *> cargs(args);
+				for (auto & a : coarse_args) cargs.push_back(&a[0]);
+				int ncargs = int(cargs.size());
+				char ** pcargs = cargs.data();
+				problemHT pc;
+				pc.problem3d1d::init(ncargs, pcargs);
+				pc.problem3d1d::assembly();
+				if (pc.HEMATOCRIT_TRANSPORT(ncargs, pcargs)) {
+					if (!pc.solve_initial()) GMM_ASSERT1(false, "coarse solve procedure has failed");
+					pc.init(ncargs, pcargs);
+					if (!pc.solve_fixpoint()) GMM_ASSERT1(false, "coarse solve procedure has failed");
+					p.set_initial_guess(pc);
+				}
+				else {
+					if (!pc.problem3d1d::solve_fixpoint()) GMM_ASSERT1(false, "coarse solve procedure has failed");
+					p.problem3d1d::set_initial_guess(pc);
+				}
 			}
-			else
-				{if(!p.problem3d1d::LINEAR_LYMPH())
+				// Solve the problem
+				if(HT)
 					{
-					// Solve the problem
-					if (!p.problem3d1d::solve_fixpoint()) GMM_ASSERT1(false, "solve procedure has failed");
+					cout << "entro nell'if di hematocrtit transport " << endl;
+					if (!p.solve_initial()) GMM_ASSERT1(false, "solve procedure has failed");
+	                                cout << "init H " << endl;
+					p.init(nargs, pargs);
+					if (!p.solve_fixpoint()) GMM_ASSERT1(false, "solve procedure has failed");
+					// Adapt the 1D mesh and solve again on the new network
+					if (cycle < p.ADAPT_CYCLES() && p.adapt_network(cycle) > 0){
+						adapt_args = {"-dMESH_FILEV='" + p.adapted_filev() + "'", 
+						              "-dMESH_FILEH='" + p.adapted_fileh() + "'"};
+						continue;
 					}
+				// Save results in .vtk format
+				p.export_vtk();
+				}
 				else
-					{
-					// Solve the problem
-					if (!p.problem3d1d::solve()) GMM_ASSERT1(false, "solve procedure has failed");
-					}
-			}
-		// Save results in .vtk format
-		p.problem3d1d::export_vtk();
+					{if(!p.problem3d1d::LINEAR_LYMPH())
+						{
+						// Solve the problem
+						if (!p.problem3d1d::solve_fixpoint()) GMM_ASSERT1(false, "solve procedure has failed");
+						}
+					else
+						{
+						if (!p.problem3d1d::MESH_FILEV_VENOUS().empty()) {
+						// Venous network on the same tissue (network blocks only)
+						std::vector<std::string> venous_args = {"-dMESH_FILEV='" + p.problem3d1d::MESH_FILEV_VENOUS() + "'"};
+						std::vector<char *> vargs(args);
+						for (auto & a : venous_args) vargs.push_back(&a[0]);
+						problem3d1d pv;
+						pv.init_network_only(int(vargs.size()), vargs.data(), p);
+						pv.assembly_network();
+						// Solve the arterial-venous problem
+						if (!merge_and_solve(p, pv)) GMM_ASSERT1(false, "solve procedure has failed");
+						pv.export_vtk("_venous");
+						}
+						else {
+						// Solve the problem
+						if (!p.problem3d1d::solve()) GMM_ASSERT1(false, "solve procedure has failed");
+						// Per-branch sensitivities of the output (one adjoint solve)
+						if (!p.problem3d1d::ADJOINT_OUTPUT().empty()) {
+							branch_gradient grad;
+							p.problem3d1d::adjoint_gradient(p.problem3d1d::ADJOINT_OUTPUT(), grad);
+							p.problem3d1d::export_gradient(grad, p.problem3d1d::ADJOINT_OUTPUT());
+						}
+						}
+						}
+				}
+			// Save results in .vtk format
+			p.problem3d1d::export_vtk();
 
 
-		// Display some global results: mean pressures, total flow rate
-		std::cout << "--- FINAL RESULTS -------------------------" << std::endl; 
-		std::cout << "  Pt average            = " << p.problem3d1d::mean_pt()   << std::endl;
-		std::cout << "  Pv average            = " << p.problem3d1d::mean_pv()   << std::endl;
-		std::cout << "  Network-to-Tissue TFR = " << p.problem3d1d::flow_rate() << std::endl;
-		std::cout << "  Lymphatic FR          = " << p.problem3d1d::lymph_flow_rate() << std::endl;
-		std::cout << "  FR from the cube      = " << p.problem3d1d::cube_flow_rate() << std::endl;
-		std::cout << "-------------------------------------------" << std::endl; 	
+			// Display some global results: mean pressures, total flow rate
+			std::cout << "--- FINAL RESULTS -------------------------" << std::endl; 
+			std::cout << "  Pt average            = " << p.problem3d1d::mean_pt()   << std::endl;
+			std::cout << "  Pv average            = " << p.problem3d1d::mean_pv()   << std::endl;
+			std::cout << "  Network-to-Tissue TFR = " << p.problem3d1d::flow_rate() << std::endl;
+			std::cout << "  Lymphatic FR          = " << p.problem3d1d::lymph_flow_rate() << std::endl;
+			std::cout << "  FR from the cube      = " << p.problem3d1d::cube_flow_rate() << std::endl;
+			std::cout << "-------------------------------------------" << std::endl; 	
+			break;
+		}
 	}
 
 	GMM_STANDARD_CATCH_ERROR;
 
+	#ifdef WITH_MPI
+	MPI_Finalize();
+	#endif
 	return 0; 
 	
 } /* end of main program */
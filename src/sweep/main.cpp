@@ -0,0 +1,85 @@
+/* -*- c++ -*- (enables emacs c++ mode) */
+/*======================================================================
+    "Mixed Finite Element Methods for Coupled 3D/1D Fluid Problems"
+
+              Copyright (C) 2026 M3D1D contributors
+======================================================================*/
+/*!
+  @file   main.cpp
+  @author M3D1D contributors
+  @date   October 2026.
+  @brief  Main program for parameter sweeps.
+  @details
+    We solve the coupled 3D/1D problem for many parameter sets on the
+    same geometry. Meshes, FEMs, coupling operators and boundary data
+    are built once; each parameter set rescales the affected blocks of
+    the monolithic system (see sweep3d1d.hpp).
+
+    With ROM_TRAIN_FILE, a reduced-order surrogate is built from full
+    solves at the training sets (see rom3d1d.hpp) and the parameter sets
+    are answered by the surrogate, or by the full model when its error
+    estimate exceeds ROM_TOL.
+
+    Usage:
+      ./M3D1D_SWEEP input.param -dSWEEP_FILE='sweep.dat' -dSWEEP_WORKERS=4
+      ./M3D1D_SWEEP input.param -dSWEEP_FILE='sweep.dat' -dROM_TRAIN_FILE='rom_train.dat'
+
+    The summary table is written to OUTPUT/sweep_summary.txt
+ */
+#include <iostream>
+#include <getfem/bgeot_config.h> // for FE_ENABLE_EXCEPT
+#include <problem3d1d.hpp>
+
+using namespace getfem;
+
+//! main program
+int main(int argc, char *argv[])
+{
+
+	GMM_SET_EXCEPTION_DEBUG; // Exceptions make a memory fault, to debug.
+	FE_ENABLE_EXCEPT;        // Enable floating point exception for Nan.
+
+	try {
+		// Sweep descriptors
+		ftool::md_param PARAM;
+		PARAM.read_command_line(argc, argv);
+		std::string SWEEP_FILE = PARAM.string_value("SWEEP_FILE", "File of the parameter sets");
+		int SWEEP_WORKERS = PARAM.int_value("SWEEP_WORKERS", "Number of worker processes");
+		std::string OUTPUT = PARAM.string_value("OUTPUT", "Output Directory");
+		std::string ROM_TRAIN_FILE = PARAM.string_value("ROM_TRAIN_FILE", "File of the training sets of the surrogate");
+		std::vector<sweep_point> points;
+		read_sweep_file(SWEEP_FILE, points);
+		// Declare a new problem
+		problem3d1d p;
+		// Initialize the problem (meshes, FEMs, boundary data)
+		p.init(argc, argv);
+		// Build the monolithic system and its decomposition
+		p.assembly_sweep();
+		// Solve the parameter sets
+		std::vector<sweep_result> results;
+		if (ROM_TRAIN_FILE.empty())
+			p.solve_sweep(points, size_type(std::max(SWEEP_WORKERS, 1)), results);
+		else {
+			std::vector<sweep_point> train;
+			read_sweep_file(ROM_TRAIN_FILE, train);
+			p.rom_offline(train, PARAM.real_value("ROM_POD_TOL", "Relative energy discarded by the POD"));
+			p.rom_query(points, PARAM.real_value("ROM_TOL", "Tolerance on the error estimate"), results);
+		}
+		// Save the summary table
+		write_sweep_table(OUTPUT + "sweep_summary.txt", points, results);
+
+		std::cout << "--- SWEEP RESULTS -------------------------" << std::endl;
+		for (size_type k = 0; k < points.size(); ++k)
+			std::cout << "  " << points[k].name
+			          << " : TFR = " << results[k].TFR
+			          << ", Pt average = " << results[k].mean_pt
+			          << (results[k].reduced ? " (reduced)" : "")
+			          << (results[k].converged ? "" : " (FAILED)") << std::endl;
+		std::cout << "-------------------------------------------" << std::endl;
+	}
+
+	GMM_STANDARD_CATCH_ERROR;
+
+	return 0;
+
+} /* end of main program */
@@ -0,0 +1,59 @@
+/* -*- c++ -*- (enables emacs c++ mode) */
+/*======================================================================
+    "Mixed Finite Element Methods for Coupled 3D/1D Fluid Problems"
+
+              Copyright (C) 2026 M3D1D contributors
+======================================================================*/
+/*!
+  @file   main.cpp
+  @author M3D1D contributors
+  @date   October 2026.
+  @brief  Main program for transient simulations.
+  @details
+    We solve the coupled 3D/1D problem with storage terms on the tissue
+    and vessel pressures (see transient3d1d.hpp), starting from the
+    steady state and driven by a time profile of the inflow pressures.
+
+    Usage:
+      ./M3D1D_TRANSIENT input.param -dINFLOW_PROFILE='inflow.dat' -dTIME_SCHEME='BDF2'
+
+    The time series is written to OUTPUT/transient.txt
+ */
+#include <iostream>
+#include <getfem/bgeot_config.h> // for FE_ENABLE_EXCEPT
+#include <problem3d1d.hpp>
+
+using namespace getfem;
+
+//! main program
+int main(int argc, char *argv[])
+{
+
+	GMM_SET_EXCEPTION_DEBUG; // Exceptions make a memory fault, to debug.
+	FE_ENABLE_EXCEPT;        // Enable floating point exception for Nan.
+
+	try {
+		// Declare a new problem
+		problem3d1d p;
+		// Initialize the problem (meshes, FEMs, boundary data)
+		p.init(argc, argv);
+		// Build the steady system, the inflow term and the storage matrix
+		p.assembly_transient();
+		// Integrate in time
+		if (!p.solve_transient()) GMM_ASSERT1(false, "transient solve procedure has failed");
+		// Save the final state in .vtk format
+		p.export_vtk("_tend");
+
+		std::cout << "--- FINAL RESULTS -------------------------" << std::endl;
+		std::cout << "  Pt average            = " << p.mean_pt()   << std::endl;
+		std::cout << "  Pv average            = " << p.mean_pv()   << std::endl;
+		std::cout << "  Network-to-Tissue TFR = " << p.flow_rate() << std::endl;
+		std::cout << "  Lymphatic FR          = " << p.lymph_flow_rate() << std::endl;
+		std::cout << "-------------------------------------------" << std::endl;
+	}
+
+	GMM_STANDARD_CATCH_ERROR;
+
+	return 0;
+
+} /* end of main program */